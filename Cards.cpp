@@ -90,7 +90,7 @@ ostream& operator<<(ostream& os, const Card& c) {
 /**
  * These are the implementations of the functions which concern the Deck class
  */
-Deck::Deck() : deck(make_shared<vector<Card*>>()) {                                              // The Deck default constructor creates the match Deck 
+Deck::Deck() : random(std::random_device{}()), deck(make_shared<vector<Card*>>()) {                                              // The Deck default constructor creates the match Deck 
     deckSize = make_shared<int>(0);                                                             // Initializing the Deck size to zero 
     for (int i = 0; i < 10; i++) {                                                              // This is to make sure the Deck always has the same number of each Card type (Modify "i < 10 " to change initial Deck size) 
         this->deck->push_back(new Card("bomb"));
@@ -101,25 +101,27 @@ Deck::Deck() : deck(make_shared<vector<Card*>>()) {
         (* this->deckSize) += 4;                                                                // Increment Deck size by the amount of Cards added  
     }
 }
-Deck::Deck(const Deck& other) : deck(std::make_shared<std::vector<Card*>>(*other.deck)),         
+Deck::Deck(const Deck& other) : random(other.random), deck(std::make_shared<std::vector<Card*>>(*other.deck)),         
 deckSize(std::make_shared<int>(*other.deckSize)) {}                                             // A regular deep copy constructor                    
 Deck& Deck::operator=(const Deck& other) {                                                      // Assignment operator overloading for the Deck class
     if (this == &other) return * this;
     deck = make_shared<vector<Card*>>(*other.deck);
     deckSize = make_shared<int>(*other.deckSize);
+    random = other.random;
     return * this;
 }
 void Deck::draw(Hand * specificHand) {
     if ((* this->deckSize) == 0) {cout << "The deck is empty.\n" << endl; return;}              // Checks if the Deck is empty
     // The following Lines are to select a Card from the Deck as randomly as possible
-    std::random_device rd;
-    std::mt19937 gen(rd());
     std::uniform_int_distribution<int> dis(0, (* deckSize) - 1);
-    int cardPicked = dis(gen);                                                                  // Save the index of the randomly selected Card to a variable
+    int cardPicked = dis(random);                                                               // Save the index of the randomly selected Card to a variable
     specificHand->hand->push_back(deck->at(cardPicked));                                        // Place the selected Card within a player's Hand
     deck->erase(deck->begin() + cardPicked);                                                    // Remove the Card from the Deck    
     (* deckSize)--;                                                                             // Decrement the Deck's Card count                        
 }
+void Deck::setSeed(unsigned seed) {
+    random.seed(seed);                                                                          // Restart the Deck's generator from the given seed
+}
 Deck::~Deck() = default;                                                                        // Deck uses the default deconstructor   
 ostream& operator<<(ostream& os, const Deck& d) {                                                           // Deck stream operator overloading 
     if ((* d.deckSize) == 0) {                                                                              // Checks if the Deck is empty
@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <random>
 
 #include "Orders.h"
 #include "Player.h"
@@ -59,6 +60,9 @@ public:
  * This is the Deck class
  */
 class Deck{
+    private:
+    std::mt19937 random;                                            // This picks the Card each draw takes (seeded from random_device unless setSeed is called)
+
     public:
     std::shared_ptr<std::vector<Card*>> deck;                        // This holds all the Cards contained within a Deck   
     std::shared_ptr<int> deckSize;                                  // This is an attribute of the Deck class
@@ -70,6 +74,7 @@ class Deck{
     Deck& operator=(const Deck& other);                             // This is the overloaded assignment operator for Decks
     friend std::ostream& operator<<(ostream& os, const Deck& d);    // This is the stream operator for a Deck
     void draw(Hand * specificHand);                                 // This function allows a player to draw a random Card from the Deck
+    void setSeed(unsigned seed);                                    // This makes the draws that follow repeatable (the same seed draws the same Cards)
     
 };
 
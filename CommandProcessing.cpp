@@ -14,8 +14,10 @@ using std::vector;
 #include "GameEngine.h"
 #include <limits>
 #include <fstream>
+#include <sstream>
 using std::getline;
 using std::ifstream;
+using std::istringstream;
 
 // forward declaration
 class CommandProcessor;
@@ -250,7 +252,8 @@ bool CommandProcessor::validate(string command)
                     string mList = command.substr(mPos + 3, pPos - (mPos + 3));
                     string pList = command.substr(pPos + 3, gPos - (pPos + 3));
                     string gNum  = command.substr(gPos + 3, dPos - (gPos + 3));
-                    string dNum  = command.substr(dPos + 3);
+                    size_t xPos = command.find("-X");
+                    string dNum  = command.substr(dPos + 3, xPos - (dPos + 3));
 
                     // Count number of maps and strategies
                     int mCount = 1 + std::count(mList.begin(), mList.end(), ',');
@@ -284,6 +287,17 @@ bool CommandProcessor::validate(string command)
                         cout << "Tournament error: number of turns (D) must be 10 to 50." << endl;
                         return false;
                     }
+                    // X (optional, after D) = how the orders of a turn are executed
+                    OrderExecutionMode mode;
+                    int threads;
+                    string xValue;
+                    if (xPos != string::npos)
+                        istringstream(command.substr(xPos + 3)) >> xValue;
+                    if (xPos != string::npos && (xPos < dPos || !parseOrderExecutionMode(xValue, mode, threads)))
+                    {
+                        cout << "Tournament error: execution mode (X) must come last and be sequential, parallel or parallel:N." << endl;
+                        return false;
+                    }
                 }
                 catch (...)
                 {
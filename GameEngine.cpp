@@ -10,6 +10,7 @@ using std::string;
 #include "GameEngine.h"
 #include <algorithm>
 #include <random>
+#include <sstream>
 #include "LoggingObserver.h"
 #include "CommandProcessing.h"
 #include <vector>
@@ -373,6 +374,8 @@ GameEngine::GameEngine()
 GameEngine::GameEngine(GameEngine &otherGameEngine)
 {
     state = otherGameEngine.state->clone();
+    orderExecutionMode = otherGameEngine.orderExecutionMode;
+    orderThreadCount = otherGameEngine.orderThreadCount;
 }
 // parameterized constructor
 GameEngine::GameEngine(Status *state)
@@ -395,6 +398,7 @@ GameEngine::~GameEngine()
         }
         delete players; // then delete the vector itself
     }
+    delete diplomacy; // after the players, which leave it when deleted
     if (deck != nullptr)
     {
         delete deck;
@@ -410,6 +414,8 @@ GameEngine &GameEngine::operator=(const GameEngine &otherGameEngine)
         delete this->state;
         // makes a new state
         this->state = otherGameEngine.state->clone();
+        orderExecutionMode = otherGameEngine.orderExecutionMode;
+        orderThreadCount = otherGameEngine.orderThreadCount;
     }
     return *this;
 }
@@ -441,6 +447,17 @@ void GameEngine::setState(Status *otherStatus)
     notify(this); // log state change
 };
 
+OrderExecutionMode GameEngine::getOrderExecutionMode() const
+{
+    return orderExecutionMode;
+}
+
+void GameEngine::setOrderExecutionMode(OrderExecutionMode mode, int threadCount)
+{
+    orderExecutionMode = mode;
+    orderThreadCount = threadCount;
+}
+
 string GameEngine::stringToLog()
 {
     std::ostringstream oss;
@@ -530,6 +547,11 @@ std::vector<Player *> *GameEngine::getPlayers()
 {
     return players;
 }
+
+Deck *GameEngine::getDeck()
+{
+    return deck;
+}
 // ========================= End of Temporary Function to get players (for testing purposes) =========================
 
 //------------------------- TOURNAMENT (Assignment 3)  ----------------------------
@@ -549,6 +571,7 @@ void GameEngine::executeTournament(const string &tournamentCommand)
     size_t pPos = tournamentCommand.find("-P");
     size_t gPos = tournamentCommand.find("-G");
     size_t dPos = tournamentCommand.find("-D");
+    size_t xPos = tournamentCommand.find("-X");   // optional, after -D
 
     // Extract values based on flag positions
     if (mPos != string::npos && pPos != string::npos && gPos != string::npos && dPos != string::npos)
@@ -557,7 +580,7 @@ void GameEngine::executeTournament(const string &tournamentCommand)
         string mList = tournamentCommand.substr(mPos + 3, pPos - (mPos + 3));
         string pList = tournamentCommand.substr(pPos + 3, gPos - (pPos + 3));
         string gNum = tournamentCommand.substr(gPos + 3, dPos - (gPos + 3));
-        string dNum = tournamentCommand.substr(dPos + 3);
+        string dNum = tournamentCommand.substr(dPos + 3, xPos - (dPos + 3));
 
         // Split strings by comma
         string temp;
@@ -590,6 +613,18 @@ void GameEngine::executeTournament(const string &tournamentCommand)
 
         numGames = stoi(gNum); // convert to string to int
         maxTurns = stoi(dNum); // convert to string to int
+
+        if (xPos != string::npos)
+        {
+            string xValue;
+            istringstream(tournamentCommand.substr(xPos + 3)) >> xValue;
+            OrderExecutionMode mode;
+            int threads;
+            if (parseOrderExecutionMode(xValue, mode, threads))
+            {
+                setOrderExecutionMode(mode, threads);
+            }
+        }
     }
     // 2. Simulate the tournament
     cout << "Tournament mode:\n";
@@ -602,10 +637,33 @@ void GameEngine::executeTournament(const string &tournamentCommand)
         cout << p << " ";
 
     cout << "\nG: " << numGames << " D: " << maxTurns << endl;
+    if (orderExecutionMode == OrderExecutionMode::Parallel)
+    {
+        cout << "X: parallel";
+        if (orderThreadCount > 0)
+            cout << " (" << orderThreadCount << " threads)";
+        cout << endl;
+    }
+
+    // Each map is loaded and validated only once: every game plays on a copy that shares its
+    // topology, and the next map is read on a background thread while the current games run
+    std::future<PrefetchedMap> nextMap;
+    if (!mapFiles.empty())
+    {
+        nextMap = prefetchMap(mapFiles[0]);
+    }
 
     // Simulate each game on each map
     for (size_t mapIdx = 0; mapIdx < mapFiles.size(); ++mapIdx)
     {
+        PrefetchedMap prefetched = nextMap.get();
+        Map *mapTemplate = prefetched.map;
+        cout << prefetched.messages;
+        if (mapIdx + 1 < mapFiles.size())
+        {
+            nextMap = prefetchMap(mapFiles[mapIdx + 1]);
+        }
+
         cout << "Map " << mapIdx + 1 << ": " << endl;
         for (int g = 0; g < numGames; ++g)
         {
@@ -613,7 +671,7 @@ void GameEngine::executeTournament(const string &tournamentCommand)
             // gameloop!
             changeState("loadmap");
             // we will start by loading the map
-            loadMap(mapFiles[mapIdx]);
+            loadMap(mapFiles[mapIdx], mapTemplate);
 
             changeState("validatemap");
             // next, map validation
@@ -665,6 +723,7 @@ void GameEngine::executeTournament(const string &tournamentCommand)
             // play again! reset gamestate to start
             // changeState("replay");
         }
+        delete mapTemplate;
         cout << endl;
     }
 
@@ -739,8 +798,7 @@ void GameEngine::loadMap(string filename)
 {
     cout << "Loading map file: " << filename << endl;
 
-    MapLoader loader;
-    Map *loadedMap = loader.loadMap(filename);
+    Map *loadedMap = readMapFile(filename);
 
     if (loadedMap == nullptr)
     {
@@ -756,6 +814,57 @@ void GameEngine::loadMap(string filename)
     cout << "Map loaded successfully from filename:" << filename << endl;
 }
 
+// Starts a game on a copy of a map that is already loaded (tournament games share its topology)
+void GameEngine::loadMap(string filename, const Map *mapTemplate)
+{
+    cout << "Loading map file: " << filename << endl;
+
+    if (mapTemplate == nullptr)
+    {
+        cout << "Failed to load map from file: " << filename << endl;
+        return;
+    }
+    if (gameMap != nullptr)
+    {
+        delete gameMap;
+    }
+    gameMap = new Map(*mapTemplate);
+
+    cout << "Map loaded successfully from filename:" << filename << endl;
+}
+
+Map *GameEngine::readMapFile(const string &filename, ostream *messages)
+{
+    MapLoader loader;
+    loader.setMessageStream(messages);
+    loader.setLoadMode(MapLoadMode::Parallel); // zero-copy parser on every core for big maps, keeps the [Map] section in the map's MapInfo
+    loader.setUseBinaryCache(true);          // reuse Foo.wzmap images next to the maps, rebuilt when the .map changes
+    loader.setUseBundledMaps(true);          // the shipped maps are linked into the game, no file to read for them
+    return loader.loadMap(filename);
+}
+
+// The map is validated, analysed and routed on the background thread too, so the copies inherit
+// the verdict and share the analysis, routing tables and spatial index the strategies query
+// Nothing is written to cout from the background thread: the loader's messages are kept for later
+std::future<GameEngine::PrefetchedMap> GameEngine::prefetchMap(const string &filename)
+{
+    return std::async(std::launch::async, [filename]()
+    {
+        ostringstream messages;
+        PrefetchedMap prefetched;
+        prefetched.map = readMapFile(filename, &messages);
+        if (prefetched.map != nullptr)
+        {
+            prefetched.map->validate();
+            prefetched.map->getAnalysis();
+            prefetched.map->getRouting();
+            prefetched.map->getSpatialIndex();
+        }
+        prefetched.messages = messages.str();
+        return prefetched;
+    });
+}
+
 void GameEngine::validateMap()
 {
     if (gameMap == nullptr)
@@ -770,10 +879,19 @@ void GameEngine::validateMap()
     if (isValid)
     {
         cout << "Map is valid!" << endl;
+        if (gameMap->getTerritories()->size() < 2)
+        {
+            // validate() does not print its warnings (e.g. an empty map)
+            for (const string &warning : gameMap->getValidationReport().warnings)
+            {
+                cout << "Warning: " << warning << endl;
+            }
+        }
     }
     else
     {
         cout << "Map is invalid!" << endl;
+        gameMap->getValidationReport().print(cout, *gameMap);
     }
 }
 
@@ -792,6 +910,13 @@ void GameEngine::addPlayers(string playerName)
 
     Player *newPlayer = new Player(playerName);
 
+    // every player of the game draws from the game's deck (conquests are rewarded from it too)
+    if (deck == nullptr)
+    {
+        deck = new Deck();
+    }
+    newPlayer->setDeck(deck);
+
     // checking the player strategy to assign
     // if a special strategy is
     string baseName = playerName.substr(0, playerName.find(' '));
@@ -828,6 +953,13 @@ void GameEngine::addPlayers(string playerName)
         newPlayer->setStrategy(newStrategy);
     }
 
+    // a new game starts numbering its players from 0
+    if (players->empty())
+    {
+        diplomacy->clear();
+    }
+    diplomacy->join(newPlayer);
+
     // add player to the vector
     players->push_back(newPlayer);
 
@@ -1102,17 +1234,8 @@ void GameEngine::reinforcementPhase()
         continentBonus = 0; // Continent bonus for players that own all territories in a continent
         std::vector<Continent *> *continents = gameMap->getContinents();
         for (Continent *continent : *continents)
-        {                        // Loop through each continent and checks if the player doesn't own all territories
-            bool ownsAll = true; // break if at least one territory is not owned by the player
-            for (Territory *territory : *continent->getTerritories())
-            {
-                if (territory->getOwner() != player)
-                {
-                    ownsAll = false;
-                    break;
-                }
-            }
-            if (ownsAll)
+        { // O(1) per continent: the map keeps per-player territory counts for every continent
+            if (gameMap->ownsContinent(player, continent->getId()))
             { // If the player does own all territories in the continent, add the bonus armies
                 cout << "Player " << player->getName() << " owns all territories in continent " << continent->getName() << " and receives a bonus of " << continent->getBonusArmies() << " armies." << endl;
                 continentBonus += continent->getBonusArmies();
@@ -1152,115 +1275,191 @@ void GameEngine::issueOrderPhase()
  * ------------------------- Execute Order Phase -------------------------------
  * This function will handle the execute order phase of the game.
  * Each player's orders will be validated and executed
- *
+ * The orders are taken from each list's phase queues (deploy, diplomacy, then the rest), and run()
+ * switches on the order's kind, so no order is type checked and each one costs O(1) to pick
+ * In the Parallel mode the deploy orders and the remaining orders are handed to an OrderScheduler in the
+ * order this function would execute them, and come out the same
  */
 void GameEngine::executeOrderPhase()
 {
 
     int status = 0; // Status to track order execution success/failure, will be used to remove a card from the players hand
-    bool noMoreOrders = false;
 
-    DeployOrder *checkDeployOrder = nullptr;
+    // pacts only last for the turn they are negotiated in
+    diplomacy->clearPacts();
 
     // ========== Deploy Orders First For All Players==========
     cout << "\n================ Battle Results ================\n"
          << endl;
     cout << "\nExecuting Deploy Orders First..." << endl;
-    for (auto pIt = players->begin(); pIt != players->end();)
+    if (orderExecutionMode == OrderExecutionMode::Parallel)
     {
-        Player *player = *pIt; // Call the Validate and Execute for all orders for each player
-
-        cout << player->getName() << " is executing orders." << endl;
-        std::vector<std::unique_ptr<Orders>> &listOfOrders = player->getOrderList()->orderList; // Get the player's order list
-
-        for (auto it = listOfOrders.begin(); it != listOfOrders.end();)
-        { // Iterate through the player's order list
-            std::unique_ptr<Orders> &order = *it;
+        executeDeployOrdersInParallel();
+    }
+    else
+    {
+        for (Player *player : *players)
+        { // Call the Validate and Execute for all orders for each player
+            cout << player->getName() << " is executing orders." << endl;
+            Orderlist *listOfOrders = player->getOrderList(); // Get the player's order list
 
-            checkDeployOrder = dynamic_cast<DeployOrder *>(order.get()); // Check if the order is a deploy order
-            if (checkDeployOrder != nullptr)
-            { // If it is not a deploy order,prepare to break out of the loop to move to the next player
-                order->execute(*player);
-                player->getOrderList()->remove(*(order.get()));
-            }
-            else
+            for (Orders *order = listOfOrders->nextInPhase(OrderPhase::Deploy); order != nullptr;
+                 order = listOfOrders->nextInPhase(OrderPhase::Deploy))
             {
-                it++; // Move to the next order if it is not a deploy order
+                order->run(*player);
+                listOfOrders->cancel(order->getHandle());
             }
         }
-        pIt++;
     }
 
     // ========== Searching For Negotiate Orders ==========
     cout << "\nExecuting Negotiate Orders..." << endl;
-    for (auto pIt = players->begin(); pIt != players->end();)
+    for (Player *player : *players)
     {
-        Player *player = *pIt; // Call the Validate and Execute for all orders for each player
-
         cout << player->getName() << " is executing orders." << endl;
-        std::vector<std::unique_ptr<Orders>> &listOfOrders = player->getOrderList()->orderList;
-
-        for (auto it = listOfOrders.begin(); it != listOfOrders.end();)
-        { // Iterate through the player's order list
-            std::unique_ptr<Orders> &order = *it;
+        Orderlist *listOfOrders = player->getOrderList();
 
-            Negotiate *checkNegotiateOrder = dynamic_cast<Negotiate *>(order.get()); // Check if the order is a negotiate order
-            if (checkNegotiateOrder != nullptr)
-            {                                     // If it is not a negotiate order, check the next ordeer
-                status = order->execute(*player); // Execute the negotiate order
+        // Negotiate records a pact for the turn: attacks between the two players then fail validation when they run
+        for (Orders *order = listOfOrders->nextInPhase(OrderPhase::Diplomacy); order != nullptr;
+             order = listOfOrders->nextInPhase(OrderPhase::Diplomacy))
+        {
+            status = order->run(*player); // Execute the negotiate order
 
-                // Search through a players hand for a specific card type (negotiate) to remove after execution if the status is 0
-                if (status == 0)
+            // Search through a players hand for a specific card type (negotiate) to remove after execution if the status is 0
+            if (status == 0)
+            {
+                for (auto card : *player->getHand()->hand)
                 {
-                    for (auto card : *player->getHand()->hand)
-                    {
-                        string cn = *(card->cardType);
-                        transform(cn.begin(), cn.end(), cn.begin(), ::tolower);
-                        if (cn == "diplomacy")
-                        {                                                // Compare after transformation
-                            card->play(player->getHand(), deck, player); // Remove the card from the player's hand after execution
-                            break;
-                        }
+                    string cn = *(card->cardType);
+                    transform(cn.begin(), cn.end(), cn.begin(), ::tolower);
+                    if (cn == "diplomacy")
+                    {                                                // Compare after transformation
+                        card->play(player->getHand(), deck, player); // Remove the card from the player's hand after execution
+                        break;
                     }
                 }
-
-                player->getOrderList()->remove(*(order.get())); // Remove the executed order from the list
-            }
-            else
-            {
-                it++; // Move to the next order if it is not a negotiate order
             }
+
+            listOfOrders->cancel(order->getHandle()); // Remove the executed order from the list
         }
-        pIt++; // Move to the next player
     }
 
     cout << "\nExecuting Remaining Orders..." << endl;
     // ========== Then Execute All Other Orders ==========
-    while (!noMoreOrders)
-    {                        // Continue until all players have no more orders
-        noMoreOrders = true; // Assume all players have no more orders
-        for (Player *player : *players)
-        { // Loop through each player
-            std::vector<std::unique_ptr<Orders>> &listOfOrders = player->getOrderList()->orderList;
+    if (orderExecutionMode == OrderExecutionMode::Parallel)
+    {
+        executeRemainingOrdersInParallel();
+        return;
+    }
+    // Round robin over a ring of the players with orders left: the cursor executes one order of the
+    // player it points at and moves on, a player whose orders have run out leaves the ring
+    vector<Player *> ring(players->begin(), players->end());
+    size_t cursor = 0;
+    while (!ring.empty())
+    { // Continue until all players have no more orders
+        Player *player = ring[cursor];
+        Orderlist *listOfOrders = player->getOrderList();
+        Orders *order = listOfOrders->nextInPhase(OrderPhase::Main); // Get the player's next order
+
+        if (order == nullptr)
+        {
+            ring.erase(ring.begin() + cursor); // The next player moves up to the cursor
+        }
+        else
+        {
+            status = order->run(*player); // Execute the order
 
-            if (!listOfOrders.empty())
-            {                                                          // If the player has orders left to execute
-                noMoreOrders = false;                                  // At least one player has orders left
-                std::unique_ptr<Orders> &order = listOfOrders.front(); // Get the first order in the list
-                status = order->execute(*player);                      // Execute the order
+            if (status == 0)
+            {
+                findAndPlayCard(order, player); // Remove the corresponding card from the player's hand after execution
+            }
 
-                if (status == 0)
-                {
-                    findAndPlayCard(&order, player); // Remove the corresponding card from the player's hand after execution
-                }
+            listOfOrders->cancel(order->getHandle()); // Remove the executed order from the list
+            cursor++;
+        }
 
-                player->getOrderList()->remove(*(order.get())); // Remove the executed order from the list
+        if (cursor >= ring.size())
+        {
+            cursor = 0;
+        }
+    }
+}
+
+/***
+ * The deploy orders in the order executeOrderPhase executes them, run by an OrderScheduler
+ * Each player is announced before its first order, as the sequential loop prints it
+ */
+void GameEngine::executeDeployOrdersInParallel()
+{
+    vector<IssuedOrder> sequence;
+    vector<string> announced; // players announced before each order
+    string announcing;
+    for (Player *player : *players)
+    {
+        announcing += player->getName() + " is executing orders.\n";
+        for (Orders *order : player->getOrderList()->getPhaseOrders(OrderPhase::Deploy))
+        {
+            sequence.push_back({player, order});
+            announced.push_back(announcing);
+            announcing.clear();
+        }
+    }
+
+    OrderScheduler scheduler(orderThreadCount);
+    scheduler.execute(sequence, [&](size_t i)
+                      {
+        orderOutput() << announced[i];
+        sequence[i].second->run(*sequence[i].first); });
+    cout << announcing << flush; // players after the last order
+
+    for (auto &[player, order] : sequence)
+    {
+        player->getOrderList()->cancel(order->getHandle());
+    }
+}
+
+/***
+ * The remaining orders in the round robin order of executeOrderPhase (one order of each player with
+ * orders left per round; executing an order never removes another, so the order is known up front),
+ * run by an OrderScheduler
+ */
+void GameEngine::executeRemainingOrdersInParallel()
+{
+    vector<vector<Orders *>> queues;
+    size_t rounds = 0;
+    for (Player *player : *players)
+    {
+        queues.push_back(player->getOrderList()->getPhaseOrders(OrderPhase::Main));
+        rounds = max(rounds, queues.back().size());
+    }
+    vector<IssuedOrder> sequence;
+    for (size_t round = 0; round < rounds; round++)
+    {
+        for (size_t p = 0; p < queues.size(); p++)
+        {
+            if (round < queues[p].size())
+            {
+                sequence.push_back({(*players)[p], queues[p][round]});
             }
         }
     }
+
+    OrderScheduler scheduler(orderThreadCount);
+    scheduler.execute(sequence, [&](size_t i)
+                      {
+        auto [player, order] = sequence[i];
+        if (order->run(*player) == 0)
+        {
+            findAndPlayCard(order, player); // Remove the corresponding card from the player's hand after execution
+        } });
+
+    for (auto &[player, order] : sequence)
+    {
+        player->getOrderList()->cancel(order->getHandle());
+    }
 }
 
-void GameEngine::findAndPlayCard(std::unique_ptr<Orders> *order, Player *player)
+void GameEngine::findAndPlayCard(Orders *order, Player *player)
 {
     // Search through a players hand for a specific card type to remove after execution if the status is 0
 
@@ -1269,17 +1468,17 @@ void GameEngine::findAndPlayCard(std::unique_ptr<Orders> *order, Player *player)
         string cn = *(card->cardType);
         transform(cn.begin(), cn.end(), cn.begin(), ::tolower);
 
-        if (cn == "bomb" && dynamic_cast<Bomb *>(order->get()) != nullptr)
+        if (cn == "bomb" && order->getKind() == OrderKind::Bomb)
         {                                                // Compare after transformation
             card->play(player->getHand(), deck, player); // Remove the card from the player's hand after execution
             break;
         }
-        else if (cn == "airlift" && dynamic_cast<Airlift *>(order->get()) != nullptr)
+        else if (cn == "airlift" && order->getKind() == OrderKind::Airlift)
         {
             card->play(player->getHand(), deck, player);
             break;
         }
-        else if (cn == "blockade" && dynamic_cast<Blockade *>(order->get()) != nullptr)
+        else if (cn == "blockade" && order->getKind() == OrderKind::Blockade)
         {
             card->play(player->getHand(), deck, player);
             break;
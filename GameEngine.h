@@ -8,9 +8,11 @@
 using std::cout;
 using std::string;
 #include <string>
+#include <future>
 #include "Map.h"
 #include "Player.h"
 #include "Cards.h"
+#include "OrderScheduler.h"
 
 // Forward declarations
 class Status;
@@ -188,10 +190,23 @@ private:
     Status *state;
     Map *gameMap = nullptr;
     std::vector<Player *> *players = nullptr;
+    Diplomacy *diplomacy = new Diplomacy();   // ids of the players and the pacts of the current turn
     Deck *deck = nullptr;
+    OrderExecutionMode orderExecutionMode = OrderExecutionMode::Sequential;
+    int orderThreadCount = 0;   // threads of the Parallel mode, 0: one per core
 
     // Private helper functions
     bool isGameOver(); // Checks if a player has no more territories and boot them out, as well as if only one player remains
+    // A map read ahead of time, with what its loader wrote (printed when the map is used, not while another game runs)
+    struct PrefetchedMap
+    {
+        Map *map = nullptr;
+        std::string messages;
+    };
+    static Map *readMapFile(const string &filename, ostream *messages = nullptr);   // loads a map with the engine's loader settings (messages: cout)
+    static std::future<PrefetchedMap> prefetchMap(const string &filename);        // loads and validates a map on a background thread
+    void executeDeployOrdersInParallel();      // the Parallel mode of executeOrderPhase
+    void executeRemainingOrdersInParallel();
 public:
     GameEngine();                            // default constructor
     GameEngine(Status *state);               // parameterized
@@ -206,11 +221,16 @@ public:
     // setter
     void setState(Status *otherStatus);
 
+    // Order execution (Sequential by default, Parallel gives the same game on several threads)
+    OrderExecutionMode getOrderExecutionMode() const;
+    void setOrderExecutionMode(OrderExecutionMode mode, int threadCount = 0);
+
     // Startup Phase
     void startupPhase();
 
     // Helper functions for game setup
     void loadMap(string filename);
+    void loadMap(string filename, const Map *mapTemplate); // plays on a copy of an already loaded map
     void validateMap();
     void addPlayers(string playerName);
     void startGame();
@@ -231,8 +251,9 @@ public:
 
     // Temporary function to get players (for testing purposes)
     std::vector<Player *> *getPlayers();
+    Deck *getDeck();   // the game's deck, created with the first player
 
-    void findAndPlayCard(std::unique_ptr<Orders> *order, Player *player);
+    void findAndPlayCard(Orders *order, Player *player);
 };
 
 // Global game engine pointer
@@ -2,7 +2,11 @@
 #include "GameEngine.h"
 #include "GameEngineDriver.h"
 #include "CommandProcessing.h"
+#include "OrderScheduler.h"
 #include <iostream>
+#include <sstream>
+#include <random>
+#include <chrono>
 
 extern CommandProcessor *theCommandProcessor;
 
@@ -59,4 +63,145 @@ void testMainGameLoop()
     // theGameEngine->addPlayers("Dan");
     theGameEngine->startGame();
     theGameEngine->mainGameLoop();
-}
\ No newline at end of file
+}
+
+// Plays turns of executeOrderPhase on a copy of the map with orders drawn from a generator seeded with
+// seed, and a game deck seeded with it too: each turn every player gets a pool, deploys part of it and
+// advances from its territories (conquests draw their reward card)
+// Returns what the turns printed, then the owner and armies of every territory and every player's
+// pool and cards after each turn
+static string playSeededGame(const Map &base, OrderExecutionMode mode, unsigned seed, int turns,
+                             int ordersPerPlayer, double &elapsedMs)
+{
+    ostringstream log;
+    ostringstream state;
+    streambuf *console = cout.rdbuf(log.rdbuf());
+
+    Map map(base);
+    GameEngine engine;
+    engine.setOrderExecutionMode(mode);
+    const string names[] = {"Neutral 1", "Neutral 2", "Aggressive 3", "Aggressive 4", "Benevolent 5", "Benevolent 6"};
+    for (const string &name : names)
+    {
+        engine.addPlayers(name);
+    }
+    vector<Player *> &players = *engine.getPlayers();
+    engine.getDeck()->setSeed(seed);
+
+    mt19937 random(seed);
+    for (Territory *territory : *map.getTerritories())
+    {
+        Player *owner = players[random() % players.size()];
+        territory->setOwner(owner);
+        owner->addToDefend(territory);
+        territory->setArmies(1 + random() % 10);
+    }
+    log.str("");   // the setup is the same in both modes
+
+    elapsedMs = 0;
+    for (int turn = 1; turn <= turns; turn++)
+    {
+        for (Player *player : players)
+        {
+            vector<Territory *> owned = *player->getDefendCollection();
+            if (owned.empty())
+                continue;
+            int pool = 3 + static_cast<int>(owned.size()) / 3;
+            player->setReinforcementPool(pool);
+            for (int i = 0; i < ordersPerPlayer; i++)
+            {
+                Territory *source = owned[random() % owned.size()];
+                span<Territory *const> adjacent = source->getAdjacentTerritories();
+                if (i < ordersPerPlayer / 10 || adjacent.empty())
+                {
+                    player->getOrderList()->add(make_unique<DeployOrder>(1 + random() % 3, source, source));
+                }
+                else
+                {
+                    Territory *target = adjacent[random() % adjacent.size()];
+                    player->getOrderList()->add(make_unique<Advance>(1 + random() % 6, source, target));
+                }
+            }
+        }
+
+        auto start = chrono::steady_clock::now();
+        engine.executeOrderPhase();
+        elapsedMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        state << "Turn " << turn << "\n";
+        for (Territory *territory : *map.getTerritories())
+        {
+            state << territory->getName() << " " << (territory->getOwner() ? territory->getOwner()->getName() : "-")
+                  << " " << territory->getArmies() << "\n";
+        }
+        for (Player *player : players)
+        {
+            state << player->getName() << " pool " << player->getReinforcementPool() << " cards";
+            for (Card *card : *player->getHand()->hand)
+            {
+                state << " " << *card->cardType;
+            }
+            state << "\n";
+        }
+    }
+
+    cout.rdbuf(console);
+    return log.str() + state.str();
+}
+
+// Number of the first line where a and b differ, 0 when they are the same
+static int firstDifference(const string &a, const string &b)
+{
+    istringstream linesA(a);
+    istringstream linesB(b);
+    string lineA;
+    string lineB;
+    for (int line = 1;; line++)
+    {
+        bool moreA = static_cast<bool>(getline(linesA, lineA));
+        bool moreB = static_cast<bool>(getline(linesB, lineB));
+        if (!moreA && !moreB)
+            return 0;
+        if (moreA != moreB || lineA != lineB)
+            return line;
+    }
+}
+
+// Plays the same seeded game in the Sequential and the Parallel execution modes, and checks that the
+// two print the same and leave the same owners, armies, pools and cards after every turn
+void testOrderExecutionModes()
+{
+    cout << "\n========== Order Execution Modes ==========\n" << endl;
+
+    string file;
+    cout << "Map file to play on: " << endl;
+    cin >> file;
+
+    MapLoader loader;
+    Map *map = loader.loadMap(file);
+    if (map == nullptr || map->getTerritories()->empty())
+    {
+        cout << "Cannot play on " << file << endl;
+        delete map;
+        return;
+    }
+
+    const int TURNS = 8;
+    const int ORDERS_PER_PLAYER = 200;
+    for (unsigned seed : {2024u, 7u, 99u})
+    {
+        double sequentialMs = 0;
+        double parallelMs = 0;
+        string sequential = playSeededGame(*map, OrderExecutionMode::Sequential, seed, TURNS, ORDERS_PER_PLAYER, sequentialMs);
+        string parallel = playSeededGame(*map, OrderExecutionMode::Parallel, seed, TURNS, ORDERS_PER_PLAYER, parallelMs);
+        int difference = firstDifference(sequential, parallel);
+
+        cout << "Seed " << seed << ": sequential " << sequentialMs << " ms, parallel " << parallelMs << " ms, "
+             << count(sequential.begin(), sequential.end(), '\n') << " lines";
+        if (difference == 0)
+            cout << " -> identical" << endl;
+        else
+            cout << " -> MISMATCH from line " << difference << endl;
+    }
+    delete map;
+}
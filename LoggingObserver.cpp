@@ -12,28 +12,40 @@
 
 using namespace std;
 
-Subject::Subject()
-{
-    observers = std::make_shared<std::vector<Observer*>>();
-}
+Subject::Subject() = default;
 
 Subject::~Subject()
 {
-    observers->clear();
+    if (observers)
+    {
+        observers->clear();
+    }
 }
 
 void Subject::attach(Observer* observer)
 {
+    if (!observers)
+    {
+        observers = std::make_shared<std::vector<Observer*>>();
+    }
     observers->push_back(observer);
 }
 
 void Subject::detach(Observer* observer)
 {
+    if (!observers)
+    {
+        return;
+    }
     observers->erase(std::remove(observers->begin(), observers->end(), observer), observers->end());
 }
 
 void Subject::notify(ILoggable* loggable)
 {
+    if (!observers)
+    {
+        return;
+    }
     for (auto* observer : *observers)
     {
         observer -> update(loggable);
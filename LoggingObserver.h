@@ -36,7 +36,7 @@ class Subject
         virtual void detach(Observer* observer);
         virtual void notify(ILoggable* loggable);
     private:
-        std::shared_ptr<std::vector<Observer*>> observers;
+        std::shared_ptr<std::vector<Observer*>> observers;   // created by the first attach(), most subjects never get one
 };
 
 class LogObserver : public Observer
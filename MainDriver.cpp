@@ -10,6 +10,7 @@
 #include "LoggingObserverDriver.h"
 #include "PlayerStrategiesDriver.h"
 #include "TournamentDriver.h"
+#include "MapGeneratorDriver.h"
 #include <string>
 using namespace std;
 
@@ -24,7 +25,14 @@ int main()
         cout << "Choose which part to test: " << endl;
         cout << "1. Tournament Mode" << endl;
         cout << "2. PlayerStrategies" << endl;
-        cout << "3. Exit" << endl;
+        cout << "3. Map Scaling Benchmark" << endl;
+        cout << "4. Batch Map Validation" << endl;
+        cout << "5. Spatial Index Queries" << endl;
+        cout << "6. Map Editor Revalidation" << endl;
+        cout << "7. Map Patches" << endl;
+        cout << "8. Order Queues" << endl;
+        cout << "9. Order Execution Modes" << endl;
+        cout << "10. Exit" << endl;
 
 
         int input;
@@ -39,6 +47,27 @@ int main()
             testPlayerStrategies();
             break;
         case 3:
+            testMapScaling();
+            break;
+        case 4:
+            testBatchValidation();
+            break;
+        case 5:
+            testSpatialIndex();
+            break;
+        case 6:
+            testMapEditor();
+            break;
+        case 7:
+            testMapPatch();
+            break;
+        case 8:
+            testOrderQueues();
+            break;
+        case 9:
+            testOrderExecutionModes();
+            break;
+        case 10:
             cout << "Exiting program..." << endl;
             continueProgram = false;
             break;
@@ -1,14 +1,110 @@
 // Map.cpp
 #include "Map.h"
+#include "MapPatch.h"
 #include <string>
 #include <iostream>
 #include <cctype>
+#include <iomanip>
 #include <algorithm>
 #include <queue>
+#include <unordered_set>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <climits>
+#include <bit>
+#include <functional>
+#include <mutex>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+// The army reductions have AVX2 kernels, picked at run time, on x86 GCC and Clang builds
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MAP_AVX2_KERNELS 1
+#endif
 
 
 using namespace std;
 
+// ==================== MapArena Implementation ====================
+
+// Constructors and destructor (MapArena)
+MapArena::MapArena() {
+    blocks = new vector<pair<char*, size_t>>();
+    cursor = nullptr;
+    limit = nullptr;
+    bytesUsed = 0;
+}
+
+MapArena::~MapArena() {
+    release();
+    delete blocks;
+    blocks = nullptr;
+}
+
+// Stream insertion operator (MapArena)
+ostream& operator<<(ostream& os, const MapArena& arena) {
+    os << "MapArena: " << arena.blocks->size() << " blocks, "
+       << arena.bytesUsed << " of " << arena.getBytesReserved() << " bytes used";
+    return os;
+}
+
+// Getters (MapArena)
+size_t MapArena::getBytesUsed() const {
+    return bytesUsed;
+}
+
+size_t MapArena::getBytesReserved() const {
+    size_t reserved = 0;
+    for (const pair<char*, size_t>& block : *blocks) {
+        reserved += block.second;
+    }
+    return reserved;
+}
+
+// Each block doubles the previous one up to MAX_BLOCK_SIZE, larger requests get a block of their own
+void MapArena::addBlock(size_t minimumSize) {
+    size_t size = blocks->empty() ? FIRST_BLOCK_SIZE : min(blocks->back().second * 2, MAX_BLOCK_SIZE);
+    size = max(size, minimumSize);
+    char* block = static_cast<char*>(::operator new(size, align_val_t(alignof(max_align_t))));
+    blocks->push_back({block, size});
+    cursor = block;
+    limit = block + size;
+}
+
+void* MapArena::allocate(size_t size, size_t alignment) {
+    size_t padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+    if (cursor == nullptr || static_cast<size_t>(limit - cursor) < padding + size) {
+        addBlock(size + alignment);
+        padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+    }
+    void* result = cursor + padding;
+    cursor += padding + size;
+    bytesUsed += size;
+    return result;
+}
+
+void MapArena::release() {
+    for (const pair<char*, size_t>& block : *blocks) {
+        ::operator delete(block.first, align_val_t(alignof(max_align_t)));
+    }
+    blocks->clear();
+    cursor = nullptr;
+    limit = nullptr;
+    bytesUsed = 0;
+}
+
 // ==================== Territory Implementation ====================
 
 Territory::Territory() {
@@ -16,7 +112,11 @@ Territory::Territory() {
     owner = nullptr;
     armies = new int(0);
     continent = nullptr;
-    adjacentTerritories  = new vector<Territory*>();
+    id = NO_TERRITORY;
+    map = nullptr;
+    adjacentTerritories = nullptr;
+    stateInMap = false;
+    inArena = false;
 }
 
 Territory::Territory(const string& territoryName){
@@ -24,20 +124,48 @@ Territory::Territory(const string& territoryName){
     owner = nullptr;
     armies = new int(0);
     continent = nullptr;
-    adjacentTerritories = new vector<Territory*>();
+    id = NO_TERRITORY;
+    map = nullptr;
+    adjacentTerritories = nullptr;
+    stateInMap = false;
+    inArena = false;
 }
 
+// The copy is standalone: with the map and id of other, its setters would write into other's map
+// (its name table, ownership counters and edges). Its neighbors are copied into its own list
 Territory::Territory(const Territory& other){
     name = new string(*other.name);
-    owner = other.owner;
-    armies = new int(*other.armies);
+    owner = other.getOwner();
+    armies = new int(other.getArmies());
     continent = other.continent;
-    adjacentTerritories = new vector<Territory*>(*other.adjacentTerritories);
+    id = NO_TERRITORY;
+    map = nullptr;
+    span<Territory* const> neighbors = other.getAdjacentTerritories();
+    adjacentTerritories = neighbors.empty() ? nullptr : new vector<Territory*>(neighbors.begin(), neighbors.end());
+    stateInMap = false;
+    inArena = false;
+}
+
+// Arena constructor, used by Map::createTerritory and Map::copyElements
+Territory::Territory(const string& territoryName, MapArena* arena){
+    name = arena->create<string>(territoryName);
+    owner = nullptr;
+    armies = arena->create<int>(0);
+    continent = nullptr;
+    id = NO_TERRITORY;
+    map = nullptr;
+    adjacentTerritories = nullptr;
+    stateInMap = false;
+    inArena = true;
 }
 
 Territory::~Territory(){
-    delete name;
-    delete armies;
+    if (inArena) {
+        name->~string();   // the arena frees the storage itself
+    } else {
+        delete name;
+        delete armies;
+    }
     delete adjacentTerritories;
     name = nullptr;
     armies = nullptr;
@@ -48,15 +176,24 @@ Territory::~Territory(){
 // Assignment operator
 Territory& Territory::operator=(const Territory& other) {
     if (this != &other) {
-        delete name;
-        delete armies;
+        // A territory of a map keeps its place in it: the setters update the map's name table,
+        // state and ownership counters for its own id
+        if (map != nullptr) {
+            setName(*other.name);
+            setOwner(other.getOwner());
+            setArmies(other.getArmies());
+            return *this;
+        }
+
+        // A standalone territory becomes a standalone copy of other (see the copy constructor)
+        span<Territory* const> neighbors = other.getAdjacentTerritories();
+        vector<Territory*>* copied = neighbors.empty() ? nullptr : new vector<Territory*>(neighbors.begin(), neighbors.end());
         delete adjacentTerritories;
-        
-        name = new string(*other.name);
-        owner = other.owner;
-        armies = new int(*other.armies);
+        adjacentTerritories = copied;
+        *name = *other.name;
+        owner = other.getOwner();
+        *armies = other.getArmies();
         continent = other.continent;
-        adjacentTerritories = new vector<Territory*>(*other.adjacentTerritories);
     }
     return *this;
 }
@@ -64,61 +201,114 @@ Territory& Territory::operator=(const Territory& other) {
 // Stream insertion operator
 ostream& operator<<(ostream& os, const Territory& territory) {
     os << "Territory: " << *territory.name 
-       << ", Armies: " << *territory.armies
-       << ", Adjacent to " << territory.adjacentTerritories->size() << " territories";
+       << ", Armies: " << territory.getArmies()
+       << ", Adjacent to " << territory.getAdjacentTerritories().size() << " territories";
     return os;
 }
 
 // Getters (Territory)
-string Territory::getName() const {
+const string& Territory::getName() const {
     return *name;
 }
 
 Player* Territory::getOwner() const {
-    return owner;
+    return stateInMap ? map->state->getOwner(id) : owner;
 }
 
 int Territory::getArmies() const {
-    return *armies;
+    return stateInMap ? map->state->getArmies(id) : *armies;
 }
 
 Continent* Territory::getContinent() const {
     return continent;
 }
 
-vector<Territory*>* Territory::getAdjacentTerritories() const{
-    return adjacentTerritories;
+TerritoryId Territory::getId() const {
+    return id;
+}
+
+Map* Territory::getMap() const {
+    return map;
+}
+
+// Map territories read their neighbors from the compiled topology of their map
+// Standalone territories (not added to a map) fall back to their own edge list
+span<Territory* const> Territory::getAdjacentTerritories() const{
+    if (map != nullptr) {
+        return map->getNeighbors(id);
+    }
+    if (adjacentTerritories == nullptr) {
+        return {};
+    }
+    return span<Territory* const>(*adjacentTerritories);
+}
+
+MapPoint Territory::getPosition() const{
+    return (map != nullptr) ? map->getTerritoryPosition(id) : MapPoint();
 }
 
 // Setters(Territory)
 void Territory::setName(const string& territoryName) {
     *name = territoryName;
+    if (map != nullptr) {
+        map->territoryNames->rename(id, territoryName);
+    }
 }
 
 void Territory::setOwner(Player* newOwner){
-    owner = newOwner;
+    Player* oldOwner = getOwner();
+    if (map != nullptr && oldOwner != newOwner) {
+        map->updateOwnership(this, oldOwner, newOwner);
+    }
+    if (stateInMap) {
+        map->state->setOwner(id, newOwner);
+    } else {
+        owner = newOwner;
+    }
 }
 
 void Territory::setArmies(int newArmies){
-    *armies = newArmies;
+    if (stateInMap) {
+        map->state->setArmies(id, newArmies);
+    } else {
+        *armies = newArmies;
+    }
 }
 
 void Territory::setContinent(Continent* newContinent){
     continent = newContinent;
+    if (map != nullptr) {
+        map->invalidateOwnership();
+    }
 }
 
 // Territory operations
 void Territory::addAdjacentTerritory(Territory* territory){
     if (territory != nullptr && territory != this) {
         // Checks that the pointer is not nullptr and not the same as current territory (to avoid self-loops)
-        // Adds the pointer territory to the end of the container adjacentTerritories
+        // Edges inside one map go straight to the map, which compiles them into its topology on next use
+        if (map != nullptr && territory->map == map) {
+            map->addAdjacency(id, territory->id);
+            return;
+        }
+        if (adjacentTerritories == nullptr) {
+            adjacentTerritories = new vector<Territory*>();
+        }
         adjacentTerritories->push_back(territory);
+        if (map != nullptr) {
+            map->invalidateTopology();
+        }
     }
 }
 bool Territory::isAdjacent(Territory* territory) const {
     if (territory == nullptr) return false;
 
-    for (Territory* t : *adjacentTerritories) {
+    // Both territories are in the same map: O(1) bitset or O(log deg) lookup in the compiled topology
+    if (map != nullptr && territory->map == map) {
+        return map->getTopology()->areAdjacent(id, territory->id);
+    }
+
+    for (Territory* t : getAdjacentTerritories()) {
         if (t == territory) {
             return true;
         }
@@ -126,544 +316,3862 @@ bool Territory::isAdjacent(Territory* territory) const {
     return false;
 }
 
-// ==================== Continent Implementation ====================
+// ==================== MapInfo Implementation ====================
 
-// Constructors(Continent)
-Continent::Continent() {
-    name = new string("");
-    bonusArmies = new int(0);
-    territories = new vector<Territory*>();
+// Records a [Map] key=value pair, known keys are also stored in their own field
+void MapInfo::set(string_view key, string_view value) {
+    properties.emplace_back(string(key), string(value));
+    if (key == "author") author = value;
+    else if (key == "image") image = value;
+    else if (key == "wrap") wrap = value;
+    else if (key == "scroll") scroll = value;
+    else if (key == "warn") warn = value;
 }
 
-Continent::Continent(const string& continentName, int bonus) {
-    name = new string(continentName);
-    bonusArmies = new int(bonus);
-    territories = new vector<Territory*>();
+// Stream insertion operator (MapInfo)
+ostream& operator<<(ostream& os, const MapInfo& info) {
+    os << "Map Info:";
+    for (const auto& property : info.properties) {
+        os << endl << property.first << "=" << property.second;
+    }
+    return os;
 }
 
-Continent::Continent(const Continent& other) {
-    name = new string(*other.name);
-    bonusArmies = new int(*other.bonusArmies);
-    territories = new vector<Territory*>(*other.territories);
+// ==================== ValidationReport Implementation ====================
+
+bool ValidationReport::isConnected() const{
+    return components.size() <= 1;
 }
 
-// Destructor(Continent)
-Continent::~Continent() {
-    delete name;
-    delete bonusArmies;
-    delete territories;
-    name = nullptr;
-    bonusArmies = nullptr;
-    territories = nullptr;
+bool ValidationReport::areContinentsConnected() const{
+    return continentPieces.empty();
 }
 
-// Assignment operator (Continent)
-Continent& Continent::operator=(const Continent& other) {
+// No orphans, no territory in two continents, and no territory named like a continent
+bool ValidationReport::isEachTerritoryInOneContinent() const{
+    return orphans.empty() && duplicates.empty() && !territoryNamedAsContinent;
+}
+
+bool ValidationReport::isValid() const{
+    return isConnected() && areContinentsConnected() && isEachTerritoryInOneContinent();
+}
+
+// Prints every problem found, with territory and continent names resolved through the map
+void ValidationReport::print(ostream& os, const Map& map) const{
+    auto printTerritories = [&os, &map](const vector<TerritoryId>& ids) {
+        for (size_t i = 0; i < ids.size(); i++) {
+            os << (i > 0 ? ", " : "") << map.getTerritoryName(ids[i]);
+        }
+        os << endl;
+    };
+
+    for (const string& warning : warnings) {
+        os << "Warning: " << warning << endl;
+    }
+    if (!isConnected()) {
+        os << "The map has " << components.size() << " disconnected components:" << endl;
+        for (size_t i = 0; i < components.size(); i++) {
+            os << "  Component " << i + 1 << " (" << components[i].size() << "): ";
+            printTerritories(components[i]);
+        }
+    }
+    for (const auto& continent : continentPieces) {
+        os << "Continent " << map.getContinentName(continent.first) << " is split into " << continent.second.size() << " pieces:" << endl;
+        for (size_t i = 0; i < continent.second.size(); i++) {
+            os << "  Piece " << i + 1 << " (" << continent.second[i].size() << "): ";
+            printTerritories(continent.second[i]);
+        }
+    }
+    if (!orphans.empty()) {
+        os << "Territories in no continent: ";
+        printTerritories(orphans);
+    }
+    if (!duplicates.empty()) {
+        os << "Territories in more than one continent: ";
+        printTerritories(duplicates);
+    }
+    if (territoryNamedAsContinent) {
+        os << "A territory has the same name as a continent" << endl;
+    }
+    if (isValid()) {
+        os << "No problems found" << endl;
+    }
+}
+
+// ==================== NameTable Implementation ====================
+
+// Constructors (NameTable)
+NameTable::NameTable() {
+    names = new deque<string>();
+    index = new unordered_map<string_view, int>();
+}
+
+NameTable::NameTable(const NameTable& other) {
+    names = new deque<string>(*other.names);
+    index = new unordered_map<string_view, int>();
+    rebuildIndex();
+}
+
+// Destructor (NameTable)
+NameTable::~NameTable() {
+    delete index;
+    delete names;
+    index = nullptr;
+    names = nullptr;
+}
+
+// Assignment operator (NameTable)
+NameTable& NameTable::operator=(const NameTable& other) {
     if (this != &other) {
-        delete name;
-        delete bonusArmies;
-        delete territories;
-        
-        name = new string(*other.name);
-        bonusArmies = new int(*other.bonusArmies);
-        territories = new vector<Territory*>(*other.territories);
+        *names = *other.names;
+        rebuildIndex();
     }
     return *this;
 }
 
-// Stream inserion operator (Continent)
-ostream& operator<<(ostream& os, const Continent& continent) {
-    os << "Continent: " << *continent.name 
-       << ", Bonus: " << *continent.bonusArmies
-       << ", Territories: " << continent.territories->size();
+// Stream insertion operator (NameTable)
+ostream& operator<<(ostream& os, const NameTable& table) {
+    os << "Name table with " << table.size() << " names";
     return os;
 }
 
-// Getters (Continent)
-string Continent::getName() const{
-    return *name;
+// The index holds views into our own strings, so it is rebuilt whenever the storage is copied
+void NameTable::rebuildIndex() {
+    index->clear();
+    index->reserve(names->size());
+    for (size_t i = 0; i < names->size(); i++) {
+        index->emplace(string_view((*names)[i]), static_cast<int>(i)); // keeps the first id of a repeated name
+    }
 }
-int Continent::getBonusArmies() const{
-    return *bonusArmies;
+
+// Getters (NameTable)
+int NameTable::size() const {
+    return static_cast<int>(names->size());
 }
-vector<Territory*>* Continent::getTerritories() const{
-    return territories;
+
+const string& NameTable::getName(int id) const {
+    return (*names)[id];
 }
 
-// Setters (Continent)
-void Continent::setName(const string& continentName){
-    *name = continentName;
+// Table operations
+int NameTable::add(string_view name) {
+    int id = static_cast<int>(names->size());
+    names->emplace_back(name);
+    index->emplace(string_view(names->back()), id);
+    return id;
 }
-void Continent::setBonusArmies(int bonus){
-    *bonusArmies = bonus;
+
+int NameTable::find(string_view name) const {
+    auto it = index->find(name);
+    return it == index->end() ? -1 : it->second;
 }
 
-// Continent operations
-void Continent::addTerritory(Territory* territory){
-    if (territory != nullptr) {
-        territories->push_back(territory);
-        territory->setContinent(this); 
+void NameTable::rename(int id, string_view name) {
+    if ((*names)[id] == name) return;
+
+    auto it = index->find(string_view((*names)[id]));
+    bool wasIndexed = (it != index->end() && it->second == id);
+    if (wasIndexed) {
+        index->erase(it);
     }
-}
+    string oldName = (*names)[id];
+    (*names)[id] = string(name);
+    index->emplace(string_view((*names)[id]), id);
 
-// Check if the continent is a connected subgraph (for areContinentsConnected)
-bool Continent::isContinentConnected() const{
-    if (territories->empty()) return true; // An empty continent is considered connected
-    if (territories->size() == 1) return true; // A single territory is considered connected
+    // Another id with the old name takes over the index entry (rare, so a scan is fine)
+    if (wasIndexed) {
+        for (size_t i = 0; i < names->size(); i++) {
+            if ((*names)[i] == oldName) {
+                index->emplace(string_view((*names)[i]), static_cast<int>(i));
+                break;
+            }
+        }
+    }
+}
 
-    // Use Breadth-First Search (BFS) to check connectivity
+void NameTable::reserve(int count) {
+    index->reserve(count);
+}
 
-    set<Territory*> visited; // To track visited territories
-    queue<Territory*> IsConnectedQueue; // BFS queue to process territories
+// ==================== MapTopology Implementation ====================
 
-    IsConnectedQueue.push(territories->at(0)); // Start BFS from the first territory
-    visited.insert(territories->at(0)); // Mark the starting territory as visited
+// Constructors (MapTopology)
+MapTopology::MapTopology() {
+    territoryCount = 0;
+    offsets = new vector<int>(1, 0);
+    neighborIds = new vector<TerritoryId>();
+    adjacencyBits = new vector<uint64_t>();
+    rowWords = 0;
+}
 
-    while (!IsConnectedQueue.empty()) {
-        Territory* current = IsConnectedQueue.front();
-        IsConnectedQueue.pop();
+// Builds the CSR rows from a directed edge list (duplicate edges and self-loops are dropped)
+MapTopology::MapTopology(int count, const vector<pair<TerritoryId, TerritoryId>>& edges) {
+    territoryCount = count;
+    offsets = new vector<int>(count + 1, 0);
+    neighborIds = new vector<TerritoryId>(edges.size());
+    adjacencyBits = new vector<uint64_t>();
+    rowWords = 0;
 
-        for (Territory* adjacent : *current->getAdjacentTerritories()) {
-            // Check if adjacent is part of the continent
-            bool isInContinent = false;
-            // Range-based for loop to check if adjacent territory is in the continent's territories
-            for (Territory* adjacentTerritory : *territories) {
-                if (adjacentTerritory == adjacent) {
-                    isInContinent = true;
-                    break;
-                }
-            }
+    // Counting sort of the edges by source territory
+    for (const auto& edge : edges) {
+        (*offsets)[edge.first + 1]++;
+    }
+    for (int i = 0; i < count; i++) {
+        (*offsets)[i + 1] += (*offsets)[i];
+    }
+    vector<int> cursor(offsets->begin(), offsets->end() - 1);
+    for (const auto& edge : edges) {
+        (*neighborIds)[cursor[edge.first]++] = edge.second;
+    }
 
-            // If adjacent is in continent and not visited yet
-            // isInContinent is false (means the territory is not in the continent), then not add the adjacent territory to the set (visited).
-            if (isInContinent && visited.count(adjacent) == 0) {
-                visited.insert(adjacent);
-                IsConnectedQueue.push(adjacent);
+    // Sort every row and compact away duplicates and self-loops
+    int write = 0;
+    int rowStart = 0;
+    for (int i = 0; i < count; i++) {
+        int rowEnd = (*offsets)[i + 1];
+        sort(neighborIds->begin() + rowStart, neighborIds->begin() + rowEnd);
+        (*offsets)[i] = write;
+        for (int k = rowStart; k < rowEnd; k++) {
+            TerritoryId neighbor = (*neighborIds)[k];
+            if (neighbor == i || (write > (*offsets)[i] && (*neighborIds)[write - 1] == neighbor)) {
+                continue;
             }
+            (*neighborIds)[write++] = neighbor;
         }
+        rowStart = rowEnd;
     }
-    
-    // Check if the number of visited territories is equal to the total number of territories
-    // If so, the continent is connected
-    // If not, it is disconnected
-    return visited.size() == territories->size();
+    (*offsets)[count] = write;
+    neighborIds->resize(write);
+    neighborIds->shrink_to_fit();
+
+    buildAdjacencyBits();
 }
-    
-// ==================== Map Implementation ====================
 
-// Constructors (Map)
-Map::Map(){
-    territories = new vector<Territory*>();
-    continents = new vector<Continent*>();
+// Adopts CSR rows that are already sorted and deduplicated (e.g. read from a binary image)
+MapTopology::MapTopology(int count, vector<int> rowOffsets, vector<TerritoryId> rowNeighbors) {
+    territoryCount = count;
+    offsets = new vector<int>(std::move(rowOffsets));
+    neighborIds = new vector<TerritoryId>(std::move(rowNeighbors));
+    adjacencyBits = new vector<uint64_t>();
+    rowWords = 0;
+    buildAdjacencyBits();
 }
-Map::Map(const Map& other){
-    territories = new vector<Territory*>();
-    continents = new vector<Continent*>();
 
-    // Deep copy territories
-    for (Territory* territory : *other.territories) {
-        territories->push_back(new Territory(*territory));
-    }
-    
-    // Deep copy continents
-    for (Continent* continent : *other.continents) {
-        continents->push_back(new Continent(*continent));
+// Dense bit matrix for O(1) adjacency tests, only for maps up to BITSET_LIMIT territories
+// Rows start on a word boundary so a row can be combined with an ownership bitset word by word
+void MapTopology::buildAdjacencyBits() {
+    adjacencyBits->clear();
+    rowWords = 0;
+    if (territoryCount > BITSET_LIMIT) return;
+
+    rowWords = (territoryCount + 63) / 64;
+    adjacencyBits->assign(static_cast<size_t>(rowWords) * territoryCount, 0);
+    for (int i = 0; i < territoryCount; i++) {
+        uint64_t* row = adjacencyBits->data() + static_cast<size_t>(i) * rowWords;
+        for (TerritoryId neighbor : getNeighbors(i)) {
+            row[neighbor / 64] |= uint64_t(1) << (neighbor % 64);
+        }
     }
 }
 
-//Destructor (Map)
-Map::~Map(){
-    // Delete all territories
-    for (Territory* territory : *territories) {
-        delete territory;
-    }
-    delete territories;
-    
-    // Delete all continents
-    for (Continent* continent : *continents) {
-        delete continent;
-    }
-    delete continents;
-    
-    territories = nullptr;
-    continents = nullptr;
+MapTopology::MapTopology(const MapTopology& other) {
+    territoryCount = other.territoryCount;
+    offsets = new vector<int>(*other.offsets);
+    neighborIds = new vector<TerritoryId>(*other.neighborIds);
+    adjacencyBits = new vector<uint64_t>(*other.adjacencyBits);
+    rowWords = other.rowWords;
 }
 
-// Assignment operator (Map)
-Map& Map::operator=(const Map& other){
-    if (this != &other) {
+// Destructor (MapTopology)
+MapTopology::~MapTopology() {
+    delete offsets;
+    delete neighborIds;
+    delete adjacencyBits;
+    offsets = nullptr;
+    neighborIds = nullptr;
+    adjacencyBits = nullptr;
+}
 
-            // Clean up existing data of (territories & continents)
-            for (Territory* territory : *territories) {
-                delete territory;
-            }
-            territories->clear();
-            
-            for (Continent* continent : *continents) {
-                delete continent;
-            }
-            continents->clear();
-            
-            // Deep copy territories
-            for (Territory* territory : *other.territories) {
-                territories->push_back(new Territory(*territory));
-            }
-            
-            // Deep copy continents
-            for (Continent* continent : *other.continents) {
-                continents->push_back(new Continent(*continent));
-            }
-        }
-        return *this;
+// Assignment operator (MapTopology)
+MapTopology& MapTopology::operator=(const MapTopology& other) {
+    if (this != &other) {
+        territoryCount = other.territoryCount;
+        *offsets = *other.offsets;
+        *neighborIds = *other.neighborIds;
+        *adjacencyBits = *other.adjacencyBits;
+        rowWords = other.rowWords;
+    }
+    return *this;
 }
 
-// Stream insertion operator (Map)
-ostream& operator<<(ostream& os, const Map& map){
-    os << "Map with " << map.territories->size() << " territories and " 
-       << map.continents->size() << " continents";
+// Stream insertion operator (MapTopology)
+ostream& operator<<(ostream& os, const MapTopology& topology) {
+    os << "Topology with " << topology.getTerritoryCount() << " territories and "
+       << topology.getEdgeCount() << " directed edges";
     return os;
 }
 
-// Getters
-vector<Territory*>* Map::getTerritories() const{
-    return territories;
+// Getters (MapTopology)
+int MapTopology::getTerritoryCount() const {
+    return territoryCount;
 }
-vector<Continent*>* Map::getContinents() const{
-    return continents;
+
+int MapTopology::getEdgeCount() const {
+    return static_cast<int>(neighborIds->size());
 }
 
-bool Map::getisTerritoryIsContinent() const{
-    return isTerritoryIsContinent;
+int MapTopology::getRowStart(TerritoryId id) const {
+    return (*offsets)[id];
 }
 
-// Setters
-void Map::setisTerritoryIsContinent(bool value){
-    isTerritoryIsContinent = value;
+int MapTopology::getDegree(TerritoryId id) const {
+    return (*offsets)[id + 1] - (*offsets)[id];
 }
 
-// Map operations
-void Map::addTerritory(Territory* territory){
-    if (territory != nullptr) {
-            territories->push_back(territory);
-    }
+span<const TerritoryId> MapTopology::getNeighbors(TerritoryId id) const {
+    return span<const TerritoryId>(neighborIds->data() + (*offsets)[id], getDegree(id));
 }
-void Map::addContinent(Continent* continent){
-    if (continent != nullptr) {
-        continents->push_back(continent);
-    }
+
+bool MapTopology::hasAdjacencyBits() const {
+    return rowWords > 0;
 }
-Territory* Map::getTerritory(const string& territoryName) const{
-    for (Territory* territory : *territories) {
-        if (territory->getName() == territoryName) {
-            return territory;
-        }
-    }
-    return nullptr;
+
+span<const uint64_t> MapTopology::getAdjacencyRow(TerritoryId id) const {
+    if (rowWords == 0) return span<const uint64_t>();
+    return span<const uint64_t>(adjacencyBits->data() + static_cast<size_t>(id) * rowWords, rowWords);
 }
-Continent* Map::getContinent(const string& continentName) const{
-    for (Continent* continent : *continents) {
-        if (continent->getName() == continentName) {
-            return continent;
-        }
+
+// Topology operations
+bool MapTopology::areAdjacent(TerritoryId from, TerritoryId to) const {
+    if (from < 0 || to < 0 || from >= territoryCount || to >= territoryCount) return false;
+
+    if (rowWords > 0) {
+        return ((*adjacencyBits)[static_cast<size_t>(from) * rowWords + to / 64] >> (to % 64)) & 1;
     }
-    return nullptr;
+    span<const TerritoryId> row = getNeighbors(from);
+    return binary_search(row.begin(), row.end(), to);
 }
 
-// Validation methods
-// Validate the map based on three criteria
-// 1) the map is a connected graph, 
-// 2) continents are connected subgraphs 
-// 3) each country belongs to one and only one continent. 
+// ==================== SpatialIndex Implementation ====================
+
+// Coordinate a range is split on at the given depth
+static int splitCoordinate(MapPoint point, int depth) {
+    return (depth % 2 == 0) ? point.x : point.y;
+}
+
+// Orders slots [lo, hi) of order so that the median (on x or y by depth) sits in the middle,
+// smaller coordinates before it and larger ones after, then does the same for both halves
+static void buildKdOrder(const vector<MapPoint>& positions, vector<int>& order, int lo, int hi, int depth) {
+    if (hi - lo <= 1) return;
+    int mid = lo + (hi - lo) / 2;
+    nth_element(order.begin() + lo, order.begin() + mid, order.begin() + hi, [&positions, depth](int a, int b) {
+        return splitCoordinate(positions[a], depth) < splitCoordinate(positions[b], depth);
+    });
+    buildKdOrder(positions, order, lo, mid, depth + 1);
+    buildKdOrder(positions, order, mid + 1, hi, depth + 1);
+}
+
+// Constructors (SpatialIndex)
+SpatialIndex::SpatialIndex() {
+    points = new vector<MapPoint>();
+    ids = new vector<TerritoryId>();
+}
+
+SpatialIndex::SpatialIndex(const vector<MapPoint>& positions) {
+    vector<int> order(positions.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = static_cast<int>(i);
+    }
+    buildKdOrder(positions, order, 0, static_cast<int>(order.size()), 0);
+
+    points = new vector<MapPoint>();
+    ids = new vector<TerritoryId>();
+    points->reserve(order.size());
+    ids->reserve(order.size());
+    for (int slot : order) {
+        points->push_back(positions[slot]);
+        ids->push_back(static_cast<TerritoryId>(slot));
+    }
+}
+
+SpatialIndex::SpatialIndex(const SpatialIndex& other) {
+    points = new vector<MapPoint>(*other.points);
+    ids = new vector<TerritoryId>(*other.ids);
+}
+
+// Destructor (SpatialIndex)
+SpatialIndex::~SpatialIndex() {
+    delete points;
+    delete ids;
+    points = nullptr;
+    ids = nullptr;
+}
+
+// Assignment operator (SpatialIndex)
+SpatialIndex& SpatialIndex::operator=(const SpatialIndex& other) {
+    if (this != &other) {
+        *points = *other.points;
+        *ids = *other.ids;
+    }
+    return *this;
+}
+
+// Stream insertion operator (SpatialIndex)
+ostream& operator<<(ostream& os, const SpatialIndex& index) {
+    os << "Spatial index over " << index.size() << " territories";
+    return os;
+}
+
+// Getters (SpatialIndex)
+int SpatialIndex::size() const {
+    return static_cast<int>(points->size());
+}
+
+static int64_t squaredDistance(MapPoint a, MapPoint b) {
+    int64_t dx = static_cast<int64_t>(a.x) - b.x;
+    int64_t dy = static_cast<int64_t>(a.y) - b.y;
+    return dx * dx + dy * dy;
+}
+
+// Descends into the half containing the target first; the other half is only visited
+// when the splitting line is closer than the best distance found so far
+void SpatialIndex::findNearest(int lo, int hi, int depth, MapPoint target, TerritoryId& best, int64_t& bestDistance) const {
+    if (lo >= hi) return;
+    int mid = lo + (hi - lo) / 2;
+    MapPoint median = (*points)[mid];
+
+    int64_t distance = squaredDistance(median, target);
+    if (distance < bestDistance || (distance == bestDistance && (*ids)[mid] < best)) {
+        bestDistance = distance;
+        best = (*ids)[mid];
+    }
+
+    int64_t gap = static_cast<int64_t>(splitCoordinate(target, depth)) - splitCoordinate(median, depth);
+    bool targetBelow = gap < 0;
+    findNearest(targetBelow ? lo : mid + 1, targetBelow ? mid : hi, depth + 1, target, best, bestDistance);
+    if (gap * gap <= bestDistance) {
+        findNearest(targetBelow ? mid + 1 : lo, targetBelow ? hi : mid, depth + 1, target, best, bestDistance);
+    }
+}
+
+// Collects the tree slots inside [low, high] (inclusive), skipping halves outside the box
+void SpatialIndex::findInBox(int lo, int hi, int depth, MapPoint low, MapPoint high, vector<int>& slots) const {
+    if (lo >= hi) return;
+    int mid = lo + (hi - lo) / 2;
+    MapPoint median = (*points)[mid];
+
+    if (median.x >= low.x && median.x <= high.x && median.y >= low.y && median.y <= high.y) {
+        slots.push_back(mid);
+    }
+    int split = splitCoordinate(median, depth);
+    if (splitCoordinate(low, depth) <= split) {
+        findInBox(lo, mid, depth + 1, low, high, slots);
+    }
+    if (splitCoordinate(high, depth) >= split) {
+        findInBox(mid + 1, hi, depth + 1, low, high, slots);
+    }
+}
+
+// Territory closest to (x, y); ties go to the lowest id
+TerritoryId SpatialIndex::findNearest(int x, int y) const {
+    TerritoryId best = NO_TERRITORY;
+    int64_t bestDistance = INT64_MAX;
+    findNearest(0, size(), 0, MapPoint{x, y}, best, bestDistance);
+    return best;
+}
+
+// Clamps a box corner computed in 64 bits to the coordinates a point can have
+static int clampCoordinate(int64_t coordinate) {
+    return static_cast<int>(max<int64_t>(INT_MIN, min<int64_t>(INT_MAX, coordinate)));
+}
+
+// Territories within radius of (x, y), borders included (none for a negative radius)
+vector<TerritoryId> SpatialIndex::findInRadius(int x, int y, int radius) const {
+    vector<int> slots;
+    MapPoint center{x, y};
+    if (radius < 0) {
+        return vector<TerritoryId>();
+    }
+    // The box around the circle is built in 64 bits: x + radius overflows an int for large radii
+    MapPoint low{clampCoordinate(static_cast<int64_t>(x) - radius), clampCoordinate(static_cast<int64_t>(y) - radius)};
+    MapPoint high{clampCoordinate(static_cast<int64_t>(x) + radius), clampCoordinate(static_cast<int64_t>(y) + radius)};
+    findInBox(0, size(), 0, low, high, slots);
+
+    vector<TerritoryId> found;
+    int64_t limit = static_cast<int64_t>(radius) * radius;
+    for (int slot : slots) {
+        if (squaredDistance((*points)[slot], center) <= limit) {
+            found.push_back((*ids)[slot]);
+        }
+    }
+    sort(found.begin(), found.end());
+    return found;
+}
+
+// Territories inside the box, borders included
+vector<TerritoryId> SpatialIndex::findInBox(int minX, int minY, int maxX, int maxY) const {
+    vector<int> slots;
+    findInBox(0, size(), 0, MapPoint{minX, minY}, MapPoint{maxX, maxY}, slots);
+
+    vector<TerritoryId> found;
+    found.reserve(slots.size());
+    for (int slot : slots) {
+        found.push_back((*ids)[slot]);
+    }
+    sort(found.begin(), found.end());
+    return found;
+}
+
+// ==================== TerritoryState Implementation ====================
+
+// Army reduction kernels: armies[i] counts only where slots[i] == slot.
+// Each has a scalar version and an AVX2 version working on 8 territories per step
+
+enum class ArmyReduction { Max, Min };
+
+static int reduceArmiesScalar(const int32_t* slots, const int* armies, size_t count, int32_t slot, ArmyReduction kind) {
+    int best = (kind == ArmyReduction::Max) ? INT_MIN : INT_MAX;
+    for (size_t i = 0; i < count; i++) {
+        if (slots[i] == slot) {
+            best = (kind == ArmyReduction::Max) ? max(best, armies[i]) : min(best, armies[i]);
+        }
+    }
+    return best;
+}
+
+static long long sumArmiesScalar(const int32_t* slots, const int* armies, size_t count, int32_t slot) {
+    long long total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += (slots[i] == slot) ? armies[i] : 0;
+    }
+    return total;
+}
+
+static size_t findArmiesScalar(const int32_t* slots, const int* armies, size_t begin, size_t count, int32_t slot, int value) {
+    for (size_t i = begin; i < count; i++) {
+        if (slots[i] == slot && armies[i] == value) {
+            return i;
+        }
+    }
+    return count;
+}
+
+#ifdef MAP_AVX2_KERNELS
+static bool cpuHasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+__attribute__((target("avx2")))
+static int reduceArmiesAvx2(const int32_t* slots, const int* armies, size_t count, int32_t slot, ArmyReduction kind) {
+    bool wantMax = (kind == ArmyReduction::Max);
+    __m256i target = _mm256_set1_epi32(slot);
+    __m256i fill = _mm256_set1_epi32(wantMax ? INT_MIN : INT_MAX);
+    __m256i best = fill;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i owned = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(slots + i)), target);
+        __m256i values = _mm256_blendv_epi8(fill, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(armies + i)), owned);
+        best = wantMax ? _mm256_max_epi32(best, values) : _mm256_min_epi32(best, values);
+    }
+    alignas(32) int lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), best);
+    int result = reduceArmiesScalar(slots + i, armies + i, count - i, slot, kind);
+    for (int lane : lanes) {
+        result = wantMax ? max(result, lane) : min(result, lane);
+    }
+    return result;
+}
+
+__attribute__((target("avx2")))
+static long long sumArmiesAvx2(const int32_t* slots, const int* armies, size_t count, int32_t slot) {
+    __m256i target = _mm256_set1_epi32(slot);
+    __m256i total = _mm256_setzero_si256();    // 4 x 64-bit lanes, no overflow
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i owned = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(slots + i)), target);
+        __m256i values = _mm256_and_si256(owned, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(armies + i)));
+        total = _mm256_add_epi64(total, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(values)));
+        total = _mm256_add_epi64(total, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(values, 1)));
+    }
+    alignas(32) long long lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumArmiesScalar(slots + i, armies + i, count - i, slot);
+}
+
+__attribute__((target("avx2")))
+static size_t findArmiesAvx2(const int32_t* slots, const int* armies, size_t count, int32_t slot, int value) {
+    __m256i target = _mm256_set1_epi32(slot);
+    __m256i wanted = _mm256_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i owned = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(slots + i)), target);
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(armies + i)), wanted);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(owned, equal)));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return findArmiesScalar(slots, armies, i, count, slot, value);
+}
+#endif
+
+static int reduceArmies(const int32_t* slots, const int* armies, size_t count, int32_t slot, ArmyReduction kind) {
+#ifdef MAP_AVX2_KERNELS
+    if (cpuHasAvx2()) return reduceArmiesAvx2(slots, armies, count, slot, kind);
+#endif
+    return reduceArmiesScalar(slots, armies, count, slot, kind);
+}
+
+static long long sumArmies(const int32_t* slots, const int* armies, size_t count, int32_t slot) {
+#ifdef MAP_AVX2_KERNELS
+    if (cpuHasAvx2()) return sumArmiesAvx2(slots, armies, count, slot);
+#endif
+    return sumArmiesScalar(slots, armies, count, slot);
+}
+
+static size_t findArmies(const int32_t* slots, const int* armies, size_t count, int32_t slot, int value) {
+#ifdef MAP_AVX2_KERNELS
+    if (cpuHasAvx2()) return findArmiesAvx2(slots, armies, count, slot, value);
+#endif
+    return findArmiesScalar(slots, armies, 0, count, slot, value);
+}
+
+// Constructors and destructor (TerritoryState)
+TerritoryState::TerritoryState() {
+    owners = new vector<Player*>();
+    armies = new vector<int>();
+    ownerSlots = new vector<int32_t>();
+    slotPlayers = new vector<const Player*>(1, nullptr);
+    slotBits = new vector<vector<uint64_t>>(1);
+}
+
+TerritoryState::TerritoryState(const TerritoryState& other) {
+    owners = new vector<Player*>(*other.owners);
+    armies = new vector<int>(*other.armies);
+    ownerSlots = new vector<int32_t>(*other.ownerSlots);
+    slotPlayers = new vector<const Player*>(*other.slotPlayers);
+    slotBits = new vector<vector<uint64_t>>(*other.slotBits);
+}
+
+TerritoryState::~TerritoryState() {
+    delete owners;
+    delete armies;
+    delete ownerSlots;
+    delete slotPlayers;
+    delete slotBits;
+    owners = nullptr;
+    armies = nullptr;
+    ownerSlots = nullptr;
+    slotPlayers = nullptr;
+    slotBits = nullptr;
+}
+
+// Assignment operator (TerritoryState)
+TerritoryState& TerritoryState::operator=(const TerritoryState& other) {
+    if (this != &other) {
+        *owners = *other.owners;
+        *armies = *other.armies;
+        *ownerSlots = *other.ownerSlots;
+        *slotPlayers = *other.slotPlayers;
+        *slotBits = *other.slotBits;
+    }
+    return *this;
+}
+
+// Stream insertion operator (TerritoryState)
+ostream& operator<<(ostream& os, const TerritoryState& state) {
+    os << "TerritoryState: " << state.size() << " territories, "
+       << state.slotPlayers->size() - 1 << " owners seen";
+    return os;
+}
+
+// Getters (TerritoryState)
+int TerritoryState::size() const {
+    return static_cast<int>(owners->size());
+}
+
+Player* TerritoryState::getOwner(TerritoryId id) const {
+    return (*owners)[id];
+}
+
+int TerritoryState::getArmies(TerritoryId id) const {
+    return (*armies)[id];
+}
+
+span<const int> TerritoryState::getArmiesArray() const {
+    return span<const int>(*armies);
+}
+
+span<const uint64_t> TerritoryState::getOwnedBits(const Player* player) const {
+    int32_t slot = findSlot(player);
+    if (slot < 0) return span<const uint64_t>();
+    return span<const uint64_t>((*slotBits)[slot]);
+}
+
+// Setters (TerritoryState)
+void TerritoryState::setOwner(TerritoryId id, Player* owner) {
+    uint64_t bit = uint64_t(1) << (id % 64);
+    (*slotBits)[(*ownerSlots)[id]][id / 64] &= ~bit;
+    (*owners)[id] = owner;
+    (*ownerSlots)[id] = slotFor(owner);
+    (*slotBits)[(*ownerSlots)[id]][id / 64] |= bit;
+}
+
+void TerritoryState::setArmies(TerritoryId id, int newArmies) {
+    (*armies)[id] = newArmies;
+}
+
+// Players are few, a linear search over the slots is cheaper than hashing
+int32_t TerritoryState::findSlot(const Player* player) const {
+    for (size_t slot = 0; slot < slotPlayers->size(); slot++) {
+        if ((*slotPlayers)[slot] == player) {
+            return static_cast<int32_t>(slot);
+        }
+    }
+    return -1;
+}
+
+int32_t TerritoryState::slotFor(const Player* player) {
+    int32_t slot = findSlot(player);
+    if (slot < 0) {
+        slot = static_cast<int32_t>(slotPlayers->size());
+        slotPlayers->push_back(player);
+        slotBits->emplace_back((owners->size() + 63) / 64, 0);
+    }
+    return slot;
+}
+
+// State operations
+void TerritoryState::addTerritory(Player* owner, int territoryArmies) {
+    size_t id = owners->size();
+    if (id % 64 == 0) {
+        for (vector<uint64_t>& bits : *slotBits) bits.push_back(0);
+    }
+    owners->push_back(owner);
+    armies->push_back(territoryArmies);
+    ownerSlots->push_back(slotFor(owner));
+    (*slotBits)[ownerSlots->back()][id / 64] |= uint64_t(1) << (id % 64);
+}
+
+void TerritoryState::clear() {
+    owners->clear();
+    armies->clear();
+    ownerSlots->clear();
+    slotPlayers->assign(1, nullptr);
+    slotBits->assign(1, vector<uint64_t>());
+}
+
+// Two passes: the extreme value first, then the first territory holding it
+TerritoryId TerritoryState::findStrongest(const Player* player) const {
+    int32_t slot = findSlot(player);
+    if (slot < 0) return NO_TERRITORY;
+    int strongest = reduceArmies(ownerSlots->data(), armies->data(), armies->size(), slot, ArmyReduction::Max);
+    size_t found = findArmies(ownerSlots->data(), armies->data(), armies->size(), slot, strongest);
+    return (found < armies->size()) ? static_cast<TerritoryId>(found) : NO_TERRITORY;
+}
+
+TerritoryId TerritoryState::findWeakest(const Player* player) const {
+    int32_t slot = findSlot(player);
+    if (slot < 0) return NO_TERRITORY;
+    int weakest = reduceArmies(ownerSlots->data(), armies->data(), armies->size(), slot, ArmyReduction::Min);
+    size_t found = findArmies(ownerSlots->data(), armies->data(), armies->size(), slot, weakest);
+    return (found < armies->size()) ? static_cast<TerritoryId>(found) : NO_TERRITORY;
+}
+
+long long TerritoryState::getTotalArmies(const Player* player) const {
+    int32_t slot = findSlot(player);
+    if (slot < 0) return 0;
+    return sumArmies(ownerSlots->data(), armies->data(), armies->size(), slot);
+}
+
+// ==================== MapAnalysis Implementation ====================
+
+// Constructors (MapAnalysis)
+MapAnalysis::MapAnalysis() {
+    territoryCount = 0;
+    edgeCount = 0;
+    componentCount = 0;
+    flags = new vector<uint8_t>();
+    bridgeCounts = new vector<int>();
+    articulationPoints = new vector<TerritoryId>();
+    bridges = new vector<pair<TerritoryId, TerritoryId>>();
+    continentBorders = new vector<vector<TerritoryId>>();
+    minDegree = 0;
+    maxDegree = 0;
+    diameter = 0;
+    undirected = make_shared<const MapTopology>();
+}
+
+// Analyses the map as it is now; the map keeps the result until its graph or continents change
+MapAnalysis::MapAnalysis(const Map& map) : MapAnalysis() {
+    const vector<Territory*>& territories = *map.getTerritories();
+    const MapTopology* topology = map.getTopology();
+    territoryCount = topology->getTerritoryCount();
+
+    // Every edge in both directions, without repeats (the CSR constructor sorts and deduplicates)
+    vector<pair<TerritoryId, TerritoryId>> edges;
+    edges.reserve(2 * static_cast<size_t>(topology->getEdgeCount()));
+    for (TerritoryId id = 0; id < territoryCount; id++) {
+        for (TerritoryId neighbor : topology->getNeighbors(id)) {
+            edges.emplace_back(id, neighbor);
+            edges.emplace_back(neighbor, id);
+        }
+    }
+    undirected = make_shared<const MapTopology>(territoryCount, edges);
+    const MapTopology& graph = *undirected;
+    edgeCount = graph.getEdgeCount() / 2;
+
+    flags->assign(territoryCount, 0);
+    bridgeCounts->assign(territoryCount, 0);
+    minDegree = (territoryCount > 0) ? INT_MAX : 0;
+    for (TerritoryId id = 0; id < territoryCount; id++) {
+        minDegree = min(minDegree, graph.getDegree(id));
+        maxDegree = max(maxDegree, graph.getDegree(id));
+    }
+
+    // Borders: a neighbor whose continent differs (territories without a continent have no border)
+    continentBorders->assign(map.getContinents()->size(), vector<TerritoryId>());
+    for (TerritoryId id = 0; id < territoryCount; id++) {
+        Continent* continent = territories[id]->getContinent();
+        if (continent == nullptr || map.getContinent(continent->getId()) != continent) continue;
+        for (TerritoryId neighbor : graph.getNeighbors(id)) {
+            if (territories[neighbor]->getContinent() != continent) {
+                (*flags)[id] |= BORDER;
+                (*continentBorders)[continent->getId()].push_back(id);
+                break;
+            }
+        }
+    }
+
+    vector<TerritoryId> roots;
+    findChokepoints(graph, roots);
+    findDiameter(graph, roots);
+}
+
+// Tarjan's low-link search over every component, with an explicit stack:
+// low[v] is the earliest discovery time reachable from the subtree of v through one back edge.
+// Tree edge (p, v) is a bridge when low[v] > discovered[p]; p is an articulation point when
+// low[v] >= discovered[p] for a child v (the root: when it has two children or more)
+void MapAnalysis::findChokepoints(const MapTopology& graph, vector<TerritoryId>& roots) {
+    vector<int> discovered(territoryCount, -1);
+    vector<int> low(territoryCount, 0);
+    vector<TerritoryId> parent(territoryCount, NO_TERRITORY);
+    vector<int> nextNeighbor(territoryCount, 0);
+    vector<TerritoryId> stack;
+    int time = 0;
+
+    for (TerritoryId root = 0; root < territoryCount; root++) {
+        if (discovered[root] != -1) continue;
+        roots.push_back(root);
+        componentCount++;
+        int rootChildren = 0;
+        discovered[root] = low[root] = time++;
+        stack.push_back(root);
+
+        while (!stack.empty()) {
+            TerritoryId id = stack.back();
+            span<const TerritoryId> neighbors = graph.getNeighbors(id);
+            if (nextNeighbor[id] < static_cast<int>(neighbors.size())) {
+                TerritoryId neighbor = neighbors[nextNeighbor[id]++];
+                if (discovered[neighbor] == -1) {
+                    parent[neighbor] = id;
+                    discovered[neighbor] = low[neighbor] = time++;
+                    stack.push_back(neighbor);
+                    if (id == root) rootChildren++;
+                } else if (neighbor != parent[id]) {
+                    low[id] = min(low[id], discovered[neighbor]);
+                }
+                continue;
+            }
+
+            // Subtree of id finished: report it to its parent
+            stack.pop_back();
+            TerritoryId above = parent[id];
+            if (above == NO_TERRITORY) continue;
+            low[above] = min(low[above], low[id]);
+            if (low[id] > discovered[above]) {
+                bridges->emplace_back(min(above, id), max(above, id));
+                (*bridgeCounts)[above]++;
+                (*bridgeCounts)[id]++;
+            }
+            if (above != root && low[id] >= discovered[above]) {
+                (*flags)[above] |= ARTICULATION;
+            }
+        }
+        if (rootChildren > 1) {
+            (*flags)[root] |= ARTICULATION;
+        }
+    }
+
+    for (TerritoryId id = 0; id < territoryCount; id++) {
+        if ((*flags)[id] & ARTICULATION) articulationPoints->push_back(id);
+    }
+    sort(bridges->begin(), bridges->end());
+}
+
+// Double sweep in every component: the farthest territory from any start is a peripheral one,
+// and its eccentricity is a lower bound of the component's diameter
+void MapAnalysis::findDiameter(const MapTopology& graph, const vector<TerritoryId>& roots) {
+    vector<int> distance(territoryCount, -1);
+    vector<TerritoryId> queue;
+    auto sweep = [&](TerritoryId start) {
+        for (TerritoryId id : queue) distance[id] = -1;     // reset only what the previous sweep reached
+        queue.assign(1, start);
+        distance[start] = 0;
+        for (size_t head = 0; head < queue.size(); head++) {
+            for (TerritoryId neighbor : graph.getNeighbors(queue[head])) {
+                if (distance[neighbor] == -1) {
+                    distance[neighbor] = distance[queue[head]] + 1;
+                    queue.push_back(neighbor);
+                }
+            }
+        }
+        return queue.back();    // last reached is the farthest
+    };
+
+    size_t largest = 0;
+    for (TerritoryId root : roots) {
+        TerritoryId far = sweep(root);
+        TerritoryId other = sweep(far);
+        if (queue.size() > largest || (queue.size() == largest && distance[other] > diameter)) {
+            largest = queue.size();
+            diameter = distance[other];
+        }
+    }
+}
+
+MapAnalysis::MapAnalysis(const MapAnalysis& other) {
+    territoryCount = other.territoryCount;
+    edgeCount = other.edgeCount;
+    componentCount = other.componentCount;
+    flags = new vector<uint8_t>(*other.flags);
+    bridgeCounts = new vector<int>(*other.bridgeCounts);
+    articulationPoints = new vector<TerritoryId>(*other.articulationPoints);
+    bridges = new vector<pair<TerritoryId, TerritoryId>>(*other.bridges);
+    continentBorders = new vector<vector<TerritoryId>>(*other.continentBorders);
+    minDegree = other.minDegree;
+    maxDegree = other.maxDegree;
+    diameter = other.diameter;
+    undirected = other.undirected;  // never modified, shared
+}
+
+// Destructor (MapAnalysis)
+MapAnalysis::~MapAnalysis() {
+    delete flags;
+    delete bridgeCounts;
+    delete articulationPoints;
+    delete bridges;
+    delete continentBorders;
+    flags = nullptr;
+    bridgeCounts = nullptr;
+    articulationPoints = nullptr;
+    bridges = nullptr;
+    continentBorders = nullptr;
+}
+
+// Assignment operator (MapAnalysis)
+MapAnalysis& MapAnalysis::operator=(const MapAnalysis& other) {
+    if (this != &other) {
+        territoryCount = other.territoryCount;
+        edgeCount = other.edgeCount;
+        componentCount = other.componentCount;
+        *flags = *other.flags;
+        *bridgeCounts = *other.bridgeCounts;
+        *articulationPoints = *other.articulationPoints;
+        *bridges = *other.bridges;
+        *continentBorders = *other.continentBorders;
+        minDegree = other.minDegree;
+        maxDegree = other.maxDegree;
+        diameter = other.diameter;
+        undirected = other.undirected;
+    }
+    return *this;
+}
+
+// Stream insertion operator (MapAnalysis)
+ostream& operator<<(ostream& os, const MapAnalysis& analysis) {
+    os << analysis.territoryCount << " territories, " << analysis.edgeCount << " edges, "
+       << analysis.componentCount << " component(s), degree " << analysis.minDegree << "-" << analysis.maxDegree
+       << " (average " << fixed << setprecision(2) << analysis.getAverageDegree() << defaultfloat << "), diameter "
+       << analysis.diameter << ", " << analysis.articulationPoints->size() << " articulation point(s), "
+       << analysis.bridges->size() << " bridge(s)";
+    return os;
+}
+
+// Getters (MapAnalysis)
+int MapAnalysis::getTerritoryCount() const {
+    return territoryCount;
+}
+
+int MapAnalysis::getEdgeCount() const {
+    return edgeCount;
+}
+
+int MapAnalysis::getComponentCount() const {
+    return componentCount;
+}
+
+int MapAnalysis::getMinDegree() const {
+    return minDegree;
+}
+
+int MapAnalysis::getMaxDegree() const {
+    return maxDegree;
+}
+
+double MapAnalysis::getAverageDegree() const {
+    return (territoryCount > 0) ? 2.0 * edgeCount / territoryCount : 0.0;
+}
+
+int MapAnalysis::getDiameter() const {
+    return diameter;
+}
+
+const vector<TerritoryId>& MapAnalysis::getArticulationPoints() const {
+    return *articulationPoints;
+}
+
+const vector<pair<TerritoryId, TerritoryId>>& MapAnalysis::getBridges() const {
+    return *bridges;
+}
+
+const vector<TerritoryId>& MapAnalysis::getBorderTerritories(ContinentId continent) const {
+    static const vector<TerritoryId> none;
+    if (continent < 0 || continent >= static_cast<ContinentId>(continentBorders->size())) {
+        return none;
+    }
+    return (*continentBorders)[continent];
+}
+
+const MapTopology& MapAnalysis::getUndirectedGraph() const {
+    return *undirected;
+}
+
+// Queries (MapAnalysis)
+bool MapAnalysis::isArticulationPoint(TerritoryId id) const {
+    return id >= 0 && id < territoryCount && ((*flags)[id] & ARTICULATION) != 0;
+}
+
+bool MapAnalysis::isBorder(TerritoryId id) const {
+    return id >= 0 && id < territoryCount && ((*flags)[id] & BORDER) != 0;
+}
+
+int MapAnalysis::getBridgeCount(TerritoryId id) const {
+    return (id >= 0 && id < territoryCount) ? (*bridgeCounts)[id] : 0;
+}
+
+bool MapAnalysis::isBridge(TerritoryId a, TerritoryId b) const {
+    if (getBridgeCount(a) == 0 || getBridgeCount(b) == 0) return false;
+    return binary_search(bridges->begin(), bridges->end(), make_pair(min(a, b), max(a, b)));
+}
+
+// ==================== MapRouting Implementation ====================
+
+// Calls task(i) for every i in [0, count) on threadCount threads (the calling thread included)
+static void runInParallel(int count, int threadCount, const function<void(int)>& task) {
+    threadCount = max(1, min(threadCount, count));
+    atomic<int> nextTask(0);
+    auto worker = [&]() {
+        for (int i = nextTask++; i < count; i = nextTask++) {
+            task(i);
+        }
+    };
+
+    vector<thread> pool;
+    for (int i = 1; i < threadCount; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (thread& t : pool) {
+        t.join();
+    }
+}
+
+// Hop distances from source along the edges of graph into distance[0, n), -1 where unreached;
+// queue ends up holding the reached territories in BFS order, parent (if any) their BFS tree
+static void findHopDistances(const MapTopology& graph, TerritoryId source, int* distance, vector<TerritoryId>& queue,
+                             int* parent = nullptr) {
+    fill(distance, distance + graph.getTerritoryCount(), -1);
+    queue.clear();
+    distance[source] = 0;
+    queue.push_back(source);
+    for (size_t head = 0; head < queue.size(); head++) {
+        TerritoryId current = queue[head];
+        for (TerritoryId neighbor : graph.getNeighbors(current)) {
+            if (distance[neighbor] < 0) {
+                distance[neighbor] = distance[current] + 1;
+                if (parent != nullptr) parent[neighbor] = current;
+                queue.push_back(neighbor);
+            }
+        }
+    }
+}
+
+// Constructors (MapRouting)
+MapRouting::MapRouting() {
+    territoryCount = 0;
+    distances = new vector<uint16_t>();
+    nextHops = new vector<uint16_t>();
+    landmarks = new vector<TerritoryId>();
+    fromLandmark = new vector<int>();
+    toLandmark = new vector<int>();
+    treeIndex = new vector<int>();
+    subtreeSizes = new vector<int>();
+    topology = make_shared<const MapTopology>();
+}
+
+// Routes over the graph as it is now; the map keeps the result until its edges change
+MapRouting::MapRouting(shared_ptr<const MapTopology> topology, int threadCount) : MapRouting() {
+    this->topology = topology;
+    territoryCount = topology->getTerritoryCount();
+    if (threadCount <= 0) {
+        threadCount = max(1u, thread::hardware_concurrency());
+    }
+
+    if (territoryCount <= TABLE_LIMIT) {
+        buildTables(threadCount);
+    } else {
+        vector<pair<TerritoryId, TerritoryId>> reversed;
+        reversed.reserve(topology->getEdgeCount());
+        for (TerritoryId id = 0; id < territoryCount; id++) {
+            for (TerritoryId neighbor : topology->getNeighbors(id)) {
+                reversed.emplace_back(neighbor, id);
+            }
+        }
+        buildLandmarks(MapTopology(territoryCount, reversed), threadCount);
+    }
+}
+
+// One BFS per source; a territory reached from another one inherits its first hop,
+// the neighbors of the source are their own first hop. Small maps stay on one thread
+void MapRouting::buildTables(int threadCount) {
+    size_t n = territoryCount;
+    distances->assign(n * n, UNREACHABLE);
+    nextHops->assign(n * n, UNREACHABLE);
+    if (territoryCount < 256) {
+        threadCount = 1;
+    }
+
+    runInParallel(territoryCount, threadCount, [&](int source) {
+        uint16_t* distance = distances->data() + source * n;
+        uint16_t* hop = nextHops->data() + source * n;
+        vector<TerritoryId> queue;
+        queue.reserve(n);
+        distance[source] = 0;
+        queue.push_back(source);
+        for (size_t head = 0; head < queue.size(); head++) {
+            TerritoryId current = queue[head];
+            for (TerritoryId neighbor : topology->getNeighbors(current)) {
+                if (distance[neighbor] == UNREACHABLE) {
+                    distance[neighbor] = distance[current] + 1;
+                    hop[neighbor] = (current == source) ? neighbor : hop[current];
+                    queue.push_back(neighbor);
+                }
+            }
+        }
+    });
+}
+
+// Farthest-point selection: each landmark is the territory farthest from every landmark chosen so far
+// (territories no landmark reaches come first, so every piece of the map gets one). Each choice needs
+// the BFS of the previous landmark, so the forward searches run in turn; the backward ones run in parallel
+void MapRouting::buildLandmarks(const MapTopology& reverse, int threadCount) {
+    size_t n = territoryCount;
+    int count = min(LANDMARK_COUNT, territoryCount);
+    fromLandmark->assign(count * n, -1);
+    toLandmark->assign(count * n, -1);
+    treeIndex->assign(count * n, -1);
+    subtreeSizes->assign(count * n, 0);
+
+    vector<TerritoryId> queue;
+    queue.reserve(n);
+    vector<int> parent(n);
+    vector<int> nextIndex(n);
+    vector<int> closest(n, INT_MAX);    // distance from the nearest landmark so far
+    findHopDistances(*topology, 0, fromLandmark->data(), queue);
+    TerritoryId next = queue.back();    // farthest from territory 0 to start with
+
+    for (int l = 0; l < count; l++) {
+        landmarks->push_back(next);
+        int* distance = fromLandmark->data() + l * n;
+        findHopDistances(*topology, next, distance, queue, parent.data());
+
+        // Preorder intervals of the BFS tree: sizes bottom-up, then each child takes the next
+        // free range of its parent (parents come first in BFS order)
+        int* index = treeIndex->data() + l * n;
+        int* size = subtreeSizes->data() + l * n;
+        for (size_t i = queue.size(); i-- > 0;) {
+            size[queue[i]] += 1;
+            if (i > 0) size[parent[queue[i]]] += size[queue[i]];
+        }
+        index[next] = 0;
+        nextIndex[next] = 1;
+        for (size_t i = 1; i < queue.size(); i++) {
+            TerritoryId id = queue[i];
+            index[id] = nextIndex[parent[id]];
+            nextIndex[parent[id]] += size[id];
+            nextIndex[id] = index[id] + 1;
+        }
+        closest[next] = -1;             // never chosen again
+        int farthest = -1;
+        for (TerritoryId id = 0; id < territoryCount; id++) {
+            if (distance[id] >= 0 && distance[id] < closest[id]) {
+                closest[id] = distance[id];
+            }
+            if (closest[id] > farthest) {
+                farthest = closest[id];
+                next = id;
+            }
+        }
+    }
+
+    runInParallel(count, threadCount, [&](int l) {
+        vector<TerritoryId> backwardQueue;
+        backwardQueue.reserve(n);
+        findHopDistances(reverse, (*landmarks)[l], toLandmark->data() + l * n, backwardQueue);
+    });
+}
+
+MapRouting::MapRouting(const MapRouting& other) {
+    territoryCount = other.territoryCount;
+    distances = new vector<uint16_t>(*other.distances);
+    nextHops = new vector<uint16_t>(*other.nextHops);
+    landmarks = new vector<TerritoryId>(*other.landmarks);
+    fromLandmark = new vector<int>(*other.fromLandmark);
+    toLandmark = new vector<int>(*other.toLandmark);
+    treeIndex = new vector<int>(*other.treeIndex);
+    subtreeSizes = new vector<int>(*other.subtreeSizes);
+    topology = other.topology;
+}
+
+// Destructor (MapRouting)
+MapRouting::~MapRouting() {
+    delete distances;
+    delete nextHops;
+    delete landmarks;
+    delete fromLandmark;
+    delete toLandmark;
+    delete treeIndex;
+    delete subtreeSizes;
+    distances = nullptr;
+    nextHops = nullptr;
+    landmarks = nullptr;
+    fromLandmark = nullptr;
+    toLandmark = nullptr;
+    treeIndex = nullptr;
+    subtreeSizes = nullptr;
+}
+
+// Assignment operator (MapRouting)
+MapRouting& MapRouting::operator=(const MapRouting& other) {
+    if (this != &other) {
+        territoryCount = other.territoryCount;
+        *distances = *other.distances;
+        *nextHops = *other.nextHops;
+        *landmarks = *other.landmarks;
+        *fromLandmark = *other.fromLandmark;
+        *toLandmark = *other.toLandmark;
+        *treeIndex = *other.treeIndex;
+        *subtreeSizes = *other.subtreeSizes;
+        topology = other.topology;
+    }
+    return *this;
+}
+
+// Stream insertion operator (MapRouting)
+ostream& operator<<(ostream& os, const MapRouting& routing) {
+    os << routing.territoryCount << " territories, ";
+    if (routing.isExact()) {
+        os << "exact tables (" << (routing.distances->size() + routing.nextHops->size()) * sizeof(uint16_t) / 1024 << " KB)";
+    } else {
+        os << routing.landmarks->size() << " landmarks";
+    }
+    return os;
+}
+
+// Getters (MapRouting)
+int MapRouting::getTerritoryCount() const {
+    return territoryCount;
+}
+
+bool MapRouting::isExact() const {
+    return territoryCount <= TABLE_LIMIT;
+}
+
+const vector<TerritoryId>& MapRouting::getLandmarks() const {
+    return *landmarks;
+}
+
+// Queries (MapRouting)
+// Without the tables: the shortest known route, through a landmark or down the tree of a landmark
+// from an ancestor of to; -1 when none is known
+int MapRouting::getDistance(TerritoryId from, TerritoryId to) const {
+    if (from < 0 || from >= territoryCount || to < 0 || to >= territoryCount) return -1;
+    size_t n = territoryCount;
+    if (isExact()) {
+        uint16_t distance = (*distances)[from * n + to];
+        return (distance == UNREACHABLE) ? -1 : distance;
+    }
+    if (from == to) return 0;
+
+    int best = -1;
+    for (size_t l = 0; l < landmarks->size(); l++) {
+        int toL = (*toLandmark)[l * n + from];
+        int fromL = (*fromLandmark)[l * n + to];
+        if (toL >= 0 && fromL >= 0 && (best < 0 || toL + fromL < best)) {
+            best = toL + fromL;
+        }
+        int ancestor = (*treeIndex)[l * n + from];
+        int index = (*treeIndex)[l * n + to];
+        if (ancestor >= 0 && index > ancestor && index < ancestor + (*subtreeSizes)[l * n + from]) {
+            int down = fromL - (*fromLandmark)[l * n + from];
+            if (best < 0 || down < best) best = down;
+        }
+    }
+    return best;
+}
+
+// Without the tables, from the triangle inequality at every landmark L:
+// d(from, to) >= d(L, to) - d(L, from) and d(from, to) >= d(from, L) - d(to, L).
+// -1 when to is known to be unreachable (a landmark reaches from but not to)
+int MapRouting::getDistanceLowerBound(TerritoryId from, TerritoryId to) const {
+    if (isExact() || from < 0 || from >= territoryCount || to < 0 || to >= territoryCount) {
+        return getDistance(from, to);
+    }
+    size_t n = territoryCount;
+    int bound = 0;
+    for (size_t l = 0; l < landmarks->size(); l++) {
+        int lFrom = (*fromLandmark)[l * n + from];
+        int lTo = (*fromLandmark)[l * n + to];
+        if (lFrom >= 0 && lTo < 0) return -1;
+        if (lFrom >= 0) bound = max(bound, lTo - lFrom);
+        int fromL = (*toLandmark)[l * n + from];
+        int toL = (*toLandmark)[l * n + to];
+        if (fromL >= 0 && toL >= 0) bound = max(bound, fromL - toL);
+    }
+    return bound;
+}
+
+// Without the tables: the neighbor with the shortest known route. The next step of the best known
+// route from from (toward its landmark, or down the tree) is one, so every hop shortens the route
+TerritoryId MapRouting::getNextHop(TerritoryId from, TerritoryId to) const {
+    if (from == to || getDistance(from, to) < 0) return NO_TERRITORY;
+    if (isExact()) {
+        return (*nextHops)[static_cast<size_t>(from) * territoryCount + to];
+    }
+    if (topology->areAdjacent(from, to)) return to;
+
+    TerritoryId best = NO_TERRITORY;
+    int bestDistance = INT_MAX;
+    for (TerritoryId neighbor : topology->getNeighbors(from)) {
+        int distance = getDistance(neighbor, to);
+        if (distance >= 0 && distance < bestDistance) {
+            best = neighbor;
+            bestDistance = distance;
+        }
+    }
+    return best;
+}
+
+vector<TerritoryId> MapRouting::getPath(TerritoryId from, TerritoryId to) const {
+    vector<TerritoryId> path;
+    int distance = getDistance(from, to);
+    if (distance < 0) return path;
+    path.push_back(from);
+    while (from != to && static_cast<int>(path.size()) <= distance) {
+        from = getNextHop(from, to);
+        path.push_back(from);
+    }
+    return path;
+}
+
+// ==================== Continent Implementation ====================
+
+// Constructors(Continent)
+Continent::Continent() {
+    name = new string("");
+    bonusArmies = new int(0);
+    territories = new vector<Territory*>();
+    id = NO_CONTINENT;
+    map = nullptr;
+    inArena = false;
+}
+
+Continent::Continent(const string& continentName, int bonus) {
+    name = new string(continentName);
+    bonusArmies = new int(bonus);
+    territories = new vector<Territory*>();
+    id = NO_CONTINENT;
+    map = nullptr;
+    inArena = false;
+}
+
+// The copy is standalone: setName must not rename other in its map
+Continent::Continent(const Continent& other) {
+    name = new string(*other.name);
+    bonusArmies = new int(*other.bonusArmies);
+    territories = new vector<Territory*>(*other.territories);
+    id = NO_CONTINENT;
+    map = nullptr;
+    inArena = false;
+}
+
+// Arena constructor, used by Map::createContinent and Map::copyElements
+Continent::Continent(const string& continentName, int bonus, MapArena* arena) {
+    name = arena->create<string>(continentName);
+    bonusArmies = arena->create<int>(bonus);
+    territories = arena->create<vector<Territory*>>();
+    id = NO_CONTINENT;
+    map = nullptr;
+    inArena = true;
+}
+
+// Destructor(Continent)
+Continent::~Continent() {
+    if (inArena) {
+        // the arena frees the storage itself
+        name->~string();
+        territories->~vector();
+    } else {
+        delete name;
+        delete bonusArmies;
+        delete territories;
+    }
+    name = nullptr;
+    bonusArmies = nullptr;
+    territories = nullptr;
+}
+
+// Assignment operator (Continent)
+Continent& Continent::operator=(const Continent& other) {
+    if (this != &other) {
+        // Assigned in place (the fields may live in a map arena); a continent of a map keeps
+        // its place in it (its own id, and its name in the name table)
+        setName(*other.name);
+        *bonusArmies = *other.bonusArmies;
+        *territories = *other.territories;
+        if (map != nullptr) {
+            map->invalidateValidation();   // the continent has new members
+            map->invalidateOwnership();
+        }
+    }
+    return *this;
+}
+
+// Stream inserion operator (Continent)
+ostream& operator<<(ostream& os, const Continent& continent) {
+    os << "Continent: " << *continent.name 
+       << ", Bonus: " << *continent.bonusArmies
+       << ", Territories: " << continent.territories->size();
+    return os;
+}
+
+// Getters (Continent)
+const string& Continent::getName() const{
+    return *name;
+}
+int Continent::getBonusArmies() const{
+    return *bonusArmies;
+}
+vector<Territory*>* Continent::getTerritories() const{
+    return territories;
+}
+ContinentId Continent::getId() const{
+    return id;
+}
+
+// Setters (Continent)
+void Continent::setName(const string& continentName){
+    *name = continentName;
+    if (map != nullptr) {
+        map->continentNames->rename(id, continentName);
+    }
+}
+void Continent::setBonusArmies(int bonus){
+    *bonusArmies = bonus;
+}
+
+// Continent operations
+void Continent::addTerritory(Territory* territory){
+    if (territory != nullptr) {
+        territories->push_back(territory);
+        territory->setContinent(this); 
+        if (map != nullptr) {
+            map->invalidateValidation();
+        }
+    }
+}
+
+// Removes one listing of territory; the territory is left without a continent if this was its continent
+void Continent::removeTerritory(Territory* territory){
+    auto listed = find(territories->begin(), territories->end(), territory);
+    if (listed == territories->end()) return;
+    territories->erase(listed);
+    if (territory->getContinent() == this) {
+        territory->setContinent(nullptr);
+    }
+    if (map != nullptr) {
+        map->invalidateValidation();
+    }
+}
+
+// Check if the continent is a connected subgraph (for areContinentsConnected)
+bool Continent::isContinentConnected() const{
+    if (territories->empty()) return true; // An empty continent is considered connected
+    if (territories->size() == 1) return true; // A single territory is considered connected
+
+    // Use Breadth-First Search (BFS) to check connectivity
+
+    unordered_set<const Territory*> members(territories->begin(), territories->end()); // O(1) membership test per edge
+    set<Territory*> visited; // To track visited territories
+    queue<Territory*> IsConnectedQueue; // BFS queue to process territories
+
+    IsConnectedQueue.push(territories->at(0)); // Start BFS from the first territory
+    visited.insert(territories->at(0)); // Mark the starting territory as visited
+
+    while (!IsConnectedQueue.empty()) {
+        Territory* current = IsConnectedQueue.front();
+        IsConnectedQueue.pop();
+
+        for (Territory* adjacent : current->getAdjacentTerritories()) {
+            // Check if adjacent is part of the continent
+            bool isInContinent = members.count(adjacent) > 0;
+
+            // If adjacent is in continent and not visited yet
+            // isInContinent is false (means the territory is not in the continent), then not add the adjacent territory to the set (visited).
+            if (isInContinent && visited.count(adjacent) == 0) {
+                visited.insert(adjacent);
+                IsConnectedQueue.push(adjacent);
+            }
+        }
+    }
+    
+    // Check if the number of visited territories is equal to the total number of territories
+    // If so, the continent is connected
+    // If not, it is disconnected
+    return visited.size() == territories->size();
+}
+    
+// ==================== Map Implementation ====================
+
+// Constructors (Map)
+Map::Map(){
+    territories = new vector<Territory*>();
+    continents = new vector<Continent*>();
+    territoryNames = new NameTable();
+    continentNames = new NameTable();
+    info = new MapInfo();
+    topology = nullptr;
+    neighborTerritories = new vector<Territory*>();
+    pendingEdges = new vector<pair<TerritoryId, TerritoryId>>();
+    removedEdges = new vector<pair<TerritoryId, TerritoryId>>();
+    topologyDirty = true;
+    cachedValidity = -1;
+    ownedPerContinent = new unordered_map<const Player*, vector<int>>();
+    continentSizes = new vector<int>();
+    ownershipDirty = true;
+    positions = new vector<MapPoint>();
+    arena = new MapArena();
+    state = new TerritoryState();
+    fileIndex = new vector<int>();
+}
+Map::Map(const Map& other){
+    territories = new vector<Territory*>();
+    continents = new vector<Continent*>();
+    territoryNames = new NameTable(*other.territoryNames);
+    continentNames = new NameTable(*other.continentNames);
+    info = new MapInfo(*other.info);
+    neighborTerritories = new vector<Territory*>();
+    pendingEdges = new vector<pair<TerritoryId, TerritoryId>>();
+    removedEdges = new vector<pair<TerritoryId, TerritoryId>>();
+    topologyDirty = true;
+    ownedPerContinent = new unordered_map<const Player*, vector<int>>();
+    continentSizes = new vector<int>();
+    ownershipDirty = true;
+    positions = new vector<MapPoint>(*other.positions);
+    arena = new MapArena();
+    state = new TerritoryState();
+    fileIndex = new vector<int>(*other.fileIndex);
+    copyElements(other);
+}
+
+//Destructor (Map)
+Map::~Map(){
+    destroyElements();
+    delete territories;
+    delete continents;
+    delete arena;
+    delete state;
+
+    delete territoryNames;
+    delete continentNames;
+    delete info;
+    delete neighborTerritories;
+    delete ownedPerContinent;
+    delete continentSizes;
+    delete positions;
+    delete fileIndex;
+    delete pendingEdges;
+    delete removedEdges;
+    
+    territories = nullptr;
+    territoryNames = nullptr;
+    continentNames = nullptr;
+    info = nullptr;
+    pendingEdges = nullptr;
+    removedEdges = nullptr;
+    continents = nullptr;
+    neighborTerritories = nullptr;
+    ownedPerContinent = nullptr;
+    continentSizes = nullptr;
+    positions = nullptr;
+    fileIndex = nullptr;
+    arena = nullptr;
+    state = nullptr;
+}
+
+// Assignment operator (Map)
+Map& Map::operator=(const Map& other){
+    if (this != &other) {
+
+            // Clean up existing data of (territories & continents)
+            destroyElements();
+
+            *territoryNames = *other.territoryNames;
+            *continentNames = *other.continentNames;
+            *info = *other.info;
+            *positions = *other.positions;
+            *fileIndex = *other.fileIndex;
+            pendingEdges->clear();
+            removedEdges->clear();
+            invalidateOwnership();
+            copyElements(other);
+        }
+        return *this;
+}
+
+// Deep copies the territories and continents of other into this (empty) map.
+// Continent members and territory continents are re-pointed at the copies, and the compiled
+// topology is shared: a copy costs one pass over the territories and no adjacency rebuild
+void Map::copyElements(const Map& other){
+    isTerritoryIsContinent = other.isTerritoryIsContinent;
+    *state = *other.state;
+
+    territories->reserve(other.territories->size());
+    for (Territory* territory : *other.territories) {
+        Territory* copy = arena->create<Territory>(*territory->name, arena);
+        copy->stateInMap = true;    // owner and armies were copied with the state
+        copy->continent = territory->continent;
+        copy->id = territory->id;
+        copy->map = this;
+        if (territory->adjacentTerritories != nullptr) {
+            copy->adjacentTerritories = new vector<Territory*>(*territory->adjacentTerritories);
+        }
+        territories->push_back(copy);
+    }
+    continents->reserve(other.continents->size());
+    for (Continent* continent : *other.continents) {
+        Continent* copy = arena->create<Continent>(*continent->name, *continent->bonusArmies, arena);
+        *copy->territories = *continent->territories;
+        copy->id = continent->id;
+        copy->map = this;
+        for (Territory*& member : *copy->territories) {
+            if (member->map == &other) member = (*territories)[member->id];
+        }
+        continents->push_back(copy);
+    }
+    for (Territory* territory : *territories) {
+        if (territory->continent != nullptr && territory->continent->map == &other) {
+            territory->continent = (*continents)[territory->continent->id];
+        }
+    }
+
+    other.getTopology();  // compile pending edges of other first
+    topology = other.topology;
+    spatialIndex = other.spatialIndex;
+    analysis = other.analysis;
+    routing = other.routing;
+    layoutNeighborTerritories();
+    topologyDirty = false;
+    cachedValidity = other.cachedValidity;
+}
+
+// Destroys every territory and continent and empties both lists.
+// Arena objects are only destructed, their storage goes back in one release of the arena blocks
+void Map::destroyElements(){
+    for (Territory* territory : *territories) {
+        if (territory->inArena) {
+            territory->~Territory();
+        } else {
+            delete territory;
+        }
+    }
+    territories->clear();
+
+    for (Continent* continent : *continents) {
+        if (continent->inArena) {
+            continent->~Continent();
+        } else {
+            delete continent;
+        }
+    }
+    continents->clear();
+
+    state->clear();
+    arena->release();
+}
+
+// Stream insertion operator (Map)
+ostream& operator<<(ostream& os, const Map& map){
+    os << "Map with " << map.territories->size() << " territories and " 
+       << map.continents->size() << " continents";
+    return os;
+}
+
+// Getters
+vector<Territory*>* Map::getTerritories() const{
+    return territories;
+}
+vector<Continent*>* Map::getContinents() const{
+    return continents;
+}
+
+bool Map::getisTerritoryIsContinent() const{
+    return isTerritoryIsContinent;
+}
+
+const MapInfo& Map::getInfo() const{
+    return *info;
+}
+
+const TerritoryState& Map::getState() const{
+    return *state;
+}
+
+// Position of the territory in its map file (stays with the territory when the map is renumbered)
+int Map::getFileIndex(TerritoryId id) const{
+    if (id < 0 || id >= static_cast<TerritoryId>(fileIndex->size())) {
+        return -1;
+    }
+    return (*fileIndex)[id];
+}
+
+// Setters
+void Map::setisTerritoryIsContinent(bool value){
+    isTerritoryIsContinent = value;
+    invalidateValidation();
+}
+
+void Map::setInfo(const MapInfo& newInfo){
+    *info = newInfo;
+}
+
+// Records a verdict computed elsewhere (e.g. stored in a binary image) so validate() can skip the checks
+void Map::setCachedValidity(bool valid){
+    cachedValidity = valid ? 1 : 0;
+}
+
+// Map operations
+void Map::addTerritory(Territory* territory){
+    if (territory != nullptr) {
+            // From now on the owner and armies are read from the map state
+            state->addTerritory(territory->getOwner(), territory->getArmies());
+            territory->stateInMap = true;
+            territory->id = static_cast<TerritoryId>(territories->size());
+            territory->map = this;
+            territories->push_back(territory);
+            territoryNames->add(territory->getName());
+            positions->push_back(MapPoint());
+            fileIndex->push_back(territory->id);
+            spatialIndex.reset();
+            invalidateTopology();
+            invalidateOwnership();
+    }
+}
+void Map::addContinent(Continent* continent){
+    if (continent != nullptr) {
+        continent->id = static_cast<ContinentId>(continents->size());
+        continent->map = this;
+        continents->push_back(continent);
+        continentNames->add(continent->getName());
+        invalidateValidation();
+        invalidateOwnership();
+    }
+}
+Territory* Map::createTerritory(const string& territoryName){
+    Territory* territory = arena->create<Territory>(territoryName, arena);
+    addTerritory(territory);
+    return territory;
+}
+Continent* Map::createContinent(const string& continentName, int bonus){
+    Continent* continent = arena->create<Continent>(continentName, bonus, arena);
+    addContinent(continent);
+    return continent;
+}
+const MapArena* Map::getArena() const{
+    return arena;
+}
+// O(1) lookups through the interned name tables
+Territory* Map::getTerritory(string_view territoryName) const{
+    return getTerritory(findTerritoryId(territoryName));
+}
+Territory* Map::getTerritory(TerritoryId id) const{
+    if (id < 0 || id >= static_cast<TerritoryId>(territories->size())) {
+        return nullptr;
+    }
+    return (*territories)[id];
+}
+Continent* Map::getContinent(string_view continentName) const{
+    return getContinent(findContinentId(continentName));
+}
+Continent* Map::getContinent(ContinentId id) const{
+    if (id < 0 || id >= static_cast<ContinentId>(continents->size())) {
+        return nullptr;
+    }
+    return (*continents)[id];
+}
+TerritoryId Map::findTerritoryId(string_view territoryName) const{
+    return territoryNames->find(territoryName);
+}
+ContinentId Map::findContinentId(string_view continentName) const{
+    return continentNames->find(continentName);
+}
+string_view Map::getTerritoryName(TerritoryId id) const{
+    return territoryNames->getName(id);
+}
+string_view Map::getContinentName(ContinentId id) const{
+    return continentNames->getName(id);
+}
+
+// Topology operations
+// Records a directed edge between two territories of this map, compiled on next use
+void Map::addAdjacency(TerritoryId from, TerritoryId to){
+    pendingEdges->emplace_back(from, to);
+    invalidateTopology();
+}
+
+// Removes the directed edge from -> to: pending and standalone edges are dropped right away,
+// an edge of the compiled topology is left out of the next compilation
+void Map::removeAdjacency(TerritoryId from, TerritoryId to){
+    pair<TerritoryId, TerritoryId> edge(from, to);
+    pendingEdges->erase(remove(pendingEdges->begin(), pendingEdges->end(), edge), pendingEdges->end());
+
+    Territory* source = getTerritory(from);
+    Territory* target = getTerritory(to);
+    if (source != nullptr && source->adjacentTerritories != nullptr) {
+        vector<Territory*>& own = *source->adjacentTerritories;
+        own.erase(remove(own.begin(), own.end(), target), own.end());
+    }
+    if (topology != nullptr && from < topology->getTerritoryCount() && to < topology->getTerritoryCount()
+        && topology->areAdjacent(from, to)) {
+        removedEdges->push_back(edge);
+    }
+    invalidateTopology();
+}
+
+void Map::reserveAdjacencies(int count){
+    pendingEdges->reserve(count);
+}
+
+// Room for count territories in every per-territory table, so a loader adds them without regrowing
+void Map::reserveTerritories(int count){
+    territories->reserve(count);
+    territoryNames->reserve(count);
+    positions->reserve(count);
+    fileIndex->reserve(count);
+}
+
+// Returns the compiled adjacency of the map, recompiling it first if territories or edges were added
+const MapTopology* Map::getTopology() const{
+    if (topologyDirty) {
+        compileTopology();
+    }
+    return topology.get();
+}
+
+span<Territory* const> Map::getNeighbors(TerritoryId id) const{
+    const MapTopology* compiled = getTopology();
+    if (id < 0 || id >= compiled->getTerritoryCount()) {
+        return {};
+    }
+    return span<Territory* const>(neighborTerritories->data() + compiled->getRowStart(id), compiled->getDegree(id));
+}
+
+void Map::invalidateTopology(){
+    topologyDirty = true;
+    invalidateValidation();
+}
+
+void Map::invalidateValidation(){
+    cachedValidity = -1;
+    analysis.reset();
+    routing.reset();
+}
+
+// Chokepoints, borders and statistics of the map, computed in O(V + E) after each structural edit
+const MapAnalysis* Map::getAnalysis() const{
+    if (analysis == nullptr) {
+        analysis = make_shared<const MapAnalysis>(*this);
+    }
+    return analysis.get();
+}
+
+// Distances and next hops between territories, built after each change of the edges
+const MapRouting* Map::getRouting() const{
+    if (routing == nullptr) {
+        getTopology();  // compile pending edges first
+        routing = make_shared<const MapRouting>(topology);
+    }
+    return routing.get();
+}
+
+// Permutation of the territory ids for a numbering: order[newId] is the current id of the territory
+// that gets newId. Each connected piece is walked in turn, starting with the piece of the smallest id,
+// so the neighbors of a territory end up a few ids away from it
+// Reverse Cuthill-McKee starts every walk from a peripheral territory of its piece (found by repeated
+// searches from the farthest, least connected territory) and visits the neighbors by increasing degree
+vector<TerritoryId> Map::computeTerritoryOrder(TerritoryOrder numbering) const{
+    const MapTopology* graph = getTopology();
+    int count = static_cast<int>(territories->size());
+    vector<TerritoryId> order;
+    order.reserve(count);
+    if (numbering == TerritoryOrder::File) {
+        for (TerritoryId id = 0; id < count; id++) order.push_back(id);
+        return order;
+    }
+
+    bool byDegree = (numbering == TerritoryOrder::ReverseCuthillMcKee);
+    auto degree = [graph](TerritoryId id) { return graph->getNeighbors(id).size(); };
+    vector<bool> placed(count, false);
+
+    // Least connected territory of the last level of a search from start, among the territories not placed yet
+    vector<int> seenBy(count, 0);
+    vector<TerritoryId> queue;
+    int search = 0;
+    auto farthest = [&](TerritoryId start, int& depth) {
+        search++;
+        queue.assign(1, start);
+        seenBy[start] = search;
+        size_t levelStart = 0;
+        depth = 0;
+        while (true) {
+            size_t levelEnd = queue.size();
+            for (size_t i = levelStart; i < levelEnd; i++) {
+                for (TerritoryId neighbor : graph->getNeighbors(queue[i])) {
+                    if (!placed[neighbor] && seenBy[neighbor] != search) {
+                        seenBy[neighbor] = search;
+                        queue.push_back(neighbor);
+                    }
+                }
+            }
+            if (queue.size() == levelEnd) break;
+            levelStart = levelEnd;
+            depth++;
+        }
+        TerritoryId best = queue[levelStart];
+        for (size_t i = levelStart + 1; i < queue.size(); i++) {
+            if (degree(queue[i]) < degree(best)) best = queue[i];
+        }
+        return best;
+    };
+
+    for (TerritoryId seed = 0; seed < count; seed++) {
+        if (placed[seed]) continue;
+
+        TerritoryId start = seed;
+        if (byDegree) {
+            int depth = 0;
+            TerritoryId candidate = farthest(start, depth);
+            for (int round = 0; round < 8; round++) {
+                int candidateDepth = 0;
+                TerritoryId next = farthest(candidate, candidateDepth);
+                if (candidateDepth <= depth) break;
+                start = candidate;
+                depth = candidateDepth;
+                candidate = next;
+            }
+        }
+
+        size_t head = order.size();
+        order.push_back(start);
+        placed[start] = true;
+        while (head < order.size()) {
+            TerritoryId id = order[head++];
+            size_t firstNew = order.size();
+            for (TerritoryId neighbor : graph->getNeighbors(id)) {
+                if (!placed[neighbor]) {
+                    placed[neighbor] = true;
+                    order.push_back(neighbor);
+                }
+            }
+            if (byDegree) {
+                stable_sort(order.begin() + firstNew, order.end(),
+                            [&](TerritoryId a, TerritoryId b) { return degree(a) < degree(b); });
+            }
+        }
+    }
+
+    if (byDegree) {
+        reverse(order.begin(), order.end());
+    }
+    return order;
+}
+
+// Gives territory order[newId] the id newId. The territory objects, their names, positions, owners,
+// armies and file indices move with them, and the compiled adjacency is rebuilt with the new ids
+// Only ids change: continents, the validity verdict and every Territory pointer stay valid
+void Map::renumberTerritories(const vector<TerritoryId>& order){
+    const MapTopology* graph = getTopology();
+    int count = static_cast<int>(territories->size());
+    if (static_cast<int>(order.size()) != count) {
+        throw invalid_argument("territory order does not cover the map");
+    }
+    vector<TerritoryId> newId(count, -1);
+    for (TerritoryId id = 0; id < count; id++) {
+        if (order[id] < 0 || order[id] >= count || newId[order[id]] != -1) {
+            throw invalid_argument("territory order is not a permutation");
+        }
+        newId[order[id]] = id;
+    }
+
+    vector<pair<TerritoryId, TerritoryId>> edges;
+    edges.reserve(graph->getEdgeCount());
+    for (TerritoryId id = 0; id < count; id++) {
+        for (TerritoryId neighbor : graph->getNeighbors(id)) {
+            edges.emplace_back(newId[id], newId[neighbor]);
+        }
+    }
+
+    vector<Territory*> renumbered(count);
+    vector<MapPoint> movedPositions(count);
+    vector<int> movedFileIndex(count);
+    NameTable* names = new NameTable();
+    TerritoryState* movedState = new TerritoryState();
+    names->reserve(count);
+    for (TerritoryId id = 0; id < count; id++) {
+        TerritoryId old = order[id];
+        renumbered[id] = (*territories)[old];
+        movedPositions[id] = (*positions)[old];
+        movedFileIndex[id] = (*fileIndex)[old];
+        names->add(territoryNames->getName(old));
+        movedState->addTerritory(state->getOwner(old), state->getArmies(old));
+    }
+    for (TerritoryId id = 0; id < count; id++) {
+        renumbered[id]->id = id;
+    }
+
+    *territories = std::move(renumbered);
+    *positions = std::move(movedPositions);
+    *fileIndex = std::move(movedFileIndex);
+    delete territoryNames;
+    territoryNames = names;
+    delete state;
+    state = movedState;
+
+    topology = make_shared<const MapTopology>(count, edges);
+    layoutNeighborTerritories();
+    topologyDirty = false;
+    spatialIndex.reset();
+    routing.reset();
+    invalidateOwnership();
+}
+
+// Position of a territory, (0, 0) for unknown ids
+MapPoint Map::getTerritoryPosition(TerritoryId id) const{
+    if (id < 0 || id >= static_cast<TerritoryId>(positions->size())) {
+        return MapPoint();
+    }
+    return (*positions)[id];
+}
+
+void Map::setTerritoryPosition(TerritoryId id, MapPoint position){
+    if (id >= 0 && id < static_cast<TerritoryId>(positions->size())) {
+        (*positions)[id] = position;
+        spatialIndex.reset();
+    }
+}
+
+// k-d tree over the territory positions, built on first use and shared with copies of the map
+const SpatialIndex* Map::getSpatialIndex() const{
+    if (spatialIndex == nullptr) {
+        spatialIndex = make_shared<const SpatialIndex>(*positions);
+    }
+    return spatialIndex.get();
+}
+
+// Hit-testing: a point picked on the map image selects the territory drawn closest to it
+Territory* Map::findTerritoryAt(int x, int y) const{
+    TerritoryId id = getSpatialIndex()->findNearest(x, y);
+    return (id == NO_TERRITORY) ? nullptr : (*territories)[id];
+}
+
+// Also drops the analysis: its continent borders depend on the same memberships
+void Map::invalidateOwnership(){
+    ownershipDirty = true;
+    analysis.reset();
+}
+
+// Recounts the owned territories of every player in every continent, O(#territories)
+void Map::countOwnership() const{
+    ownedPerContinent->clear();
+    continentSizes->assign(continents->size(), 0);
+    for (Territory* territory : *territories) {
+        Continent* continent = territory->getContinent();
+        if (continent == nullptr || continent->map != this) continue;
+        (*continentSizes)[continent->id]++;
+        if (territory->getOwner() != nullptr) {
+            vector<int>& owned = (*ownedPerContinent)[territory->getOwner()];
+            owned.resize(continents->size(), 0);
+            owned[continent->id]++;
+        }
+    }
+    ownershipDirty = false;
+}
+
+// Moves one territory between two players' counters (called by Territory::setOwner)
+void Map::updateOwnership(const Territory* territory, const Player* oldOwner, const Player* newOwner){
+    Continent* continent = territory->getContinent();
+    if (ownershipDirty || continent == nullptr || continent->map != this) return;
+    if (oldOwner != nullptr) {
+        (*ownedPerContinent)[oldOwner][continent->id]--;
+    }
+    if (newOwner != nullptr) {
+        vector<int>& owned = (*ownedPerContinent)[newOwner];
+        owned.resize(continents->size(), 0);
+        owned[continent->id]++;
+    }
+}
+
+int Map::getOwnedTerritoryCount(const Player* player, ContinentId continent) const{
+    if (ownershipDirty) {
+        countOwnership();
+    }
+    auto owned = ownedPerContinent->find(player);
+    if (owned == ownedPerContinent->end() || continent < 0 || continent >= static_cast<ContinentId>(owned->second.size())) {
+        return 0;
+    }
+    return owned->second[continent];
+}
+
+// A player owns a continent when they own every territory in it
+// (territories listed by several continents only count for their own continent)
+bool Map::ownsContinent(const Player* player, ContinentId continent) const{
+    if (continent < 0 || continent >= static_cast<ContinentId>(continents->size())) {
+        return false;
+    }
+    int owned = getOwnedTerritoryCount(player, continent);
+    return owned == (*continentSizes)[continent];
+}
+
+// Sum of the bonuses of every continent the player owns, O(#continents)
+int Map::getContinentBonus(const Player* player) const{
+    int bonus = 0;
+    for (Continent* continent : *continents) {
+        if (ownsContinent(player, continent->id)) {
+            bonus += continent->getBonusArmies();
+        }
+    }
+    return bonus;
+}
+
+// Calls visit(id) for every bit set in words, by increasing id
+template <typename Visit>
+static void forEachBit(span<const uint64_t> words, Visit visit) {
+    for (size_t w = 0; w < words.size(); w++) {
+        uint64_t word = words[w];
+        while (word != 0) {
+            visit(static_cast<TerritoryId>(w * 64 + countr_zero(word)));
+            word &= word - 1;
+        }
+    }
+}
+
+// Adjacency row ANDNOT the player's ownership bitset when the map has the bit matrix,
+// otherwise a walk of the CSR row comparing owners
+vector<TerritoryId> Map::findEnemyNeighbors(const Player* player, TerritoryId source) const{
+    vector<TerritoryId> enemies;
+    const MapTopology* graph = getTopology();
+    if (source < 0 || source >= graph->getTerritoryCount()) {
+        return enemies;
+    }
+    if (!graph->hasAdjacencyBits()) {
+        for (TerritoryId neighbor : graph->getNeighbors(source)) {
+            if (state->getOwner(neighbor) != player) enemies.push_back(neighbor);
+        }
+        return enemies;
+    }
+
+    span<const uint64_t> row = graph->getAdjacencyRow(source);
+    span<const uint64_t> owned = state->getOwnedBits(player);    // empty: the player owns nothing here
+    vector<uint64_t> targets(row.begin(), row.end());
+    for (size_t w = 0; w < owned.size(); w++) {
+        targets[w] &= ~owned[w];
+    }
+    forEachBit(targets, [&](TerritoryId id) { enemies.push_back(id); });
+    return enemies;
+}
+
+// Union of the adjacency rows of every owned territory, ANDNOT the owned set: O(owned * n / 64)
+// word operations on small maps; larger maps walk the CSR rows of the owned territories instead
+vector<TerritoryId> Map::findEnemyFrontier(const Player* player) const{
+    vector<TerritoryId> enemies;
+    const MapTopology* graph = getTopology();
+    span<const uint64_t> owned = state->getOwnedBits(player);
+    if (owned.empty()) {
+        return enemies;
+    }
+
+    if (graph->hasAdjacencyBits()) {
+        vector<uint64_t> reached(owned.size(), 0);
+        forEachBit(owned, [&](TerritoryId id) {
+            span<const uint64_t> row = graph->getAdjacencyRow(id);
+            for (size_t w = 0; w < row.size(); w++) reached[w] |= row[w];
+        });
+        for (size_t w = 0; w < owned.size(); w++) {
+            reached[w] &= ~owned[w];
+        }
+        forEachBit(reached, [&](TerritoryId id) { enemies.push_back(id); });
+        return enemies;
+    }
+
+    vector<uint64_t> reached(owned.begin(), owned.end());   // owned territories count as already seen
+    forEachBit(owned, [&](TerritoryId id) {
+        for (TerritoryId neighbor : graph->getNeighbors(id)) {
+            uint64_t bit = uint64_t(1) << (neighbor % 64);
+            if ((reached[neighbor / 64] & bit) == 0) {
+                reached[neighbor / 64] |= bit;
+                enemies.push_back(neighbor);
+            }
+        }
+    });
+    sort(enemies.begin(), enemies.end());
+    return enemies;
+}
+
+// Installs an already compiled topology (e.g. from a binary image) in place of every edge
+void Map::setTopology(MapTopology* compiled){
+    topology.reset(compiled);
+    pendingEdges->clear();
+    removedEdges->clear();
+    for (Territory* territory : *territories) {
+        delete territory->adjacentTerritories;
+        territory->adjacentTerritories = nullptr;
+    }
+    layoutNeighborTerritories();
+    topologyDirty = false;
+    invalidateValidation();
+}
+
+// Lays out the neighbor pointers in CSR order so getAdjacentTerritories() is a plain view
+void Map::layoutNeighborTerritories() const{
+    neighborTerritories->clear();
+    neighborTerritories->reserve(topology->getEdgeCount());
+    for (TerritoryId id = 0; id < topology->getTerritoryCount(); id++) {
+        for (TerritoryId neighbor : topology->getNeighbors(id)) {
+            neighborTerritories->push_back((*territories)[neighbor]);
+        }
+    }
+}
+
+// Merges the previous topology, the edges recorded with addAdjacency and the pending edges of
+// every territory into a new CSR graph
+// Pending edges to territories outside this map stay on the territory until they join the map
+void Map::compileTopology() const{
+    int count = static_cast<int>(territories->size());
+    vector<pair<TerritoryId, TerritoryId>> edges;
+    if (topology == nullptr) {
+        // First compilation (e.g. right after loading): the pending edges are the whole graph
+        edges.swap(*pendingEdges);
+    } else {
+        edges.reserve(topology->getEdgeCount() + pendingEdges->size());
+        edges.insert(edges.end(), pendingEdges->begin(), pendingEdges->end());
+        pendingEdges->clear();
+    }
+
+    // Removed edges are dropped from the old topology only: an edge added again after its removal is pending
+    sort(removedEdges->begin(), removedEdges->end());
+    for (TerritoryId id = 0; id < count; id++) {
+        if (topology != nullptr && id < topology->getTerritoryCount()) {
+            for (TerritoryId neighbor : topology->getNeighbors(id)) {
+                if (removedEdges->empty() || !binary_search(removedEdges->begin(), removedEdges->end(), make_pair(id, neighbor))) {
+                    edges.emplace_back(id, neighbor);
+                }
+            }
+        }
+
+        Territory* territory = (*territories)[id];
+        if (territory->adjacentTerritories == nullptr) continue;
+
+        vector<Territory*> external;
+        for (Territory* adjacent : *territory->adjacentTerritories) {
+            if (adjacent->map == this) {
+                edges.emplace_back(id, adjacent->id);
+            } else {
+                external.push_back(adjacent);
+            }
+        }
+        if (external.empty()) {
+            delete territory->adjacentTerritories;
+            territory->adjacentTerritories = nullptr;
+        } else {
+            *territory->adjacentTerritories = external;
+        }
+    }
+
+    removedEdges->clear();
+    topology = make_shared<const MapTopology>(count, edges);
+    layoutNeighborTerritories();
+    topologyDirty = false;
+}
+
+// Disjoint-set forest over territory ids (union by size, path halving)
+class TerritorySets {
+    private:
+        vector<TerritoryId> parent;
+        vector<int> size;
+
+    public:
+        explicit TerritorySets(int count) : parent(count), size(count, 1) {
+            for (int i = 0; i < count; i++) parent[i] = i;
+        }
+
+        TerritoryId find(TerritoryId id) {
+            while (parent[id] != id) {
+                parent[id] = parent[parent[id]];
+                id = parent[id];
+            }
+            return id;
+        }
+
+        void unite(TerritoryId a, TerritoryId b) {
+            a = find(a);
+            b = find(b);
+            if (a == b) return;
+            if (size[a] < size[b]) swap(a, b);
+            parent[b] = a;
+            size[a] += size[b];
+        }
+};
+
+// Same sets shared by several threads, without locks: a root is linked under a smaller root with
+// one compare-and-swap (retried when another thread moved it first), so parents only point to smaller
+// ids and no cycle can form. Finds halve their path with swaps that may fail harmlessly
+class ConcurrentTerritorySets {
+    private:
+        vector<atomic<TerritoryId>> parent;
+
+    public:
+        explicit ConcurrentTerritorySets(int count) : parent(count) {
+            for (int i = 0; i < count; i++) parent[i].store(i);
+        }
+
+        TerritoryId find(TerritoryId id) {
+            while (true) {
+                TerritoryId up = parent[id].load();
+                if (up == id) return id;
+                TerritoryId grand = parent[up].load();
+                if (grand != up) parent[id].compare_exchange_weak(up, grand);
+                id = grand;
+            }
+        }
+
+        void unite(TerritoryId a, TerritoryId b) {
+            while (true) {
+                a = find(a);
+                b = find(b);
+                if (a == b) return;
+                if (a < b) swap(a, b);
+                TerritoryId root = a;
+                if (parent[a].compare_exchange_strong(root, b)) return;
+            }
+        }
+};
+
+// Maps from this many territories validate their edges on every core
+static const int PARALLEL_VALIDATION_LIMIT = 1 << 16;
+
+// Groups ids by their set, groups come out ordered by their smallest id
+template <class Sets>
+static vector<vector<TerritoryId>> groupBySet(Sets& sets, const vector<TerritoryId>& ids) {
+    vector<vector<TerritoryId>> groups;
+    unordered_map<TerritoryId, size_t> groupOfRoot;
+    for (TerritoryId id : ids) {
+        auto inserted = groupOfRoot.try_emplace(sets.find(id), groups.size());
+        if (inserted.second) groups.emplace_back();
+        groups[inserted.first->second].push_back(id);
+    }
+    return groups;
+}
+
+// Unites the ends of every edge leaving the territories [begin, end): always in mapSets,
+// in continentSets when both ends have the same home continent
+template <class Sets>
+static void uniteEdges(const MapTopology& graph, const vector<ContinentId>& home, TerritoryId begin, TerritoryId end,
+                       Sets& mapSets, Sets& continentSets) {
+    for (TerritoryId id = begin; id < end; id++) {
+        for (TerritoryId adjacent : graph.getNeighbors(id)) {
+            mapSets.unite(id, adjacent);
+            if (home[id] != NO_CONTINENT && home[id] == home[adjacent]) {
+                continentSets.unite(id, adjacent);
+            }
+        }
+    }
+}
+
+// Components of the map and pieces of the split continents, read from the united sets
+template <class Sets>
+static void groupConnectivity(ValidationReport& report, const vector<ContinentId>& home, size_t continentCount,
+                              Sets& mapSets, Sets& continentSets) {
+    TerritoryId count = static_cast<TerritoryId>(home.size());
+    vector<TerritoryId> allIds(count);
+    for (TerritoryId id = 0; id < count; id++) allIds[id] = id;
+    report.components = groupBySet(mapSets, allIds);
+
+    // Continent members bucketed by home continent (counting sort keeps id order)
+    vector<int> memberStart(continentCount + 1, 0);
+    for (TerritoryId id = 0; id < count; id++) {
+        if (home[id] != NO_CONTINENT) memberStart[home[id] + 1]++;
+    }
+    for (size_t c = 0; c < continentCount; c++) memberStart[c + 1] += memberStart[c];
+    vector<TerritoryId> members(memberStart.back());
+    vector<int> cursor(memberStart.begin(), memberStart.end() - 1);
+    for (TerritoryId id = 0; id < count; id++) {
+        if (home[id] != NO_CONTINENT) members[cursor[home[id]]++] = id;
+    }
+    for (size_t c = 0; c < continentCount; c++) {
+        vector<TerritoryId> continentMembers(members.begin() + memberStart[c], members.begin() + memberStart[c + 1]);
+        vector<vector<TerritoryId>> pieces = groupBySet(continentSets, continentMembers);
+        if (pieces.size() > 1) {
+            report.continentPieces.emplace_back(static_cast<ContinentId>(c), std::move(pieces));
+        }
+    }
+}
+
+// Validation methods
+// Validate the map based on three criteria
+// 1) the map is a connected graph, 
+// 2) continents are connected subgraphs 
+// 3) each country belongs to one and only one continent. 
+// Prints nothing (it may run on a background thread): the warnings are on getValidationReport()
 bool Map::validate() const{
-    return isConnectedGraph() && areContinentsConnected() && isEachTerritoryInOneContinent();
+    // A verdict cached since the last edit (or read from a binary image) skips the checks
+    if (cachedValidity >= 0) {
+        return cachedValidity == 1;
+    }
+    bool valid = getValidationReport().isValid();
+    cachedValidity = valid ? 1 : 0;
+    return valid;
+}
+
+// Checks all three criteria in one O(V + E) sweep over the compiled topology:
+// each territory gets its home continent from the membership lists, then every edge is merged
+// into the map's union-find and, when both ends share a continent, into the continent union-find
+ValidationReport Map::getValidationReport() const{
+    const MapTopology* compiled = getTopology();
+    int count = compiled->getTerritoryCount();
+    ValidationReport report;
+    report.territoryNamedAsContinent = !getisTerritoryIsContinent();
+    if (count == 0) {
+        report.warnings.push_back("The map has no territories.");
+    } else if (count == 1) {
+        report.warnings.push_back("The map has only one territory.");
+    }
+
+    // 3) Membership: first continent that lists a territory is its home
+    vector<ContinentId> home(count, NO_CONTINENT);
+    vector<char> listedTwice(count, 0);
+    for (Continent* continent : *continents) {
+        for (Territory* territory : *continent->getTerritories()) {
+            TerritoryId id = territory->getId();
+            if (territory->getMap() != this || id < 0 || id >= count) continue;
+            if (home[id] == NO_CONTINENT) {
+                home[id] = continent->getId();
+            } else if (!listedTwice[id]) {
+                listedTwice[id] = 1;
+                report.duplicates.push_back(id);
+            }
+        }
+    }
+    for (TerritoryId id = 0; id < count; id++) {
+        if (home[id] == NO_CONTINENT) report.orphans.push_back(id);
+    }
+
+    // 1) and 2) One pass over the edges, in blocks of territories on every core for big maps
+    int threadCount = max(1u, thread::hardware_concurrency());
+    if (count >= PARALLEL_VALIDATION_LIMIT && threadCount > 1) {
+        ConcurrentTerritorySets mapSets(count);
+        ConcurrentTerritorySets continentSets(count);
+        int blocks = 8 * threadCount;
+        runInParallel(blocks, threadCount, [&](int block) {
+            uniteEdges(*compiled, home, static_cast<TerritoryId>(static_cast<int64_t>(count) * block / blocks),
+                       static_cast<TerritoryId>(static_cast<int64_t>(count) * (block + 1) / blocks), mapSets, continentSets);
+        });
+        groupConnectivity(report, home, continents->size(), mapSets, continentSets);
+    } else {
+        TerritorySets mapSets(count);
+        TerritorySets continentSets(count);
+        uniteEdges(*compiled, home, 0, count, mapSets, continentSets);
+        groupConnectivity(report, home, continents->size(), mapSets, continentSets);
+    }
+    return report;
+}
+
+// 1)Check if the entire map is a connected graph
+bool Map::isConnectedGraph() const{
+    return getValidationReport().isConnected();
+}
+
+// 2) Check if each continent is a connected subgraph
+bool Map::areContinentsConnected() const{
+    return getValidationReport().areContinentsConnected();
+}
+
+// 3) Check that each territory belongs to exactly one continent
+// (and that no territory has the same name as a continent)
+bool Map::isEachTerritoryInOneContinent() const{
+    return getValidationReport().isEachTerritoryInOneContinent();
+}
+
+// distribute territories to players (for game setup - Ass2)
+void Map::distributeTerritories(vector<Player*>& players){
+    vector<Territory*> territories = *this->getTerritories();
+    if (territories.empty()){
+        cout << "No territories found in map." << endl;
+        return;
+    }
+
+    int numPlayers = players.size();
+    int i = 0;
+    for (auto* territory : territories){
+        Player* currentPlayer = players[i % numPlayers];
+        // Set ownership
+        territory->setOwner(currentPlayer);
+        // Add to the player's defend list
+        currentPlayer->addToDefend(territory);
+        i++;
+    }
+    cout << "Territories have been distributed to players." << endl;
+}
+
+
+// ==================== MapLoader Implementation ====================
+
+// Helper methods for parsing
+vector<string> MapLoader::split(const string& str, char delimiter) const {
+    vector<string> tokens;
+    string token;
+    istringstream tokenStream(str);
+    while (getline(tokenStream, token, delimiter)) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+string MapLoader::trim(const string& str) const {
+    size_t first = str.find_first_not_of(" \t\r\n");
+    if (first == string::npos) return "";
+    size_t last = str.find_last_not_of(" \t\r\n");
+    return str.substr(first, (last - first + 1));
+}
+
+
+// Constructors (mapLoader)
+MapLoader::MapLoader() {
+    fileName = new string("");
+    mode = MapLoadMode::Stream;
+    territoryOrder = TerritoryOrder::File;
+    useBinaryCache = false;
+    useBundledMaps = false;
+    threadCount = 0;
+    messages = &cout;
+}
+
+MapLoader::MapLoader(const string& file) {
+    fileName = new string(file);
+    mode = MapLoadMode::Stream;
+    territoryOrder = TerritoryOrder::File;
+    useBinaryCache = false;
+    useBundledMaps = false;
+    threadCount = 0;
+    messages = &cout;
+}
+
+MapLoader::MapLoader(const MapLoader& other) {
+    fileName = new string(*other.fileName);
+    mode = other.mode;
+    territoryOrder = other.territoryOrder;
+    useBinaryCache = other.useBinaryCache;
+    useBundledMaps = other.useBundledMaps;
+    threadCount = other.threadCount;
+    messages = other.messages;
+}
+
+//Destructor (MapLoader)
+MapLoader::~MapLoader() {
+    delete fileName;
+    fileName = nullptr;
+}
+
+//Assignment operator (MapLoader)
+MapLoader& MapLoader::operator=(const MapLoader& other) {
+    if (this != &other) {
+        delete fileName;
+        fileName = new string(*other.fileName);
+        mode = other.mode;
+        territoryOrder = other.territoryOrder;
+        useBinaryCache = other.useBinaryCache;
+        useBundledMaps = other.useBundledMaps;
+        threadCount = other.threadCount;
+        messages = other.messages;
+    }
+    return *this;
+}
+
+// Stream insertion operator (MapLoader)
+ostream& operator<<(ostream& os, const MapLoader& loader) {
+    os << "MapLoader for file: " << *loader.fileName;
+    return os;
+}
+
+// Getters (MapLoader)
+string MapLoader::getFileName() const{
+    return *fileName;
+}
+
+MapLoadMode MapLoader::getLoadMode() const{
+    return mode;
+}
+
+TerritoryOrder MapLoader::getTerritoryOrder() const{
+    return territoryOrder;
+}
+
+bool MapLoader::getUseBinaryCache() const{
+    return useBinaryCache;
+}
+
+bool MapLoader::getUseBundledMaps() const{
+    return useBundledMaps;
+}
+
+int MapLoader::getThreadCount() const{
+    return threadCount;
+}
+
+ostream* MapLoader::getMessageStream() const{
+    return messages;
+}
+
+// Setters (MapLoader)
+void MapLoader::setFileName(const string& file){
+    *fileName = file;
+}
+
+void MapLoader::setLoadMode(MapLoadMode newMode){
+    mode = newMode;
+}
+
+void MapLoader::setTerritoryOrder(TerritoryOrder order){
+    territoryOrder = order;
+}
+
+void MapLoader::setUseBinaryCache(bool enabled){
+    useBinaryCache = enabled;
+}
+
+void MapLoader::setUseBundledMaps(bool enabled){
+    useBundledMaps = enabled;
+}
+
+void MapLoader::setThreadCount(int count){
+    threadCount = max(0, count);
 }
 
-// 1)Check if the entire map is a connected graph
-bool Map::isConnectedGraph() const{
-    if (territories->empty()) {
-        cout<<"Warning: The map has no territories."<<endl;
-        return true; // An empty map is considered connected
+void MapLoader::setMessageStream(ostream* stream){
+    messages = (stream != nullptr) ? stream : &cout;
+}
+
+// Map loading operations
+Map* MapLoader::loadMap() const{
+    return loadMap(*fileName);
+}
+// The territories are renumbered after the parser (or the image) built the map, so binary
+// images always hold the file order and are shared by loaders with different numberings
+// (a variant keeps the numbering of its base, which was renumbered when it was loaded)
+Map* MapLoader::loadMap(const string& file) const{
+    Map* map = nullptr;
+    const string_view* bundled = useBundledMaps ? findBundledMap(file) : nullptr;
+    if (filesystem::path(file).extension() == WZPATCH_EXTENSION) {
+        return loadPatchedMap(file);
+    } else if (bundled != nullptr) {
+        map = loadBinaryImage(*bundled, file);
+    } else if (file.size() >= WZMAP_EXTENSION.size() && file.compare(file.size() - WZMAP_EXTENSION.size(), WZMAP_EXTENSION.size(), WZMAP_EXTENSION) == 0) {
+        map = loadBinaryMap(file);
+    } else if (useBinaryCache) {
+        map = loadMapCached(file);
+    } else {
+        map = parseMapFile(file);
+    }
+    if (map != nullptr && territoryOrder != TerritoryOrder::File) {
+        map->renumberTerritories(map->computeTerritoryOrder(territoryOrder));
+    }
+    return map;
+}
+
+// Text parser of the load mode
+Map* MapLoader::parseMapFile(const string& file) const{
+    switch (mode) {
+        case MapLoadMode::Parallel: return loadMapParallel(file);
+        case MapLoadMode::Mapped: return loadMapMapped(file);
+        default: return loadMapStream(file);
+    }
+}
+
+Map* MapLoader::loadMapStream(const string& file) const{
+    ifstream inputFile(file);
+    if (!inputFile.is_open()) {
+        *messages << "Error: Cannot open file " << file << endl;
+        return nullptr;
+    }
+    
+    Map* map = new Map();
+    string line;
+    string currentSection = "";
+    // For two-pass adjacency setup
+    std::map<std::string, std::vector<std::string>> adjacencyMap;
+    
+    try {
+        while (getline(inputFile, line)) {
+            line = trim(line);
+            // Skip empty lines and comments (starts with a semicolon (;))
+            if (line.empty() || line[0] == ';') continue;
+            
+            // Check for section headers
+            // E.g. [Map] , [Continents], [Territories]
+            else if (line[0] == '[' && line[line.length()-1] == ']') {
+                currentSection = line;
+                continue;
+            }
+
+            // Parse [Map] Section
+            else if (currentSection == "[Map]") {
+                MapInfo info;
+                vector<string> property = split(line, '=');
+                if (property.size() >= 2) info.set(property[0], property[1]);
+
+                // Print a header before printing the Map info
+                *messages << "Map Info:" << endl;
+
+                // Print all the lines in the [Map] section until a blank line is found
+                while (getline(inputFile, line)) {
+                    line = trim(line); // Trim whitespace
+
+                    // If encounter a blank line, stop processing the map section
+                    if (line.empty()) {
+                        break;
+                    }
+                    // Print the line to the console (or log it as needed)
+                    *messages << line << endl;
+                    property = split(line, '=');
+                    if (property.size() >= 2) info.set(property[0], property[1]);
+                }
+                map->setInfo(info);
+            }
+
+            // Parse [Continents] Section
+            else if (currentSection == "[Continents]") {
+                vector<string> tokens = split(line, '=');
+                if (tokens.size() >= 2) {
+                    string continentName = tokens[0];
+                    int bonus = stoi(tokens[1]); // stoi: converts string to int
+                    map->createContinent(continentName, bonus);  // Add the continent to the map
+                }
+            }
+            
+            // Parse [Territories] Section
+            else if (currentSection == "[Territories]") {
+                vector<string> tokens = split(line, ',');
+                if (tokens.size() >= 4) {
+                    string territoryName = tokens[0];
+                    int x = stoi(tokens[1]);  // Coordinates
+                    int y = stoi(tokens[2]);  // Coordinates
+                    string continentName = tokens[3];
+
+                    Territory* territory = map->createTerritory(territoryName);  // Add territory to the map
+                    Continent* continent = map->getContinent(continentName);
+
+                    if (continent != nullptr) {
+                        continent->addTerritory(territory);  // Add territory to its continent
+                    }
+
+                    map->setTerritoryPosition(territory->getId(), MapPoint{x, y});
+
+                    // Store adjacency info for second pass
+                    vector<string> adjacents;
+
+                    for (size_t i = 4; i < tokens.size(); i++) {
+                        if (map->findContinentId(tokens[i]) != NO_CONTINENT){
+                            map->setisTerritoryIsContinent(false);
+                        }
+                        // Add adjacent territory names to the list
+                        adjacents.push_back(tokens[i]);
+                    }
+                    // Map territory name to its list of adjacent territory names
+                    adjacencyMap[territoryName] = adjacents;
+                    
+                }
+            
+            } 
+        }
+        
+        inputFile.close();
+        
+        // Second pass: set up adjacencies
+        for (const auto& pair : adjacencyMap) {
+            // Get the territory object by name
+            Territory* territory = map->getTerritory(pair.first);
+
+            // Range-based for loop to iterate through each adjacent territory name
+            for (const string& adjName : pair.second) {
+                Territory* adjacent = map->getTerritory(adjName);
+                if (adjacent && adjacent != territory) {
+                    territory->addAdjacentTerritory(adjacent);
+                }
+            }
+        }
+
+        
+        return map;
+        
+    } catch (const exception& e) {
+        *messages << "Error parsing file " << file << ": " << e.what() << endl;
+        inputFile.close();
+        delete map;
+        return nullptr;
+    }
+}
+
+// Read-only view of a whole file: memory-mapped on POSIX systems, read into a buffer elsewhere
+class MappedFile {
+    private:
+        const char* data;
+        size_t length;
+        bool open;
+#ifdef _WIN32
+        string buffer;
+#endif
+
+    public:
+        MappedFile(const string& file) : data(nullptr), length(0), open(false) {
+#ifndef _WIN32
+            int fd = ::open(file.c_str(), O_RDONLY);
+            if (fd < 0) return;
+            struct stat info;
+            if (fstat(fd, &info) == 0) {
+                length = static_cast<size_t>(info.st_size);
+                open = true;
+                if (length > 0) {
+                    void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (mapped == MAP_FAILED) {
+                        open = false;
+                        length = 0;
+                    } else {
+                        data = static_cast<const char*>(mapped);
+                        madvise(mapped, length, MADV_SEQUENTIAL);
+                    }
+                }
+            }
+            ::close(fd);
+#else
+            ifstream input(file, ios::binary);
+            if (!input.is_open()) return;
+            buffer.assign(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+            data = buffer.data();
+            length = buffer.size();
+            open = true;
+#endif
+        }
+
+        ~MappedFile() {
+#ifndef _WIN32
+            if (data != nullptr) munmap(const_cast<char*>(data), length);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool isOpen() const { return open; }
+        string_view view() const { return string_view(data, length); }
+};
+
+// string_view helpers for the mapped loader (no allocation)
+static string_view trimView(string_view str) {
+    size_t first = str.find_first_not_of(" \t\r\n");
+    if (first == string_view::npos) return string_view();
+    size_t last = str.find_last_not_of(" \t\r\n");
+    return str.substr(first, last - first + 1);
+}
+
+// Splits off the next delimiter-separated field of rest (same fields as getline on the delimiter)
+static string_view nextField(string_view& rest, char delimiter) {
+    size_t end = rest.find(delimiter);
+    string_view field = rest.substr(0, end);
+    rest = (end == string_view::npos) ? string_view() : rest.substr(end + 1);
+    return field;
+}
+
+// Parses a whole field as an int, throws like stoi when the field is not a number
+static int parseInt(string_view field) {
+    field = trimView(field);
+    if (!field.empty() && field[0] == '+') field.remove_prefix(1);
+    int value = 0;
+    auto result = from_chars(field.data(), field.data() + field.size(), value);
+    if (result.ec != errc() || field.empty()) {
+        throw invalid_argument("invalid number '" + string(field) + "'");
+    }
+    return value;
+}
+
+enum MapSection { NONE, MAP_SECTION, CONTINENTS, TERRITORIES, OTHER };
+
+static MapSection sectionOf(string_view header) {
+    if (header == "[Map]") return MAP_SECTION;
+    if (header == "[Continents]") return CONTINENTS;
+    if (header == "[Territories]") return TERRITORIES;
+    return OTHER;
+}
+
+// Fields of a [Territories] line; the adjacency list is left unsplit
+struct TerritoryLine {
+    string_view name;
+    MapPoint position;
+    string_view continent;
+    string_view adjacency;
+};
+
+// False for a line with fewer than 4 fields (skipped), throws on a bad coordinate
+static bool parseTerritoryLine(string_view line, TerritoryLine& parsed) {
+    string_view rest = line;
+    parsed.name = nextField(rest, ',');
+    string_view xField = nextField(rest, ',');
+    string_view yField = nextField(rest, ',');
+    parsed.continent = nextField(rest, ',');
+    if (parsed.continent.data() == nullptr || (parsed.continent.empty() && rest.empty())) return false;
+
+    parsed.position = MapPoint{parseInt(xField), parseInt(yField)};  // Coordinates
+    parsed.adjacency = rest;
+    return true;
+}
+// Zero-copy loader: the file is mapped once and every token is a string_view into it
+// Adjacency names are kept as views in one flat array (CSR style) and resolved by interned id
+Map* MapLoader::loadMapMapped(const string& file) const{
+    MappedFile input(file);
+    if (!input.isOpen()) {
+        *messages << "Error: Cannot open file " << file << endl;
+        return nullptr;
+    }
+
+    MapSection section = NONE;
+    Map* map = new Map();
+    MapInfo info;
+
+    vector<string_view> adjacencyNames;     // adjacency tokens of every territory line, in file order
+    vector<int> adjacencyOffsets(1, 0);     // adjacency tokens of line i are [offsets[i], offsets[i+1])
+    vector<TerritoryId> lineTerritory;      // territory each line's adjacency belongs to
+
+    try {
+        string_view text = input.view();
+        while (!text.empty()) {
+            string_view line = trimView(nextField(text, '\n'));
+            // Skip empty lines and comments (starts with a semicolon (;))
+            if (line.empty() || line[0] == ';') continue;
+
+            // Check for section headers
+            if (line.front() == '[' && line.back() == ']') {
+                section = sectionOf(line);
+                continue;
+            }
+
+            if (section == MAP_SECTION) {
+                size_t equals = line.find('=');
+                if (equals != string_view::npos) {
+                    info.set(line.substr(0, equals), line.substr(equals + 1));
+                }
+            }
+            else if (section == CONTINENTS) {
+                string_view rest = line;
+                string_view continentName = nextField(rest, '=');
+                if (!rest.empty()) {
+                    int bonus = parseInt(nextField(rest, '='));
+                    map->createContinent(string(continentName), bonus);
+                }
+            }
+            else if (section == TERRITORIES) {
+                TerritoryLine parsed;
+                if (!parseTerritoryLine(line, parsed)) continue; // fewer than 4 fields
+
+                Territory* territory = map->createTerritory(string(parsed.name));
+                Continent* continent = map->getContinent(parsed.continent);
+                if (continent != nullptr) {
+                    continent->addTerritory(territory);
+                }
+                map->setTerritoryPosition(territory->getId(), parsed.position);
+
+                string_view rest = parsed.adjacency;
+                while (!rest.empty()) {
+                    string_view adjacentName = nextField(rest, ',');
+                    if (map->findContinentId(adjacentName) != NO_CONTINENT) {
+                        map->setisTerritoryIsContinent(false);
+                    }
+                    adjacencyNames.push_back(adjacentName);
+                }
+                lineTerritory.push_back(map->findTerritoryId(parsed.name));
+                adjacencyOffsets.push_back(static_cast<int>(adjacencyNames.size()));
+            }
+        }
+
+        // Second pass: resolve every adjacency view to an interned id
+        map->reserveAdjacencies(static_cast<int>(adjacencyNames.size()));
+        for (size_t lineIndex = 0; lineIndex < lineTerritory.size(); lineIndex++) {
+            TerritoryId from = lineTerritory[lineIndex];
+            for (int k = adjacencyOffsets[lineIndex]; k < adjacencyOffsets[lineIndex + 1]; k++) {
+                TerritoryId to = map->findTerritoryId(adjacencyNames[k]);
+                if (to != NO_TERRITORY && to != from) {
+                    map->addAdjacency(from, to);
+                }
+            }
+        }
+        map->setInfo(info);
+        return map;
+
+    } catch (const exception& e) {
+        *messages << "Error parsing file " << file << ": " << e.what() << endl;
+        delete map;
+        return nullptr;
+    }
+}
+
+// Files below this size per thread are not worth splitting
+static const size_t PARALLEL_BYTES_PER_THREAD = 1 << 20;
+
+// Splits text into at most count pieces of whole lines, of about the same size
+static vector<string_view> splitLines(string_view text, size_t count) {
+    vector<string_view> pieces;
+    size_t start = 0;
+    for (size_t i = 1; i <= count && start < text.size(); i++) {
+        size_t end = text.find('\n', max(start, text.size() / count * i));
+        end = (i == count || end == string_view::npos) ? text.size() : end + 1;
+        pieces.push_back(text.substr(start, end - start));
+        start = end;
+    }
+    return pieces;
+}
+
+// Section header line of a map file, by byte offset
+struct SectionHeader {
+    size_t begin;       // first byte of the header line
+    size_t end;         // first byte after it
+    MapSection section;
+};
+
+// Whole territory lines parsed by one worker of the parallel loader, then resolved by one worker
+struct TerritoryChunk {
+    string_view text;
+    ContinentId continentLimit = 0;     // continents defined above the chunk (the only ones its lines can name)
+    vector<TerritoryLine> lines;
+    vector<string_view> adjacencyNames;
+    vector<int> adjacencyOffsets;       // adjacency of line i: [adjacencyOffsets[i], adjacencyOffsets[i + 1])
+    bool continentAsNeighbor = false;
+    size_t errorOffset = string_view::npos;     // file offset of the first bad line
+    string error;
+
+    // Resolved rows: sorted ids without repeats or self-loops, CSR like the names
+    TerritoryId firstId = 0;
+    vector<TerritoryId> lineTerritory;
+    vector<TerritoryId> neighbors;
+    vector<int> neighborOffsets;
+    bool duplicateNames = false;        // a line names an earlier territory, rows are not one per territory
+};
+
+// Parallel version of the mapped loader, in five steps:
+// 1) the file is cut into chunks of whole lines, and the workers find the section headers of each
+// 2) the [Map] and [Continents] sections (small) are parsed in file order; each run of territory lines
+//    remembers how many continents were defined above it, as the mapped loader only sees those
+// 3) the workers parse the territory chunks and split their adjacency lists
+// 4) the territories are created in file order (the name table is not shared between threads)
+// 5) the workers resolve the adjacency names to ids and sort every row; rows that line up with the
+//    territories are copied straight into the CSR topology
+// Errors are reported for the first bad line in the file, as the mapped loader does
+Map* MapLoader::loadMapParallel(const string& file) const{
+    MappedFile input(file);
+    if (!input.isOpen()) {
+        *messages << "Error: Cannot open file " << file << endl;
+        return nullptr;
+    }
+    string_view text = input.view();
+    int workers = (threadCount > 0) ? threadCount : max(1u, thread::hardware_concurrency());
+    workers = static_cast<int>(min<size_t>(workers, text.size() / PARALLEL_BYTES_PER_THREAD + 1));
+
+    // 1) Section headers
+    vector<string_view> pieces = splitLines(text, 4 * workers);
+    vector<vector<SectionHeader>> pieceHeaders(pieces.size());
+    runInParallel(static_cast<int>(pieces.size()), workers, [&](int i) {
+        string_view rest = pieces[i];
+        while (!rest.empty()) {
+            size_t begin = rest.data() - text.data();
+            string_view line = trimView(nextField(rest, '\n'));
+            if (!line.empty() && line.front() == '[' && line.back() == ']') {
+                size_t end = rest.empty() ? pieces[i].data() + pieces[i].size() - text.data() : rest.data() - text.data();
+                pieceHeaders[i].push_back(SectionHeader{begin, end, sectionOf(line)});
+            }
+        }
+    });
+    vector<SectionHeader> headers;
+    for (const vector<SectionHeader>& found : pieceHeaders) {
+        headers.insert(headers.end(), found.begin(), found.end());
+    }
+
+    Map* map = new Map();
+    MapInfo info;
+    size_t errorOffset = string_view::npos;
+    string error;
+
+    // 2) Sections in file order, territory runs kept for the workers
+    vector<pair<string_view, ContinentId>> territoryRuns;
+    size_t territoryBytes = 0;
+    for (size_t h = 0; h < headers.size() && errorOffset == string_view::npos; h++) {
+        size_t end = (h + 1 < headers.size()) ? headers[h + 1].begin : text.size();
+        string_view rest = text.substr(headers[h].end, end - headers[h].end);
+        if (headers[h].section == TERRITORIES) {
+            territoryRuns.emplace_back(rest, static_cast<ContinentId>(map->getContinents()->size()));
+            territoryBytes += rest.size();
+            continue;
+        }
+        while (!rest.empty()) {
+            string_view line = trimView(nextField(rest, '\n'));
+            if (line.empty() || line[0] == ';') continue;
+            if (headers[h].section == MAP_SECTION) {
+                size_t equals = line.find('=');
+                if (equals != string_view::npos) {
+                    info.set(line.substr(0, equals), line.substr(equals + 1));
+                }
+            } else if (headers[h].section == CONTINENTS) {
+                try {
+                    string_view fields = line;
+                    string_view continentName = nextField(fields, '=');
+                    if (!fields.empty()) {
+                        int bonus = parseInt(nextField(fields, '='));
+                        map->createContinent(string(continentName), bonus);
+                    }
+                } catch (const exception& e) {
+                    errorOffset = line.data() - text.data();
+                    error = e.what();
+                    break;
+                }
+            }
+        }
+    }
+
+    // 3) Territory lines
+    vector<TerritoryChunk> chunks;
+    for (const auto& [run, continentLimit] : territoryRuns) {
+        size_t count = (workers > 1) ? run.size() * 4 * workers / max<size_t>(1, territoryBytes) + 1 : 1;
+        for (string_view piece : splitLines(run, count)) {
+            chunks.emplace_back();
+            chunks.back().text = piece;
+            chunks.back().continentLimit = continentLimit;
+        }
+    }
+    runInParallel(static_cast<int>(chunks.size()), workers, [&](int i) {
+        TerritoryChunk& chunk = chunks[i];
+        chunk.adjacencyOffsets.push_back(0);
+        string_view rest = chunk.text;
+        while (!rest.empty()) {
+            string_view line = trimView(nextField(rest, '\n'));
+            if (line.empty() || line[0] == ';') continue;
+            TerritoryLine parsed;
+            try {
+                if (!parseTerritoryLine(line, parsed)) continue;
+            } catch (const exception& e) {
+                chunk.errorOffset = line.data() - text.data();
+                chunk.error = e.what();
+                return;
+            }
+            chunk.lines.push_back(parsed);
+            string_view names = parsed.adjacency;
+            while (!names.empty()) {
+                string_view adjacentName = nextField(names, ',');
+                ContinentId named = map->findContinentId(adjacentName);
+                if (named != NO_CONTINENT && named < chunk.continentLimit) {
+                    chunk.continentAsNeighbor = true;
+                }
+                chunk.adjacencyNames.push_back(adjacentName);
+            }
+            chunk.adjacencyOffsets.push_back(static_cast<int>(chunk.adjacencyNames.size()));
+        }
+    });
+    for (const TerritoryChunk& chunk : chunks) {
+        if (chunk.errorOffset < errorOffset) {
+            errorOffset = chunk.errorOffset;
+            error = chunk.error;
+        }
+    }
+    if (errorOffset != string_view::npos) {
+        *messages << "Error parsing file " << file << ": " << error << endl;
+        delete map;
+        return nullptr;
+    }
+
+    // 4) Territories in file order
+    size_t lineCount = 0;
+    for (const TerritoryChunk& chunk : chunks) {
+        lineCount += chunk.lines.size();
+    }
+    map->reserveTerritories(static_cast<int>(lineCount));
+    for (TerritoryChunk& chunk : chunks) {
+        chunk.firstId = static_cast<TerritoryId>(map->getTerritories()->size());
+        for (const TerritoryLine& line : chunk.lines) {
+            Territory* territory = map->createTerritory(string(line.name));
+            ContinentId continent = map->findContinentId(line.continent);
+            if (continent != NO_CONTINENT && continent < chunk.continentLimit) {
+                map->getContinent(continent)->addTerritory(territory);
+            }
+            map->setTerritoryPosition(territory->getId(), line.position);
+        }
+        if (chunk.continentAsNeighbor) {
+            map->setisTerritoryIsContinent(false);
+        }
+    }
+
+    // 5) Adjacency
+    runInParallel(static_cast<int>(chunks.size()), workers, [&](int i) {
+        TerritoryChunk& chunk = chunks[i];
+        chunk.neighbors.reserve(chunk.adjacencyNames.size());
+        chunk.neighborOffsets.push_back(0);
+        for (size_t k = 0; k < chunk.lines.size(); k++) {
+            TerritoryId from = map->findTerritoryId(chunk.lines[k].name);
+            chunk.lineTerritory.push_back(from);
+            chunk.duplicateNames |= (from != chunk.firstId + static_cast<TerritoryId>(k));
+            size_t rowStart = chunk.neighbors.size();
+            for (int a = chunk.adjacencyOffsets[k]; a < chunk.adjacencyOffsets[k + 1]; a++) {
+                TerritoryId to = map->findTerritoryId(chunk.adjacencyNames[a]);
+                if (to != NO_TERRITORY && to != from) {
+                    chunk.neighbors.push_back(to);
+                }
+            }
+            sort(chunk.neighbors.begin() + rowStart, chunk.neighbors.end());
+            chunk.neighbors.erase(unique(chunk.neighbors.begin() + rowStart, chunk.neighbors.end()), chunk.neighbors.end());
+            chunk.neighborOffsets.push_back(static_cast<int>(chunk.neighbors.size()));
+        }
+    });
+
+    bool oneRowPerTerritory = none_of(chunks.begin(), chunks.end(), [](const TerritoryChunk& chunk) {
+        return chunk.duplicateNames;
+    });
+    vector<size_t> chunkStart(chunks.size() + 1, 0);
+    for (size_t i = 0; i < chunks.size(); i++) {
+        chunkStart[i + 1] = chunkStart[i] + chunks[i].neighbors.size();
+    }
+    if (oneRowPerTerritory) {
+        vector<int> rowOffsets(lineCount + 1, 0);
+        vector<TerritoryId> neighborIds(chunkStart.back());
+        runInParallel(static_cast<int>(chunks.size()), workers, [&](int i) {
+            const TerritoryChunk& chunk = chunks[i];
+            for (size_t k = 0; k < chunk.lines.size(); k++) {
+                rowOffsets[chunk.firstId + k + 1] = static_cast<int>(chunkStart[i]) + chunk.neighborOffsets[k + 1];
+            }
+            copy(chunk.neighbors.begin(), chunk.neighbors.end(), neighborIds.begin() + chunkStart[i]);
+        });
+        map->setTopology(new MapTopology(static_cast<int>(lineCount), std::move(rowOffsets), std::move(neighborIds)));
+    } else {
+        // Lines that repeat a name add their edges to the first territory of that name
+        map->reserveAdjacencies(static_cast<int>(chunkStart.back()));
+        for (const TerritoryChunk& chunk : chunks) {
+            for (size_t k = 0; k < chunk.lines.size(); k++) {
+                for (int a = chunk.neighborOffsets[k]; a < chunk.neighborOffsets[k + 1]; a++) {
+                    map->addAdjacency(chunk.lineTerritory[k], chunk.neighbors[a]);
+                }
+            }
+        }
+    }
+    map->setInfo(info);
+    return map;
+}
+
+bool MapLoader::isValidMapFile(const string& fileName) const{
+    Map* testMap = loadMap(fileName);
+    bool isValid = (testMap != nullptr && testMap->validate());
+    delete testMap;
+    return isValid;
+}
+
+// ==================== Batch validation ====================
+
+// Stream insertion operator (MapCheckResult)
+ostream& operator<<(ostream& os, const MapCheckResult& result) {
+    streamsize precision = os.precision();
+    os << "file=" << result.fileName
+       << " status=" << (!result.loaded ? "unreadable" : result.valid ? "valid" : "invalid")
+       << " territories=" << result.territoryCount
+       << " continents=" << result.continentCount
+       << " edges=" << result.edgeCount
+       << fixed << setprecision(2)
+       << " load_ms=" << result.loadMs
+       << " validate_ms=" << result.validateMs
+       << defaultfloat << setprecision(precision)
+       << " reasons=\"" << result.reasons << "\"";
+    return os;
+}
+
+// Loads (with the silent mapped parser) and validates one file without printing anything;
+// load errors and validation problems end up in the reasons of the result
+MapCheckResult MapLoader::checkMapFile(const string& file) const{
+    MapCheckResult result;
+    result.fileName = file;
+
+    MapLoader quietLoader(*this);
+    ostringstream errors;
+    quietLoader.setMessageStream(&errors);
+    quietLoader.setLoadMode(MapLoadMode::Mapped);
+
+    auto start = chrono::steady_clock::now();
+    Map* map = quietLoader.loadMap(file);
+    auto loaded = chrono::steady_clock::now();
+    result.loadMs = chrono::duration<double, milli>(loaded - start).count();
+
+    if (map == nullptr) {
+        result.reasons = errors.str();
+        while (!result.reasons.empty() && isspace(static_cast<unsigned char>(result.reasons.back()))) {
+            result.reasons.pop_back();
+        }
+        if (result.reasons.empty()) result.reasons = "cannot load map";
+        replace(result.reasons.begin(), result.reasons.end(), '\n', ';');
+        replace(result.reasons.begin(), result.reasons.end(), '"', '\'');
+        return result;
+    }
+
+    ValidationReport report = map->getValidationReport();
+    result.validateMs = chrono::duration<double, milli>(chrono::steady_clock::now() - loaded).count();
+    result.loaded = true;
+    result.valid = report.isValid();
+    result.territoryCount = static_cast<int>(map->getTerritories()->size());
+    result.continentCount = static_cast<int>(map->getContinents()->size());
+    result.edgeCount = map->getTopology()->getEdgeCount();
+
+    vector<string> reasons;
+    if (!report.isConnected()) {
+        reasons.push_back(to_string(report.components.size()) + " disconnected components");
+    }
+    if (!report.areContinentsConnected()) {
+        reasons.push_back(to_string(report.continentPieces.size()) + " disconnected continents");
+    }
+    if (!report.orphans.empty()) {
+        reasons.push_back(to_string(report.orphans.size()) + " territories in no continent");
     }
-    if (territories->size() == 1) {
-        cout<<"Warning: The map has only one territory."<<endl;
-        return true; // A single territory is considered connected
+    if (!report.duplicates.empty()) {
+        reasons.push_back(to_string(report.duplicates.size()) + " territories in several continents");
+    }
+    if (report.territoryNamedAsContinent) {
+        reasons.push_back("territory named as a continent");
+    }
+    for (size_t i = 0; i < reasons.size(); i++) {
+        result.reasons += (i > 0 ? "; " : "") + reasons[i];
     }
 
-    set<Territory*> visited; // To track visited territories
-    queue<Territory*> IsConnectedGraphQueue; // BFS queue to process territories
-    
-    // Start BFS from the first territory
-    IsConnectedGraphQueue.push(territories->at(0));
-    // Mark the starting territory as visited
-    visited.insert(territories->at(0));
-    
-    
-    while (!IsConnectedGraphQueue.empty()) {
-        // Get the next territory to explore, which is at the front of the queue
-        Territory* current = IsConnectedGraphQueue.front();
-        IsConnectedGraphQueue.pop();
-
-        // Range-based for loop to iterate through each adjacent territory
-        for (Territory* adjacent : *current->getAdjacentTerritories()) {
-            // If adjacent territory has not been visited yet
-            // 0 means the territory is not in the set (it has not been visited).
-            // 1 means the territory is in the set (it has been visited).
-            if (visited.count(adjacent) == 0) {
-                // Mark it as visited and add to the queue
-                visited.insert(adjacent);
-                IsConnectedGraphQueue.push(adjacent);
-            }
+    delete map;
+    return result;
+}
+
+// Checks every file on a pool of worker threads; each worker takes the next unchecked file,
+// so one huge map does not hold up the rest. Results come back in the order of fileNames
+vector<MapCheckResult> MapLoader::validateMapFiles(const vector<string>& fileNames, int threadCount) const{
+    vector<MapCheckResult> results(fileNames.size());
+    if (threadCount <= 0) {
+        threadCount = max(1u, thread::hardware_concurrency());
+    }
+    threadCount = min<int>(threadCount, max<size_t>(1, fileNames.size()));
+
+    atomic<size_t> nextFile(0);
+    auto worker = [&]() {
+        for (size_t i = nextFile++; i < fileNames.size(); i = nextFile++) {
+            results[i] = checkMapFile(fileNames[i]);
         }
+    };
+
+    vector<thread> pool;
+    for (int i = 1; i < threadCount; i++) {
+        pool.emplace_back(worker);
     }
-    // If the number of visited territories is equal to the total number of territories, the map is connected
-    return visited.size() == territories->size();
+    worker();
+    for (thread& t : pool) {
+        t.join();
+    }
+    return results;
 }
 
-// 2) Check if each continent is a connected subgraph
-bool Map::areContinentsConnected() const{
-    for (Continent* continent : *continents) {
-        // Use the isContinentConnected function of Continent to check if it's a connected subgraph
-        if (!continent->isContinentConnected()) {
+// Shell-style match of a file name against a pattern with * and ?
+static bool matchesGlob(string_view name, string_view pattern) {
+    size_t n = 0, p = 0, starP = string_view::npos, starN = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            n++;
+            p++;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            starP = p++;
+            starN = n;
+        } else if (starP != string_view::npos) {
+            p = starP + 1;
+            n = ++starN;
+        } else {
             return false;
         }
     }
-    return true;
-} 
-// 3) Check that each territory belongs to exactly one continent
-bool Map::isEachTerritoryInOneContinent() const{
-    set<Territory*> territorySet; 
-    
-    // Check that each territory belongs to exactly one continent
-    for (Continent* continent : *continents) {
-        for (Territory* territory : *continent->getTerritories()) {
-            if (territorySet.count(territory) > 0) {
-                // Territory found in multiple continents
-                return false;
+    while (p < pattern.size() && pattern[p] == '*') p++;
+    return p == pattern.size();
+}
+
+// A directory expands to every .map file below it; anything else is a glob on file names
+// (wildcards only in the last path component, e.g. packs/europe/*.map). Sorted by path
+vector<string> MapLoader::findMapFiles(const string& directoryOrGlob) {
+    vector<string> files;
+    error_code error;
+    filesystem::path target(directoryOrGlob);
+
+    if (filesystem::is_directory(target, error)) {
+        for (auto it = filesystem::recursive_directory_iterator(target, error); !error && it != filesystem::recursive_directory_iterator(); it.increment(error)) {
+            if (it->is_regular_file(error) && it->path().extension() == ".map") {
+                files.push_back(it->path().string());
+            }
+        }
+    } else {
+        filesystem::path directory = target.has_parent_path() ? target.parent_path() : filesystem::path(".");
+        string pattern = target.filename().string();
+        for (auto it = filesystem::directory_iterator(directory, error); !error && it != filesystem::directory_iterator(); it.increment(error)) {
+            if (it->is_regular_file(error) && matchesGlob(it->path().filename().string(), pattern)) {
+                files.push_back(target.has_parent_path() ? it->path().string() : it->path().filename().string());
             }
-            territorySet.insert(territory);
         }
     }
-    
-    // Check that all territories belong to a continent 
-    // and see whether territory is same name as a continent (Ensure that each territory belongs to exactly one continent)
-    // getisTerritoryIsContinent() returns false if a territory has the same name as a continent (Mean territory belongs to more than one continent)
-    return territorySet.size() == territories->size() && getisTerritoryIsContinent();
+    sort(files.begin(), files.end());
+    return files;
 }
 
-// distribute territories to players (for game setup - Ass2)
-void Map::distributeTerritories(vector<Player*>& players){
-    vector<Territory*> territories = *this->getTerritories();
-    if (territories.empty()){
-        cout << "No territories found in map." << endl;
-        return;
-    }
+// ==================== Binary map images (.wzmap) ====================
 
-    int numPlayers = players.size();
-    int i = 0;
-    for (auto* territory : territories){
-        Player* currentPlayer = players[i % numPlayers];
-        // Set ownership
-        territory->setOwner(currentPlayer);
-        // Add to the player's defend list
-        currentPlayer->addToDefend(territory);
-        i++;
-    }
-    cout << "Territories have been distributed to players." << endl;
+// Fixed-size records of a .wzmap image (names point into the string blob at the end)
+struct WzTerritoryRecord {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    int32_t x;
+    int32_t y;
+};
+
+struct WzContinentRecord {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    int32_t bonus;
+    uint32_t memberStart;       // members are territory ids in [memberStart, memberStart + memberCount)
+    uint32_t memberCount;
+};
+
+struct WzPropertyRecord {
+    uint32_t keyOffset;
+    uint32_t keyLength;
+    uint32_t valueOffset;
+    uint32_t valueLength;
+};
+
+// Appends the raw bytes of a plain value to an image buffer
+template <typename T>
+static void writeRaw(string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
 }
 
+// Reads a plain value at offset, throws when the image is truncated
+template <typename T>
+static T readRaw(string_view image, size_t& offset) {
+    if (offset + sizeof(T) > image.size()) {
+        throw runtime_error("truncated map image");
+    }
+    T value;
+    memcpy(&value, image.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+}
 
-// ==================== MapLoader Implementation ====================
+// FNV-1a hash of the file contents, 0 when the file cannot be read
+uint64_t MapLoader::hashFile(const string& file) {
+    MappedFile input(file);
+    if (!input.isOpen()) return 0;
 
-// Helper methods for parsing
-vector<string> MapLoader::split(const string& str, char delimiter) const {
-    vector<string> tokens;
-    string token;
-    istringstream tokenStream(str);
-    while (getline(tokenStream, token, delimiter)) {
-        tokens.push_back(token);
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : input.view()) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
     }
-    return tokens;
+    return hash;
 }
 
-string MapLoader::trim(const string& str) const {
-    size_t first = str.find_first_not_of(" \t\r\n");
-    if (first == string::npos) return "";
-    size_t last = str.find_last_not_of(" \t\r\n");
-    return str.substr(first, (last - first + 1));
+// Earth.map -> Earth.wzmap (next to the source file)
+string MapLoader::imageFileFor(const string& mapFile) {
+    return filesystem::path(mapFile).replace_extension(WZMAP_EXTENSION).string();
 }
 
+// Images linked into the program, by the file name they replace (filled before main() runs,
+// so a function-local table avoids depending on the initialization order of translation units)
+static unordered_map<string, string_view>& bundledMaps() {
+    static unordered_map<string, string_view> maps;
+    return maps;
+}
 
-// Constructors (mapLoader)
-MapLoader::MapLoader() {
-    fileName = new string("");
+bool MapLoader::addBundledMap(const string& mapFile, string_view image) {
+    return bundledMaps().insert_or_assign(mapFile, image).second;
 }
 
-MapLoader::MapLoader(const string& file) {
-    fileName = new string(file);
+const string_view* MapLoader::findBundledMap(const string& mapFile) {
+    auto found = bundledMaps().find(mapFile);
+    return (found != bundledMaps().end()) ? &found->second : nullptr;
 }
 
-MapLoader::MapLoader(const MapLoader& other) {
-    fileName = new string(*other.fileName);
+vector<string> MapLoader::getBundledMapNames() {
+    vector<string> names;
+    for (const auto& bundled : bundledMaps()) {
+        names.push_back(bundled.first);
+    }
+    sort(names.begin(), names.end());
+    return names;
 }
 
-//Destructor (MapLoader)
-MapLoader::~MapLoader() {
-    delete fileName;
-    fileName = nullptr;
+// Base maps of the loaded variants, by file and numbering, with the time their file was written
+struct PatchBase {
+    filesystem::file_time_type modified;
+    shared_ptr<const Map> map;
+};
+
+static unordered_map<string, PatchBase>& patchBases() {
+    static unordered_map<string, PatchBase> bases;
+    return bases;
 }
 
-//Assignment operator (MapLoader)
-MapLoader& MapLoader::operator=(const MapLoader& other) {
-    if (this != &other) {
-        delete fileName;
-        fileName = new string(*other.fileName);
-    }
-    return *this;
+static mutex& patchBasesMutex() {
+    static mutex lock;
+    return lock;
 }
 
-// Stream insertion operator (MapLoader)
-ostream& operator<<(ostream& os, const MapLoader& loader) {
-    os << "MapLoader for file: " << *loader.fileName;
-    return os;
+void MapLoader::clearPatchBases() {
+    lock_guard<mutex> guard(patchBasesMutex());
+    patchBases().clear();
 }
 
-// Getters (MapLoader)
-string MapLoader::getFileName() const{
-    return *fileName;
+// Loads a .wzpatch variant on top of its base map. A base is loaded once with this loader's settings
+// and kept until its file changes; it is validated and analysed up front, so the copies made by
+// MapPatch::apply only read it and a variant costs its patch plus one copy of the base
+Map* MapLoader::loadPatchedMap(const string& file) const{
+    MapPatch patch;
+    if (!patch.read(file, *messages)) {
+        return nullptr;
+    }
+    if (filesystem::path(patch.getBaseFile()).extension() == WZPATCH_EXTENSION) {
+        *messages << "Error: The base of " << file << " is another patch" << endl;
+        return nullptr;
+    }
+
+    // The base is looked up next to the patch first, then as written (a bundled map or a path from here)
+    filesystem::path nextToPatch = filesystem::path(file).parent_path() / patch.getBaseFile();
+    string baseFile = filesystem::exists(nextToPatch) ? nextToPatch.string() : patch.getBaseFile();
+    error_code noFile;
+    filesystem::file_time_type modified = filesystem::last_write_time(baseFile, noFile);
+    string key = baseFile + "|" + to_string(static_cast<int>(territoryOrder));
+
+    shared_ptr<const Map> base;
+    {
+        lock_guard<mutex> guard(patchBasesMutex());
+        auto found = patchBases().find(key);
+        if (found != patchBases().end() && found->second.modified == modified) {
+            base = found->second.map;
+        }
+    }
+    if (base == nullptr) {
+        Map* loaded = loadMap(baseFile);
+        if (loaded == nullptr) {
+            *messages << "Error: Cannot load the base map " << baseFile << " of " << file << endl;
+            return nullptr;
+        }
+        loaded->getTopology();
+        if (loaded->validate()) {
+            loaded->getAnalysis();
+        }
+        base.reset(loaded);
+        lock_guard<mutex> guard(patchBasesMutex());
+        patchBases()[key] = PatchBase{modified, base};
+    }
+    return patch.apply(*base, *messages);
 }
 
-// Setters (MapLoader)
-void MapLoader::setFileName(const string& file){
-    *fileName = file;
+// Parses a text map, validates it and writes its binary image
+bool MapLoader::compileMap(const string& mapFile, const string& imageFile) const{
+    MapLoader textLoader(*this);
+    textLoader.setUseBinaryCache(false);
+    textLoader.setUseBundledMaps(false);
+    textLoader.setTerritoryOrder(TerritoryOrder::File);
+    Map* map = textLoader.loadMap(mapFile);
+    if (map == nullptr) {
+        return false;
+    }
+    bool written = writeBinaryMap(*map, hashFile(mapFile), imageFile);
+    delete map;
+    return written;
 }
 
-// Map loading operations
-Map* MapLoader::loadMap() const{
-    return loadMap(*fileName);
+bool MapLoader::writeBinaryMap(const Map& map, uint64_t sourceHash, const string& imageFile) const{
+    string image = buildBinaryImage(map, sourceHash);
+
+    // Write to a temporary file first so a reader never sees half an image; the name is unique
+    // per process and thread so concurrent writers of the same image never share it
+#ifndef _WIN32
+    long processId = static_cast<long>(getpid());
+#else
+    long processId = static_cast<long>(_getpid());
+#endif
+    ostringstream temporaryName;
+    temporaryName << imageFile << "." << processId << "." << this_thread::get_id() << ".tmp";
+    string temporaryFile = temporaryName.str();
+    error_code error;
+    {
+        ofstream output(temporaryFile, ios::binary | ios::trunc);
+        if (!output.is_open()) {
+            *messages << "Error: Cannot write map image " << imageFile << endl;
+            filesystem::remove(temporaryFile, error);
+            return false;
+        }
+        output.write(image.data(), image.size());
+        output.close();
+        if (!output) {
+            *messages << "Error: Cannot write map image " << imageFile << endl;
+            filesystem::remove(temporaryFile, error);
+            return false;
+        }
+    }
+    filesystem::rename(temporaryFile, imageFile, error);
+    if (error) {
+        error_code removeError;
+        filesystem::remove(temporaryFile, removeError);
+        return false;
+    }
+    return true;
 }
-Map* MapLoader::loadMap(const string& file) const{
-    ifstream inputFile(file);
-    if (!inputFile.is_open()) {
-        cout << "Error: Cannot open file " << file << endl;
-        return nullptr;
+
+// Lays out the image of map in memory: header, territory records, CSR rows, continent records,
+// continent members, [Map] properties and the string pool
+string MapLoader::buildBinaryImage(const Map& map, uint64_t sourceHash) const{
+    const MapTopology* topology = map.getTopology();
+    const vector<Territory*>& territories = *map.getTerritories();
+    const vector<Continent*>& continents = *map.getContinents();
+    const vector<pair<string, string>>& properties = map.getInfo().properties;
+
+    string strings;
+    auto addString = [&strings](string_view text) {
+        uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings.append(text);
+        return offset;
+    };
+
+    vector<uint32_t> members;
+    for (Continent* continent : continents) {
+        for (Territory* territory : *continent->getTerritories()) {
+            members.push_back(static_cast<uint32_t>(territory->getId()));
+        }
     }
-    
-    Map* map = new Map();
-    string line;
-    string currentSection = "";
-    // For two-pass adjacency setup
-    std::map<std::string, std::vector<std::string>> adjacencyMap;
-    
-    try {
-        while (getline(inputFile, line)) {
-            line = trim(line);
-            // Skip empty lines and comments (starts with a semicolon (;))
-            if (line.empty() || line[0] == ';') continue;
-            
-            // Check for section headers
-            // E.g. [Map] , [Continents], [Territories]
-            else if (line[0] == '[' && line[line.length()-1] == ']') {
-                currentSection = line;
-                continue;
-            }
 
-            // Parse [Map] Section
-            else if (currentSection == "[Map]") {
-                // Print a header before printing the Map info
-                cout << "Map Info:" << endl;
+    WzMapHeader header;
+    memcpy(header.magic, WZMAP_MAGIC, sizeof(header.magic));
+    header.version = WZMAP_VERSION;
+    header.sourceHash = sourceHash;
+    header.flags = (map.validate() ? WZMAP_VALID : 0) | (map.getisTerritoryIsContinent() ? WZMAP_NO_CONTINENT_NEIGHBOR : 0);
+    header.territoryCount = static_cast<uint32_t>(territories.size());
+    header.continentCount = static_cast<uint32_t>(continents.size());
+    header.edgeCount = static_cast<uint32_t>(topology->getEdgeCount());
+    header.memberCount = static_cast<uint32_t>(members.size());
+    header.propertyCount = static_cast<uint32_t>(properties.size());
+    header.reserved = 0;
 
-                // Print all the lines in the [Map] section until a blank line is found
-                while (getline(inputFile, line)) {
-                    line = trim(line); // Trim whitespace
+    string body;
+    for (Territory* territory : territories) {
+        WzTerritoryRecord record;
+        record.nameOffset = addString(territory->getName());
+        record.nameLength = static_cast<uint32_t>(territory->getName().size());
+        record.x = map.getTerritoryPosition(territory->getId()).x;
+        record.y = map.getTerritoryPosition(territory->getId()).y;
+        writeRaw(body, record);
+    }
+    for (TerritoryId id = 0; id <= topology->getTerritoryCount(); id++) {
+        int rowStart = (id < topology->getTerritoryCount()) ? topology->getRowStart(id) : topology->getEdgeCount();
+        writeRaw(body, static_cast<uint32_t>(rowStart));
+    }
+    for (TerritoryId id = 0; id < topology->getTerritoryCount(); id++) {
+        for (TerritoryId neighbor : topology->getNeighbors(id)) {
+            writeRaw(body, static_cast<int32_t>(neighbor));
+        }
+    }
+    uint32_t memberStart = 0;
+    for (Continent* continent : continents) {
+        WzContinentRecord record;
+        record.nameOffset = addString(continent->getName());
+        record.nameLength = static_cast<uint32_t>(continent->getName().size());
+        record.bonus = continent->getBonusArmies();
+        record.memberStart = memberStart;
+        record.memberCount = static_cast<uint32_t>(continent->getTerritories()->size());
+        memberStart += record.memberCount;
+        writeRaw(body, record);
+    }
+    for (uint32_t member : members) {
+        writeRaw(body, member);
+    }
+    for (const auto& property : properties) {
+        WzPropertyRecord record;
+        record.keyOffset = addString(property.first);
+        record.keyLength = static_cast<uint32_t>(property.first.size());
+        record.valueOffset = addString(property.second);
+        record.valueLength = static_cast<uint32_t>(property.second.size());
+        writeRaw(body, record);
+    }
+    header.stringBytes = static_cast<uint32_t>(strings.size());
 
-                    // If encounter a blank line, stop processing the map section
-                    if (line.empty()) {
-                        break;
-                    }
-                    // Print the line to the console (or log it as needed)
-                    cout << line << endl;
-                }
-            }
+    string image;
+    image.reserve(sizeof(header) + body.size() + strings.size());
+    writeRaw(image, header);
+    image.append(body);
+    image.append(strings);
+    return image;
+}
 
-            // Parse [Continents] Section
-            else if (currentSection == "[Continents]") {
-                vector<string> tokens = split(line, '=');
-                if (tokens.size() >= 2) {
-                    string continentName = tokens[0];
-                    int bonus = stoi(tokens[1]); // stoi: converts string to int
-                    Continent* continent = new Continent(continentName, bonus);
-                    map->addContinent(continent);  // Add the continent to the map
-                }
-            }
-            
-            // Parse [Territories] Section
-            else if (currentSection == "[Territories]") {
-                vector<string> tokens = split(line, ',');
-                if (tokens.size() >= 4) {
-                    string territoryName = tokens[0];
-                    int x = stoi(tokens[1]);  // Coordinates
-                    int y = stoi(tokens[2]);  // Coordinates
-                    string continentName = tokens[3];
+// Loads a binary image in one mapping; returns nullptr when the image is unreadable,
+// from another version, or (when expectedHash is not 0) built from a different source file
+Map* MapLoader::loadBinaryMap(const string& imageFile, uint64_t expectedHash) const{
+    MappedFile input(imageFile);
+    if (!input.isOpen()) {
+        *messages << "Error: Cannot open file " << imageFile << endl;
+        return nullptr;
+    }
+    return loadBinaryImage(input.view(), imageFile, expectedHash);
+}
 
-                    Territory* territory = new Territory(territoryName);
-                    Continent* continent = map->getContinent(continentName);
+// Builds a map from an image already in memory (a mapped file or a bundled map);
+// imageName only appears in error messages
+Map* MapLoader::loadBinaryImage(string_view image, const string& imageName, uint64_t expectedHash) const{
+    Map* map = nullptr;
 
-                    if (continent != nullptr) {
-                        continent->addTerritory(territory);  // Add territory to its continent
-                    }
+    try {
+        size_t offset = 0;
+        WzMapHeader header = readRaw<WzMapHeader>(image, offset);
+        if (memcmp(header.magic, WZMAP_MAGIC, sizeof(header.magic)) != 0 || header.version != WZMAP_VERSION) {
+            if (expectedHash == 0) {
+                *messages << "Error: " << imageName << " is not a compatible map image" << endl;
+            }
+            return nullptr; // a cache from an older version is rebuilt silently
+        }
+        if (expectedHash != 0 && header.sourceHash != expectedHash) {
+            return nullptr; // stale image, the caller rebuilds it
+        }
 
-                    map->addTerritory(territory);  // Add territory to the map
+        size_t stringsOffset = sizeof(WzMapHeader)
+            + header.territoryCount * sizeof(WzTerritoryRecord)
+            + (header.territoryCount + 1) * sizeof(uint32_t)
+            + header.edgeCount * sizeof(int32_t)
+            + header.continentCount * sizeof(WzContinentRecord)
+            + header.memberCount * sizeof(uint32_t)
+            + header.propertyCount * sizeof(WzPropertyRecord);
+        if (stringsOffset + header.stringBytes != image.size()) {
+            throw runtime_error("corrupt map image");
+        }
+        string_view strings = image.substr(stringsOffset);
+        auto getString = [&strings](uint32_t stringOffset, uint32_t length) {
+            if (static_cast<size_t>(stringOffset) + length > strings.size()) throw runtime_error("corrupt map image");
+            return strings.substr(stringOffset, length);
+        };
 
-                    // Store adjacency info for second pass
-                    vector<string> adjacents;
+        map = new Map();
+        vector<WzTerritoryRecord> territoryRecords(header.territoryCount);
+        for (WzTerritoryRecord& record : territoryRecords) {
+            record = readRaw<WzTerritoryRecord>(image, offset);
+        }
 
-                    for (size_t i = 4; i < tokens.size(); i++) {
-                        for(Continent* continentMarked : *map->getContinents()){
-                            if (tokens[i] == continentMarked->getName()){
-                                map->setisTerritoryIsContinent(false);
-                            }
-                        }
-                        // Add adjacent territory names to the list
-                        adjacents.push_back(tokens[i]);
-                    }
-                    // Map territory name to its list of adjacent territory names
-                    adjacencyMap[territoryName] = adjacents;
-                    
-                }
-            
-            } 
+        vector<int> rowOffsets(header.territoryCount + 1);
+        for (int& rowOffset : rowOffsets) {
+            rowOffset = static_cast<int>(readRaw<uint32_t>(image, offset));
+        }
+        vector<TerritoryId> neighbors(header.edgeCount);
+        for (TerritoryId& neighbor : neighbors) {
+            neighbor = readRaw<int32_t>(image, offset);
+            if (neighbor < 0 || neighbor >= static_cast<TerritoryId>(header.territoryCount)) throw runtime_error("corrupt map image");
+        }
+        if (rowOffsets.front() != 0 || rowOffsets.back() != static_cast<int>(header.edgeCount)
+            || !is_sorted(rowOffsets.begin(), rowOffsets.end())) {
+            throw runtime_error("corrupt map image");
         }
-        
-        inputFile.close();
-        
-        // Second pass: set up adjacencies
-        for (const auto& pair : adjacencyMap) {
-            // Get the territory object by name
-            Territory* territory = map->getTerritory(pair.first);
 
-            // Range-based for loop to iterate through each adjacent territory name
-            for (const string& adjName : pair.second) {
-                Territory* adjacent = map->getTerritory(adjName);
-                if (adjacent && adjacent != territory) {
-                    territory->addAdjacentTerritory(adjacent);
-                }
+        for (uint32_t i = 0; i < header.continentCount; i++) {
+            WzContinentRecord record = readRaw<WzContinentRecord>(image, offset);
+            map->createContinent(string(getString(record.nameOffset, record.nameLength)), record.bonus);
+        }
+        for (const WzTerritoryRecord& record : territoryRecords) {
+            Territory* territory = map->createTerritory(string(getString(record.nameOffset, record.nameLength)));
+            map->setTerritoryPosition(territory->getId(), MapPoint{record.x, record.y});
+        }
+
+        // Continent ranges: re-read the continent records to attach their members in file order
+        size_t continentOffset = sizeof(WzMapHeader) + header.territoryCount * sizeof(WzTerritoryRecord)
+            + (header.territoryCount + 1) * sizeof(uint32_t) + header.edgeCount * sizeof(int32_t);
+        size_t memberOffset = continentOffset + header.continentCount * sizeof(WzContinentRecord);
+        for (uint32_t i = 0; i < header.continentCount; i++) {
+            WzContinentRecord record = readRaw<WzContinentRecord>(image, continentOffset);
+            if (static_cast<uint64_t>(record.memberStart) + record.memberCount > header.memberCount) throw runtime_error("corrupt map image");
+            size_t cursor = memberOffset + record.memberStart * sizeof(uint32_t);
+            for (uint32_t k = 0; k < record.memberCount; k++) {
+                Territory* member = map->getTerritory(static_cast<TerritoryId>(readRaw<uint32_t>(image, cursor)));
+                if (member == nullptr) throw runtime_error("corrupt map image");
+                map->getContinent(static_cast<ContinentId>(i))->addTerritory(member);
             }
         }
+        offset = memberOffset + header.memberCount * sizeof(uint32_t);
 
-        
+        MapInfo info;
+        for (uint32_t i = 0; i < header.propertyCount; i++) {
+            WzPropertyRecord record = readRaw<WzPropertyRecord>(image, offset);
+            info.set(getString(record.keyOffset, record.keyLength), getString(record.valueOffset, record.valueLength));
+        }
+        map->setInfo(info);
+        map->setisTerritoryIsContinent((header.flags & WZMAP_NO_CONTINENT_NEIGHBOR) != 0);
+
+        map->setTopology(new MapTopology(static_cast<int>(header.territoryCount), std::move(rowOffsets), std::move(neighbors)));
+        map->setCachedValidity((header.flags & WZMAP_VALID) != 0);  // last: every edit above clears the verdict
         return map;
-        
+
     } catch (const exception& e) {
-        cout << "Error parsing file " << file << ": " << e.what() << endl;
-        inputFile.close();
+        *messages << "Error reading map image " << imageName << ": " << e.what() << endl;
         delete map;
         return nullptr;
     }
 }
 
-bool MapLoader::isValidMapFile(const string& fileName) const{
-    Map* testMap = loadMap(fileName);
-    bool isValid = (testMap != nullptr && testMap->validate());
-    delete testMap;
-    return isValid;
-}
\ No newline at end of file
+// Loads X.map through X.wzmap: the image is used when its source hash matches the current
+// file, otherwise the text is parsed, validated and the image is rebuilt for the next load
+Map* MapLoader::loadMapCached(const string& file) const{
+    uint64_t hash = hashFile(file);
+    string imageFile = imageFileFor(file);
+
+    if (hash != 0 && filesystem::exists(imageFile)) {
+        Map* cached = loadBinaryMap(imageFile, hash);
+        if (cached != nullptr) {
+            return cached;
+        }
+    }
+
+    Map* map = parseMapFile(file);
+    if (map != nullptr && hash != 0) {
+        writeBinaryMap(*map, hash, imageFile);
+    }
+    return map;
+}
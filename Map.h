@@ -9,6 +9,22 @@
 #include <string>
 #include <map>
 #include <set>
+#include <span>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <new>
+#include <utility>
+#include <string_view>
+#include <unordered_map>
+
+// The handles come before Player.h, whose Orders.h uses TerritoryId
+// Dense handle of a territory inside its Map (its position in Map::getTerritories())
+typedef int TerritoryId;
+const TerritoryId NO_TERRITORY = -1;
+// Dense handle of a continent inside its Map (its position in Map::getContinents())
+typedef int ContinentId;
+const ContinentId NO_CONTINENT = -1;
 
 #include "Player.h"
 
@@ -19,37 +35,107 @@ class Player;
 class Continent;
 class Map;
 
+// Position of a territory on the map image (the x and y fields of the [Territories] section)
+struct MapPoint {
+    int x = 0;
+    int y = 0;
+};
+
+/**
+ * MapArena is a bump allocator owned by a Map
+ * The territories and continents a map creates (and their name, army and member-list storage)
+ * are carved out of a few large blocks instead of one small heap allocation each, so they sit
+ * next to each other in memory and the whole lot is freed with one release of the blocks
+ * Objects placed in the arena are never freed one by one
+ */
+class MapArena {
+    private:
+        vector<pair<char*, size_t>>* blocks;   // start and size of every block
+        char* cursor;                           // next free byte of the last block
+        char* limit;                            // end of the last block
+        size_t bytesUsed;
+
+        void addBlock(size_t minimumSize);
+
+    public:
+        // Block sizes double from the first to the largest
+        static constexpr size_t FIRST_BLOCK_SIZE = 16 * 1024;
+        static constexpr size_t MAX_BLOCK_SIZE = 4 * 1024 * 1024;
+
+        // Constructors and destructor
+        MapArena();
+        MapArena(const MapArena& other) = delete;   // the objects in an arena belong to one map
+        ~MapArena();
+
+        // Assignment operator
+        MapArena& operator=(const MapArena& other) = delete;
+
+        // Stream insertion operator
+        friend ostream& operator<<(ostream& os, const MapArena& arena);
+
+        // Getters
+        size_t getBytesUsed() const;
+        size_t getBytesReserved() const;
+
+        // Arena operations
+        void* allocate(size_t size, size_t alignment);
+        void release();     // frees every block at once, objects inside must already be destroyed
+
+        template <typename T, typename... Args>
+        T* create(Args&&... args) {
+            return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+};
+
 /**
  * Territory class represents a node in the map graph
  * Each territory has a name, owner(owned by which player), armies (how many), continent, and adjacent territories
  */
 class Territory{
+    friend class Map;
+    friend class MapArena;
+
     private:
         string* name;
         Player* owner;
         int* armies;
         Continent* continent;
+        TerritoryId id;
+        Map* map;  // Map this territory belongs to (nullptr for standalone territories)
+        // Edges not yet compiled into the map topology (allocated on first use)
         vector<Territory*>* adjacentTerritories;
+        // Owner and armies live in the TerritoryState of map (standalone territories keep their own)
+        bool stateInMap;
+        // Created by Map::createTerritory: the object, name and armies live in the map's arena
+        bool inArena;
+
+        Territory(const string& name, MapArena* arena);
 
     public:
         //Constructors and destructor
         Territory();
         Territory(const string& name);
-        Territory(const Territory& other);
+        Territory(const Territory& other);      // a standalone copy: not part of other's map, keeps a list of its neighbors
         ~Territory(); //Destructor
 
         // Assignment operator
+        // A standalone territory becomes a standalone copy; a territory of a map stays in its map and
+        // takes the other's name, owner and armies
         Territory& operator=(const Territory& other);
 
         // Stream insertion operator
         friend ostream& operator<<(ostream& os, const Territory& territory);
 
         // Getters
-        string getName() const;
+        const string& getName() const;
         Player* getOwner() const;
         int getArmies() const;
         Continent* getContinent() const;
-        vector<Territory*>* getAdjacentTerritories() const;
+        TerritoryId getId() const;
+        Map* getMap() const;
+        MapPoint getPosition() const;
+        // Neighbors of this territory; for map territories this is a view into the compiled topology
+        span<Territory* const> getAdjacentTerritories() const;
 
         // Setters
         void setName(const std::string& name);
@@ -63,21 +149,362 @@ class Territory{
 
 };
 
+/**
+ * MapInfo holds the [Map] section of a Conquest map file (author, image, wrap, scroll, warn)
+ * Every key=value line is also kept in file order in properties
+ */
+struct MapInfo {
+    string author;
+    string image;
+    string wrap;
+    string scroll;
+    string warn;
+    vector<pair<string, string>> properties;
+
+    void set(string_view key, string_view value);
+    friend ostream& operator<<(ostream& os, const MapInfo& info);
+};
+
+/**
+ * ValidationReport is the result of one linear sweep over a map (see Map::getValidationReport)
+ * Instead of a single verdict it lists every connected component of the map, every continent
+ * that falls apart into several pieces, and the territories in no continent or in more than one
+ * Adjacency is treated as undirected: two territories are connected if either one lists the other
+ */
+struct ValidationReport {
+    vector<vector<TerritoryId>> components;                                  // connected components of the map (a single one when connected)
+    vector<pair<ContinentId, vector<vector<TerritoryId>>>> continentPieces;  // continents made of more than one piece
+    vector<TerritoryId> orphans;                                             // territories in no continent
+    vector<TerritoryId> duplicates;                                          // territories listed more than once by the continents
+    bool territoryNamedAsContinent = false;                                  // a territory shares its name with a continent
+    vector<string> warnings;                                                 // not problems: a map with warnings can be valid
+
+    bool isConnected() const;
+    bool areContinentsConnected() const;
+    bool isEachTerritoryInOneContinent() const;
+    bool isValid() const;
+
+    void print(ostream& os, const Map& map) const;
+};
+
+/**
+ * NameTable is an interned symbol table that maps names to dense ids in O(1)
+ * Each id keeps its own copy of the name; the hash index holds string_views into that storage,
+ * so lookups take a string_view and never build a temporary string
+ * When several ids share a name, lookups return the first one (same as the old linear scans)
+ */
+class NameTable {
+    private:
+        deque<string>* names;                      // indexed by id, deque keeps the strings at stable addresses
+        unordered_map<string_view, int>* index;    // name -> first id with that name
+
+        void rebuildIndex();
+
+    public:
+        // Constructors and destructor
+        NameTable();
+        NameTable(const NameTable& other);
+        ~NameTable();
+
+        // Assignment operator
+        NameTable& operator=(const NameTable& other);
+
+        // Stream insertion operator
+        friend ostream& operator<<(ostream& os, const NameTable& table);
+
+        // Getters
+        int size() const;
+        const string& getName(int id) const;
+
+        // Table operations
+        int add(string_view name);             // appends a name and returns its id
+        int find(string_view name) const;      // returns -1 when the name is unknown
+        void rename(int id, string_view name);
+        void reserve(int count);
+};
+
+/**
+ * MapTopology is the compiled adjacency graph of a Map in compressed sparse row (CSR) form
+ * The neighbors of territory i are neighborIds[offsets[i] .. offsets[i+1]), sorted by id,
+ * so walking the neighbors of a territory reads one contiguous block of memory
+ * Small maps also keep a dense adjacency bit matrix: one row of 64-bit words per territory, so
+ * isAdjacent is one bit test and neighbor-set queries are word-parallel AND/ANDNOT over rows
+ */
+class MapTopology {
+    private:
+        int territoryCount;
+        vector<int>* offsets;
+        vector<TerritoryId>* neighborIds;
+        vector<uint64_t>* adjacencyBits;   // row i holds the neighbors of i, rowWords words per row
+        int rowWords;
+
+        void buildAdjacencyBits();
+
+    public:
+        // Largest map for which the dense adjacency bit matrix is built (512 KB at the limit)
+        static const int BITSET_LIMIT = 2048;
+
+        // Constructors and destructor
+        MapTopology();
+        MapTopology(int territoryCount, const vector<pair<TerritoryId, TerritoryId>>& edges);
+        MapTopology(int territoryCount, vector<int> offsets, vector<TerritoryId> neighborIds); // rows already sorted (binary images)
+        MapTopology(const MapTopology& other);
+        ~MapTopology();
+
+        // Assignment operator
+        MapTopology& operator=(const MapTopology& other);
+
+        // Stream insertion operator
+        friend ostream& operator<<(ostream& os, const MapTopology& topology);
+
+        // Getters
+        int getTerritoryCount() const;
+        int getEdgeCount() const;
+        int getRowStart(TerritoryId id) const;
+        int getDegree(TerritoryId id) const;
+        span<const TerritoryId> getNeighbors(TerritoryId id) const;
+        bool hasAdjacencyBits() const;
+        span<const uint64_t> getAdjacencyRow(TerritoryId id) const;    // empty without the bit matrix
+
+        // Topology operations
+        bool areAdjacent(TerritoryId from, TerritoryId to) const;
+};
+
+/**
+ * SpatialIndex is an implicit k-d tree over the territory positions of a Map
+ * The points live in one flat array ordered so that the middle of every range [lo, hi) is the
+ * median that splits it, on x at even depths and on y at odd depths: no nodes, no pointers,
+ * built in O(n log n) with nth_element
+ * Nearest-territory queries take O(log n) on typical maps; radius and box queries take
+ * O(sqrt(n) + k) in the worst case for k reported territories
+ */
+class SpatialIndex {
+    private:
+        vector<MapPoint>* points;       // positions in tree order
+        vector<TerritoryId>* ids;       // territory stored at each tree slot
+
+        void findNearest(int lo, int hi, int depth, MapPoint target, TerritoryId& best, int64_t& bestDistance) const;
+        void findInBox(int lo, int hi, int depth, MapPoint low, MapPoint high, vector<int>& slots) const;
+
+    public:
+        // Constructors and destructor
+        SpatialIndex();
+        SpatialIndex(const vector<MapPoint>& positions);    // positions indexed by TerritoryId
+        SpatialIndex(const SpatialIndex& other);
+        ~SpatialIndex();
+
+        // Assignment operator
+        SpatialIndex& operator=(const SpatialIndex& other);
+
+        // Stream insertion operator
+        friend ostream& operator<<(ostream& os, const SpatialIndex& index);
+
+        // Getters
+        int size() const;
+
+        // Queries (results sorted by TerritoryId)
+        TerritoryId findNearest(int x, int y) const;    // NO_TERRITORY when the index is empty
+        vector<TerritoryId> findInRadius(int x, int y, int radius) const;
+        vector<TerritoryId> findInBox(int minX, int minY, int maxX, int maxY) const;
+};
+
+/**
+ * TerritoryState holds the per-turn state of the territories of a Map (owner and armies) as
+ * structure-of-arrays: contiguous arrays indexed by TerritoryId instead of a field per Territory
+ * Owners are also kept as small integer slots (one per distinct player seen) so that the
+ * per-player army reductions scan two int arrays; they use AVX2 when the CPU has it
+ * Each slot also keeps the set of territories it owns as a bitset (bit id of word id / 64),
+ * updated by setOwner, for the word-parallel neighbor queries of Map
+ */
+class TerritoryState {
+    private:
+        vector<Player*>* owners;
+        vector<int>* armies;
+        vector<int32_t>* ownerSlots;            // slot of owners[id] in slotPlayers
+        vector<const Player*>* slotPlayers;     // slot 0 is the unowned (nullptr) owner
+        vector<vector<uint64_t>>* slotBits;     // territories owned by each slot
+
+        int32_t findSlot(const Player* player) const;   // -1 if the player never owned a territory here
+        int32_t slotFor(const Player* player);
+
+    public:
+        // Constructors and destructor
+        TerritoryState();
+        TerritoryState(const TerritoryState& other);
+        ~TerritoryState();
+
+        // Assignment operator
+        TerritoryState& operator=(const TerritoryState& other);
+
+        // Stream insertion operator
+        friend ostream& operator<<(ostream& os, const TerritoryState& state);
+
+        // Getters
+        int size() const;
+        Player* getOwner(TerritoryId id) const;
+        int getArmies(TerritoryId id) const;
+        span<const int> getArmiesArray() const;
+        span<const uint64_t> getOwnedBits(const Player* player) const;  // empty if the player never owned a territory
+
+        // Setters
+        void setOwner(TerritoryId id, Player* owner);
+        void setArmies(TerritoryId id, int armies);
+
+        // State operations
+        void addTerritory(Player* owner, int armies);
+        void clear();
+
+        // Reductions over the territories a player owns (lowest id wins ties)
+        TerritoryId findStrongest(const Player* player) const;  // NO_TERRITORY if the player owns none
+        TerritoryId findWeakest(const Player* player) const;
+        long long getTotalArmies(const Player* player) const;
+};
+
+/**
+ * MapAnalysis describes the structure of the graph of a Map, computed in one O(V + E) pass
+ * and cached with the map (edges count in both directions, as in validation)
+ * - chokepoints: articulation points, whose loss splits their component, and bridges, the edges
+ *   whose loss does (Tarjan's low-link search, iterative so huge maps do not overflow the stack)
+ * - borders: territories with a neighbor in another continent, listed per continent
+ * - degree statistics and the diameter of the largest component, estimated by two breadth-first
+ *   sweeps (a lower bound, exact on trees and on most game maps)
+ * The per-territory queries are O(1) (isBridge is O(log #bridges))
+ */
+class MapAnalysis {
+    private:
+        int territoryCount;
+        int edgeCount;                                  // undirected edges
+        int componentCount;
+        vector<uint8_t>* flags;                         // ARTICULATION / BORDER bits of each territory
+        vector<int>* bridgeCounts;                      // bridges at each territory
+        vector<TerritoryId>* articulationPoints;
+        vector<pair<TerritoryId, TerritoryId>>* bridges;   // (lower id, higher id), sorted
+        vector<vector<TerritoryId>>* continentBorders;  // indexed by ContinentId
+        int minDegree;
+        int maxDegree;
+        int diameter;
+        shared_ptr<const MapTopology> undirected;       // every edge in both directions, without repeats
+
+        static const uint8_t ARTICULATION = 1;
+        static const uint8_t BORDER = 2;
+
+        void findChokepoints(const MapTopology& graph, vector<TerritoryId>& roots);
+        void findDiameter(const MapTopology& graph, const vector<TerritoryId>& roots);
+
+    public:
+        // Constructors and destructor
+        MapAnalysis();
+        MapAnalysis(const Map& map);
+        MapAnalysis(const MapAnalysis& other);
+        ~MapAnalysis();
+
+        // Assignment operator
+        MapAnalysis& operator=(const MapAnalysis& other);
+
+        // Stream insertion operator
+        friend ostream& operator<<(ostream& os, const MapAnalysis& analysis);
+
+        // Getters
+        int getTerritoryCount() const;
+        int getEdgeCount() const;
+        int getComponentCount() const;
+        int getMinDegree() const;
+        int getMaxDegree() const;
+        double getAverageDegree() const;
+        int getDiameter() const;
+        const vector<TerritoryId>& getArticulationPoints() const;
+        const vector<pair<TerritoryId, TerritoryId>>& getBridges() const;
+        const vector<TerritoryId>& getBorderTerritories(ContinentId continent) const;
+        const MapTopology& getUndirectedGraph() const;     // the graph the validation checks walk
+
+        // Queries
+        bool isArticulationPoint(TerritoryId id) const;
+        bool isBorder(TerritoryId id) const;
+        int getBridgeCount(TerritoryId id) const;
+        bool isBridge(TerritoryId a, TerritoryId b) const;
+};
+
+/**
+ * MapRouting answers "how many moves from A to B" and "where to move next to reach B" in O(1),
+ * following the edges in their own direction (the moves an Advance order can make)
+ * - maps up to TABLE_LIMIT territories keep exact all-pairs tables: the hop distance and the first
+ *   step of a shortest path for every pair, 2 bytes each, filled by one BFS per source on worker threads
+ * - larger maps keep, for LANDMARK_COUNT landmarks spread by farthest-point selection, the distances
+ *   to and from each landmark and its BFS tree (as preorder intervals). A distance is then the shortest
+ *   known route: through a landmark, or down a landmark's tree when the target lies below the source
+ *   (an upper bound, exact when such a route is a shortest path). A next hop is the neighbor with the
+ *   shortest known route, which is always one move shorter, so getPath() may take detours but arrives
+ */
+class MapRouting {
+    private:
+        int territoryCount;
+        vector<uint16_t>* distances;        // exact: distances[from * n + to], UNREACHABLE if none
+        vector<uint16_t>* nextHops;         // exact: first step from -> to
+        vector<TerritoryId>* landmarks;
+        vector<int>* fromLandmark;          // approximate: fromLandmark[l * n + id] = d(landmark l, id), -1 if none
+        vector<int>* toLandmark;            // approximate: toLandmark[l * n + id] = d(id, landmark l)
+        vector<int>* treeIndex;             // approximate: preorder position of id in the BFS tree of landmark l
+        vector<int>* subtreeSizes;          // approximate: size of the subtree of id in that tree
+        shared_ptr<const MapTopology> topology;     // the routed graph, for the approximate next hops
+
+        static constexpr uint16_t UNREACHABLE = 0xFFFF;
+
+        void buildTables(int threadCount);
+        void buildLandmarks(const MapTopology& reverse, int threadCount);
+
+    public:
+        // Largest map with exact tables (4 MB at the limit)
+        static constexpr int TABLE_LIMIT = 1024;
+        static constexpr int LANDMARK_COUNT = 16;
+
+        // Constructors and destructor
+        MapRouting();
+        MapRouting(shared_ptr<const MapTopology> topology, int threadCount = 0);   // 0: one thread per core
+        MapRouting(const MapRouting& other);
+        ~MapRouting();
+
+        // Assignment operator
+        MapRouting& operator=(const MapRouting& other);
+
+        // Stream insertion operator
+        friend ostream& operator<<(ostream& os, const MapRouting& routing);
+
+        // Getters
+        int getTerritoryCount() const;
+        bool isExact() const;
+        const vector<TerritoryId>& getLandmarks() const;
+
+        // Queries (-1 / NO_TERRITORY when to cannot be reached from from)
+        int getDistance(TerritoryId from, TerritoryId to) const;
+        int getDistanceLowerBound(TerritoryId from, TerritoryId to) const;     // exact with the tables
+        TerritoryId getNextHop(TerritoryId from, TerritoryId to) const;        // NO_TERRITORY when from == to
+        vector<TerritoryId> getPath(TerritoryId from, TerritoryId to) const;   // from .. to, empty if unreachable
+};
+
 /**
  * Continent class represents a connected subgraph of territories
  * Each continent has a name, bonus armies, and a collection of territories
  */
 class Continent {
+    friend class Map;
+    friend class MapArena;
+
     private:
         string* name;
         int* bonusArmies;
         vector<Territory*>* territories;
+        ContinentId id;
+        Map* map;  // Map this continent belongs to (nullptr for standalone continents)
+        // Created by Map::createContinent: the object, name, bonus and member list live in the map's arena
+        bool inArena;
+
+        Continent(const string& name, int bonus, MapArena* arena);
 
     public:
         // Constructors and destructor
         Continent();
         Continent(const string& name, int bonus);
-        Continent(const Continent& other);
+        Continent(const Continent& other);      // a standalone copy, not part of other's map
         ~Continent();//Destructor
 
         // Assignment operator
@@ -87,9 +514,10 @@ class Continent {
         friend ostream& operator<<(std::ostream& os, const Continent& continent);
 
         // Getters
-        string getName() const;
+        const string& getName() const;
         int getBonusArmies() const;
         vector<Territory*>* getTerritories() const;
+        ContinentId getId() const;
 
         // Setters
         void setName(const string& name);
@@ -97,21 +525,78 @@ class Continent {
 
         // Continent operations
         void addTerritory(Territory* territory);
+        void removeTerritory(Territory* territory);
         bool isContinentConnected() const;
     
 };
 
+/**
+ * Numbering of the territories of a loaded map
+ * File: ids follow the order of the [Territories] section
+ * Bfs: ids follow a breadth-first walk of each connected piece, so neighbors get close ids
+ * ReverseCuthillMcKee: the same walk started from a peripheral territory, visiting neighbors
+ * by increasing degree, then reversed (usually the smallest id gaps between neighbors)
+ */
+enum class TerritoryOrder { File, Bfs, ReverseCuthillMcKee };
+
 /**
  * Map class represents the complete game map as a connected graph
  * Contains territories, continents, and validation methods
  */
 class Map{
+    friend class Territory;
+    friend class Continent;
+
     private:
         vector<Territory*>* territories;
         vector<Continent*>* continents;
+        // Interned names, indexed by TerritoryId / ContinentId
+        NameTable* territoryNames;
+        NameTable* continentNames;
+        // Contents of the [Map] section
+        MapInfo* info;
         // Check if each territory is same name as continent (Prevent each territory is more than one continent)
         bool isTerritoryIsContinent = true;
 
+        // Compiled adjacency, rebuilt lazily after territories or edges are added
+        // Never modified once built, so copies of the map share it instead of duplicating it
+        mutable shared_ptr<const MapTopology> topology;
+        // Territory pointers laid out in the same order as the topology's neighbor ids
+        mutable vector<Territory*>* neighborTerritories;
+        // Edges between territories of this map that are not compiled yet
+        mutable vector<pair<TerritoryId, TerritoryId>>* pendingEdges;
+        // Edges of the compiled topology removed since it was built
+        mutable vector<pair<TerritoryId, TerritoryId>>* removedEdges;
+        mutable bool topologyDirty;
+        // Verdict of validate(): -1 unknown, 0 invalid, 1 valid (cleared by any edit)
+        mutable int cachedValidity;
+        // Territories each player owns in each continent (indexed by ContinentId); kept current by
+        // Territory::setOwner, recounted from scratch after territories or memberships change
+        mutable unordered_map<const Player*, vector<int>>* ownedPerContinent;
+        // Territories whose continent is each continent (the target of the counters above)
+        mutable vector<int>* continentSizes;
+        mutable bool ownershipDirty;
+        // Territory positions (indexed by TerritoryId) and their k-d tree, rebuilt lazily after a move
+        vector<MapPoint>* positions;
+        mutable shared_ptr<const SpatialIndex> spatialIndex;
+        // Storage of the territories and continents made by createTerritory / createContinent
+        MapArena* arena;
+        // Owner and armies of every territory, indexed by TerritoryId
+        TerritoryState* state;
+        // Chokepoints, borders and statistics of the graph, computed on first use and shared with copies
+        mutable shared_ptr<const MapAnalysis> analysis;
+        // Distances and next hops between territories, built on first use and shared with copies
+        mutable shared_ptr<const MapRouting> routing;
+        // Position of each territory in the file it was loaded from (equal to its id until the map is renumbered)
+        vector<int>* fileIndex;
+
+        void compileTopology() const;
+        void layoutNeighborTerritories() const;
+        void copyElements(const Map& other);
+        void destroyElements();
+        void countOwnership() const;
+        void updateOwnership(const Territory* territory, const Player* oldOwner, const Player* newOwner);
+
     public:
         // Constructors and destructor
         Map();
@@ -128,18 +613,64 @@ class Map{
         vector<Territory*>* getTerritories() const;
         vector<Continent*>* getContinents() const;
         bool getisTerritoryIsContinent() const;
+        const MapInfo& getInfo() const;
+        const TerritoryState& getState() const;
+        int getFileIndex(TerritoryId id) const;
 
         //Setters
         void setisTerritoryIsContinent(bool val);
+        void setInfo(const MapInfo& info);
+        void setCachedValidity(bool valid);
 
         // Map operations
-        void addTerritory(Territory* territory);
-        void addContinent(Continent* continent);
-        Territory* getTerritory(const string& name) const;
-        Continent* getContinent(const string& name) const;
+        void addTerritory(Territory* territory);        // takes ownership of a heap-allocated territory
+        void addContinent(Continent* continent);        // takes ownership of a heap-allocated continent
+        Territory* createTerritory(const string& name); // allocated in the map's arena and added to the map
+        Continent* createContinent(const string& name, int bonus);
+        const MapArena* getArena() const;
+        Territory* getTerritory(string_view name) const;
+        Territory* getTerritory(TerritoryId id) const;
+        Continent* getContinent(string_view name) const;
+        Continent* getContinent(ContinentId id) const;
+        TerritoryId findTerritoryId(string_view name) const;
+        ContinentId findContinentId(string_view name) const;
+        string_view getTerritoryName(TerritoryId id) const;
+        string_view getContinentName(ContinentId id) const;
+
+        // Topology operations
+        void addAdjacency(TerritoryId from, TerritoryId to);
+        void removeAdjacency(TerritoryId from, TerritoryId to);
+        void reserveAdjacencies(int count);
+        void reserveTerritories(int count);
+        void setTopology(MapTopology* compiled);   // takes ownership, replaces all edges
+        const MapTopology* getTopology() const;
+        span<Territory* const> getNeighbors(TerritoryId id) const;
+        void invalidateTopology();
+        vector<TerritoryId> computeTerritoryOrder(TerritoryOrder order) const;  // order[newId] = current id
+        void renumberTerritories(const vector<TerritoryId>& order);             // names and file indices move with the territories
+        const MapAnalysis* getAnalysis() const;
+        const MapRouting* getRouting() const;
+
+        // Geometry operations
+        MapPoint getTerritoryPosition(TerritoryId id) const;
+        void setTerritoryPosition(TerritoryId id, MapPoint position);
+        const SpatialIndex* getSpatialIndex() const;
+        Territory* findTerritoryAt(int x, int y) const;     // territory drawn closest to (x, y), nullptr on an empty map
+        void invalidateValidation();
+
+        // Ownership queries (answered from the per-continent counters)
+        int getOwnedTerritoryCount(const Player* player, ContinentId continent) const;
+        bool ownsContinent(const Player* player, ContinentId continent) const;
+        int getContinentBonus(const Player* player) const;
+        void invalidateOwnership();
+
+        // Neighbor queries on the ownership bitsets (results sorted by TerritoryId)
+        vector<TerritoryId> findEnemyNeighbors(const Player* player, TerritoryId source) const;  // neighbors of source the player does not own
+        vector<TerritoryId> findEnemyFrontier(const Player* player) const;                       // same, for every territory the player owns
 
         // Validation methods
         bool validate() const;
+        ValidationReport getValidationReport() const;
         bool isConnectedGraph() const; 
         bool areContinentsConnected() const;
         bool isEachTerritoryInOneContinent() const;
@@ -149,6 +680,60 @@ class Map{
 
 };
 
+/**
+ * Outcome of checking one file in a batch (see MapLoader::validateMapFiles)
+ * Printed as a single key=value line so batch runs can be grepped and diffed
+ */
+struct MapCheckResult {
+    string fileName;
+    bool loaded = false;
+    bool valid = false;
+    int territoryCount = 0;
+    int continentCount = 0;
+    int edgeCount = 0;
+    double loadMs = 0;
+    double validateMs = 0;
+    string reasons;     // why the map failed to load or validate, empty when it is valid
+
+    friend ostream& operator<<(ostream& os, const MapCheckResult& result);
+};
+
+/**
+ * Parsing strategy of MapLoader
+ * Stream: reads line by line with getline and echoes the [Map] section to the console
+ * Mapped: memory-maps the file and tokenizes it in place with string_view, silently
+ * Parallel: same parser, with the territory lines split into chunks of whole lines that worker
+ *   threads parse and resolve; builds the same map as Mapped (one thread per MB of file at most)
+ */
+enum class MapLoadMode { Stream, Mapped, Parallel };
+
+/**
+ * Precompiled binary map image (.wzmap)
+ * Layout: header, territory table, CSR offsets, CSR neighbor ids, continent table,
+ * continent member ranges, [Map] properties, then one blob with every name
+ * The header keeps the FNV-1a hash of the source .map file and the validation verdict,
+ * so an image whose hash matches its source is loaded without parsing or validating
+ */
+const char WZMAP_MAGIC[4] = {'W', 'Z', 'M', 'P'};
+const uint32_t WZMAP_VERSION = 2;     // 2: territory positions
+const string WZMAP_EXTENSION = ".wzmap";
+
+struct WzMapHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceHash;
+    uint32_t flags;             // WZMAP_VALID | WZMAP_NO_CONTINENT_NEIGHBOR
+    uint32_t territoryCount;
+    uint32_t continentCount;
+    uint32_t edgeCount;
+    uint32_t memberCount;
+    uint32_t propertyCount;
+    uint32_t stringBytes;
+    uint32_t reserved;
+};
+const uint32_t WZMAP_VALID = 1;
+const uint32_t WZMAP_NO_CONTINENT_NEIGHBOR = 2;  // Map::getisTerritoryIsContinent()
+
 /**
  * MapLoader class handles loading map files and creating Map objects as graph data structure. 
  * Can read Conquest format .map files and validate them
@@ -158,10 +743,24 @@ class Map{
 class MapLoader{
     private:
         string* fileName;
+        MapLoadMode mode;
+        TerritoryOrder territoryOrder;
 
         // Helper methods for parsing
         vector<string> split(const string& str, char delimiter) const;
         string trim(const string& str) const;
+        bool useBinaryCache;
+        bool useBundledMaps;
+        int threadCount;
+        // Error messages (and the stream loader's echo of the [Map] section) are written here, cout by default
+        ostream* messages;
+
+        Map* parseMapFile(const string& fileName) const;
+        Map* loadMapStream(const string& fileName) const;
+        Map* loadMapMapped(const string& fileName) const;
+        Map* loadMapParallel(const string& fileName) const;
+        Map* loadMapCached(const string& fileName) const;
+        Map* loadPatchedMap(const string& fileName) const;
 
     public:
         // Constructors and destructor
@@ -178,14 +777,48 @@ class MapLoader{
 
         // Getters
         string getFileName() const;
+        MapLoadMode getLoadMode() const;
+        TerritoryOrder getTerritoryOrder() const;
+        bool getUseBinaryCache() const;
+        bool getUseBundledMaps() const;
+        int getThreadCount() const;
+        ostream* getMessageStream() const;
 
         // Setters
         void setFileName(const string& fileName);
+        void setLoadMode(MapLoadMode mode);
+        void setTerritoryOrder(TerritoryOrder order);   // renumbering applied after every load (binary images keep file order)
+        void setUseBinaryCache(bool enabled);   // load X.map through a sibling X.wzmap image, rebuilding it when stale
+        void setUseBundledMaps(bool enabled);   // load the maps linked into the program from memory instead of their files
+        void setThreadCount(int count);         // threads of the Parallel mode, 0 (default): one per core
+        void setMessageStream(ostream* stream);  // nullptr restores cout
 
         // Map loading operations
         Map* loadMap() const;
         Map* loadMap(const string& fileName) const;
         bool isValidMapFile(const string& fileName) const;
+
+        // Batch validation
+        MapCheckResult checkMapFile(const string& fileName) const;
+        vector<MapCheckResult> validateMapFiles(const vector<string>& fileNames, int threadCount = 0) const;
+        static vector<string> findMapFiles(const string& directoryOrGlob);
+
+        // Binary map images
+        bool compileMap(const string& mapFile, const string& imageFile) const;
+        bool writeBinaryMap(const Map& map, uint64_t sourceHash, const string& imageFile) const;
+        string buildBinaryImage(const Map& map, uint64_t sourceHash) const;
+        Map* loadBinaryMap(const string& imageFile, uint64_t expectedHash = 0) const;
+        Map* loadBinaryImage(string_view image, const string& imageName, uint64_t expectedHash = 0) const;
+        static uint64_t hashFile(const string& fileName);
+        static string imageFileFor(const string& mapFile);
+
+        // Bundled maps: images compiled into the program by map-embed (see BundledMaps.cpp in the build directory)
+        static bool addBundledMap(const string& mapFile, string_view image);   // the image must outlive the program
+        static const string_view* findBundledMap(const string& mapFile);      // nullptr if mapFile is not bundled
+        static vector<string> getBundledMapNames();
+
+        // Map variants (.wzpatch, see MapPatch): each base map is loaded once and kept for the next variants
+        static void clearPatchBases();
 };
 
 #endif
\ No newline at end of file
@@ -1,9 +1,14 @@
 // MapDriver.cpp
 #include "MapDriver.h" 
+#include "MapEditor.h"
+#include "MapPatch.h"
 #include <iostream>
 #include <vector>
 #include <string>
 #include <fstream>  
+#include <chrono>
+#include <random>
+#include <climits>
 
 using namespace std;
 
@@ -37,10 +42,11 @@ void testLoadMaps() {
             cout << "Result: Successfully loaded map from \"" << filename << "\"" << endl;
 
             // Run validation tests
-            bool isConnected = loadedMap->isConnectedGraph();
-            bool continentsConnected = loadedMap->areContinentsConnected();
-            bool eachInOneContinent = loadedMap->isEachTerritoryInOneContinent();
-            bool isValid = loadedMap->validate();
+            ValidationReport report = loadedMap->getValidationReport();
+            bool isConnected = report.isConnected();
+            bool continentsConnected = report.areContinentsConnected();
+            bool eachInOneContinent = report.isEachTerritoryInOneContinent();
+            bool isValid = report.isValid();
 
             cout << "\nValidation Results:" << endl;
             cout << "  1. Map is fully connected: " << (isConnected ? "PASS" : "FAIL") << endl;
@@ -48,10 +54,42 @@ void testLoadMaps() {
             cout << "  3. Each territory is in one continent: " << (eachInOneContinent ? "PASS" : "FAIL") << endl;
             cout << "  => Overall Map Validation: " << (isValid ? "VALID MAP" : "INVALID MAP") << endl;
 
+            if (!isValid) {
+                cout << "\nProblems:" << endl;
+                report.print(cout, *loadedMap);
+            }
+
             if (isValid) {
                 cout << "\nMap Details:" << endl;
                 cout << "  - Territories: " << loadedMap->getTerritories()->size() << endl;
                 cout << "  - Continents: " << loadedMap->getContinents()->size() << endl;
+
+                // Structure of the graph: chokepoints, borders and statistics
+                const MapAnalysis* analysis = loadedMap->getAnalysis();
+                cout << "  - Structure: " << *analysis << endl;
+                for (Continent* continent : *loadedMap->getContinents()) {
+                    cout << "  - " << continent->getName() << ": "
+                         << analysis->getBorderTerritories(continent->getId()).size() << " of "
+                         << continent->getTerritories()->size() << " territories on its border" << endl;
+                }
+                for (TerritoryId id : analysis->getArticulationPoints()) {
+                    cout << "  - Chokepoint: " << loadedMap->getTerritoryName(id) << endl;
+                }
+
+                // Routing: the territory farthest from the first one, and the route to it
+                const MapRouting* routing = loadedMap->getRouting();
+                TerritoryId from = 0;
+                TerritoryId to = 0;
+                for (TerritoryId id = 0; id < routing->getTerritoryCount(); id++) {
+                    if (routing->getDistance(from, id) > routing->getDistance(from, to)) to = id;
+                }
+                cout << "  - Routing: " << *routing << endl;
+                cout << "  - Farthest from " << loadedMap->getTerritoryName(from) << ": "
+                     << loadedMap->getTerritoryName(to) << ", " << routing->getDistance(from, to) << " move(s) via";
+                for (TerritoryId step : routing->getPath(from, to)) {
+                    cout << " " << loadedMap->getTerritoryName(step);
+                }
+                cout << endl;
             }
 
             delete loadedMap;
@@ -65,4 +103,310 @@ void testLoadMaps() {
     cout << "========== Map Testing Complete ==========\n" << endl;
 }
 
+/**
+ * Driver function for batch validation: checks every map of a directory or glob
+ * on a thread pool and prints one report line per map
+ */
+void testBatchValidation() {
+    cout << "\n========== Batch Map Validation ==========\n" << endl;
+
+    string target;
+    cout << "Directory or glob of .map files (e.g. maps/ or *.map): " << endl;
+    cin >> target;
+    int threads;
+    cout << "Worker threads (0 uses every core): " << endl;
+    cin >> threads;
+
+    vector<string> files = MapLoader::findMapFiles(target);
+    if (files.empty()) {
+        cout << "No map files match " << target << endl;
+        return;
+    }
+
+    MapLoader loader;
+    auto start = chrono::steady_clock::now();
+    vector<MapCheckResult> results = loader.validateMapFiles(files, threads);
+    double totalMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    int valid = 0, invalid = 0, unreadable = 0;
+    for (const MapCheckResult& result : results) {
+        cout << result << endl;
+        if (!result.loaded) unreadable++;
+        else if (result.valid) valid++;
+        else invalid++;
+    }
+    cout << "\n" << results.size() << " maps: " << valid << " valid, " << invalid << " invalid, "
+         << unreadable << " unreadable in " << totalMs << " ms" << endl;
+}
+
+/**
+ * Driver function for the spatial index of a map: runs random nearest, radius and box queries
+ * (plus hit-testing every territory's own position) and compares each answer with a scan of all
+ * the territory positions
+ */
+void testSpatialIndex() {
+    cout << "\n========== Spatial Index Queries ==========\n" << endl;
+
+    string file;
+    cout << "Map file to query: " << endl;
+    cin >> file;
+
+    MapLoader loader;
+    loader.setLoadMode(MapLoadMode::Mapped);
+    Map* map = loader.loadMap(file);
+    if (map == nullptr || map->getTerritories()->empty()) {
+        cout << "Cannot query " << file << endl;
+        delete map;
+        return;
+    }
+
+    auto start = chrono::steady_clock::now();
+    const SpatialIndex* index = map->getSpatialIndex();
+    double buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << *index << " (built in " << buildMs << " ms)" << endl;
+
+    int count = static_cast<int>(map->getTerritories()->size());
+    int minX = INT_MAX, minY = INT_MAX, maxX = INT_MIN, maxY = INT_MIN;
+    for (TerritoryId id = 0; id < count; id++) {
+        MapPoint position = map->getTerritoryPosition(id);
+        minX = min(minX, position.x);
+        maxX = max(maxX, position.x);
+        minY = min(minY, position.y);
+        maxY = max(maxY, position.y);
+    }
+    auto squared = [](int64_t dx, int64_t dy) { return dx * dx + dy * dy; };
+
+    // Answers of a scan over every position, in the same order as the index (sorted by id, ties to the lowest id)
+    auto scanNearest = [&](int x, int y) {
+        TerritoryId best = NO_TERRITORY;
+        int64_t bestDistance = INT64_MAX;
+        for (TerritoryId id = 0; id < count; id++) {
+            MapPoint position = map->getTerritoryPosition(id);
+            int64_t distance = squared(static_cast<int64_t>(position.x) - x, static_cast<int64_t>(position.y) - y);
+            if (distance < bestDistance) {
+                best = id;
+                bestDistance = distance;
+            }
+        }
+        return best;
+    };
+    auto scanRadius = [&](int x, int y, int radius) {
+        vector<TerritoryId> found;
+        for (TerritoryId id = 0; id < count && radius >= 0; id++) {
+            MapPoint position = map->getTerritoryPosition(id);
+            if (squared(static_cast<int64_t>(position.x) - x, static_cast<int64_t>(position.y) - y) <= static_cast<int64_t>(radius) * radius) {
+                found.push_back(id);
+            }
+        }
+        return found;
+    };
+    auto scanBox = [&](int lowX, int lowY, int highX, int highY) {
+        vector<TerritoryId> found;
+        for (TerritoryId id = 0; id < count; id++) {
+            MapPoint position = map->getTerritoryPosition(id);
+            if (position.x >= lowX && position.x <= highX && position.y >= lowY && position.y <= highY) {
+                found.push_back(id);
+            }
+        }
+        return found;
+    };
+
+    int mismatches = 0;
+    int hits = 0;
+    for (TerritoryId id = 0; id < count; id++) {
+        MapPoint position = map->getTerritoryPosition(id);
+        Territory* hit = map->findTerritoryAt(position.x, position.y);
+        hits += (hit != nullptr && hit->getPosition().x == position.x && hit->getPosition().y == position.y);
+    }
+    cout << "Hit-testing the position of each territory: " << hits << " / " << count << " found"
+         << (hits == count ? "" : "  MISMATCH") << endl;
+    mismatches += count - hits;
+
+    // Queries around the map (and a little outside it); the same seed gives the same queries
+    mt19937 random(2024);
+    int spanX = max(1, maxX - minX), spanY = max(1, maxY - minY);
+    uniform_int_distribution<int> pickX(minX - spanX / 4, maxX + spanX / 4);
+    uniform_int_distribution<int> pickY(minY - spanY / 4, maxY + spanY / 4);
+    uniform_int_distribution<int> pickRadius(0, max(spanX, spanY) / 4);
+    const int queries = 1000;
+    int queryMismatches = 0;
+    double indexMs = 0, scanMs = 0;
+    for (int q = 0; q < queries; q++) {
+        int x = pickX(random), y = pickY(random), radius = pickRadius(random);
+        int x2 = x + pickRadius(random), y2 = y + pickRadius(random);
+
+        auto indexStart = chrono::steady_clock::now();
+        TerritoryId nearest = index->findNearest(x, y);
+        vector<TerritoryId> inRadius = index->findInRadius(x, y, radius);
+        vector<TerritoryId> inBox = index->findInBox(x, y, x2, y2);
+        auto scanStart = chrono::steady_clock::now();
+        bool same = nearest == scanNearest(x, y) && inRadius == scanRadius(x, y, radius) && inBox == scanBox(x, y, x2, y2);
+        auto end = chrono::steady_clock::now();
+        indexMs += chrono::duration<double, milli>(scanStart - indexStart).count();
+        scanMs += chrono::duration<double, milli>(end - scanStart).count();
+        queryMismatches += !same;
+    }
+    cout << queries << " random nearest/radius/box queries: " << queryMismatches << " mismatches, index "
+         << indexMs << " ms, scan " << scanMs << " ms" << endl;
+    mismatches += queryMismatches;
+
+    // Extreme radii: the box around the circle does not fit in an int
+    for (int radius : {INT_MAX, INT_MAX / 2 + 1, -1}) {
+        bool same = index->findInRadius(minX, maxY, radius) == scanRadius(minX, maxY, radius);
+        cout << "Radius " << radius << ": " << (same ? "matches the scan" : "MISMATCH") << endl;
+        mismatches += !same;
+    }
 
+    cout << (mismatches == 0 ? "All queries match the scan" : "Some queries do not match the scan") << endl;
+    delete map;
+}
+
+/**
+ * Driver function for the incremental validation of MapEditor: applies a few typical designer
+ * edits to a map and shows that the editor's verdict after each one matches a full Map::validate()
+ */
+void testMapEditor() {
+    cout << "\n========== Map Editor Revalidation ==========\n" << endl;
+
+    string file;
+    cout << "Map file to edit: " << endl;
+    cin >> file;
+
+    MapLoader loader;
+    loader.setLoadMode(MapLoadMode::Mapped);
+    Map* map = loader.loadMap(file);
+    if (map == nullptr || map->getTerritories()->empty() || map->getContinents()->empty()) {
+        cout << "Cannot edit " << file << endl;
+        delete map;
+        return;
+    }
+
+    auto start = chrono::steady_clock::now();
+    MapEditor editor(map);
+    double setupMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << editor << " (set up in " << setupMs << " ms)" << endl;
+
+    // Each step runs one edit, then compares the editor's verdict with a full validation of a copy
+    auto check = [&editor](const string& edit, auto action) {
+        auto editStart = chrono::steady_clock::now();
+        action();
+        bool valid = editor.isValid();
+        double editMs = chrono::duration<double, milli>(chrono::steady_clock::now() - editStart).count();
+
+        Map copy(*editor.getMap());
+        copy.invalidateValidation();
+        auto fullStart = chrono::steady_clock::now();
+        bool fullValid = copy.getValidationReport().isValid();
+        double fullMs = chrono::duration<double, milli>(chrono::steady_clock::now() - fullStart).count();
+
+        cout << edit << ": " << (valid ? "valid" : "invalid") << " in " << editMs << " ms, full validation "
+             << (fullValid ? "valid" : "invalid") << " in " << fullMs << " ms"
+             << (valid == fullValid ? "" : "  MISMATCH") << endl;
+    };
+
+    Territory* first = map->getTerritory(0);
+    span<Territory* const> adjacent = first->getAdjacentTerritories();
+    TerritoryId neighbor = adjacent.empty() ? NO_TERRITORY : adjacent.front()->getId();
+    ContinentId home = first->getContinent() != nullptr ? first->getContinent()->getId() : 0;
+    ContinentId other = (home + 1) % static_cast<ContinentId>(map->getContinents()->size());
+
+    if (neighbor != NO_TERRITORY) {
+        check("Remove edge " + first->getName() + " - " + map->getTerritory(neighbor)->getName(),
+              [&]() { editor.removeEdge(0, neighbor); });
+        check("Restore that edge", [&]() { editor.addEdge(0, neighbor); });
+    }
+    check("Move " + first->getName() + " to " + map->getContinent(other)->getName(),
+          [&]() { editor.moveTerritory(0, other); });
+    check("Move it back", [&]() { editor.moveTerritory(0, home); });
+    Territory* added = nullptr;
+    check("Add territory Outpost", [&]() { added = editor.addTerritory("Outpost", home, first->getPosition()); });
+    check("Link Outpost to " + first->getName(), [&]() { editor.addEdge(added->getId(), 0); });
+
+    cout << editor << endl;
+    delete map;
+}
+
+/**
+ * Driver function for map patches: applies add, remove, bonus and rename patches to Earth.map
+ * (then a patch file through the loader) and compares each variant's verdict, carried over from
+ * the base, with a full validation of a copy
+ */
+void testMapPatch() {
+    cout << "\n========== Map Patches ==========\n" << endl;
+
+    MapLoader loader;
+    Map* base = loader.loadMap("Earth.map");
+    if (base == nullptr || !base->validate()) {
+        cout << "Cannot patch Earth.map" << endl;
+        delete base;
+        return;
+    }
+
+    // Compares the variant's verdict with a full validation of a copy, then drops the variant
+    auto check = [](const string& label, Map* variant, double applyMs) {
+        if (variant == nullptr) {
+            cout << label << ": not applied" << endl;
+            return;
+        }
+        bool valid = variant->validate();
+
+        Map copy(*variant);
+        copy.invalidateValidation();
+        auto fullStart = chrono::steady_clock::now();
+        bool fullValid = copy.getValidationReport().isValid();
+        double fullMs = chrono::duration<double, milli>(chrono::steady_clock::now() - fullStart).count();
+
+        cout << label << ": " << (valid ? "valid" : "invalid") << " in " << applyMs << " ms, full validation "
+             << (fullValid ? "valid" : "invalid") << " in " << fullMs << " ms"
+             << (valid == fullValid ? "" : "  MISMATCH") << endl;
+        delete variant;
+    };
+    auto apply = [&](const string& label, MapPatch patch) {
+        patch.setBaseFile("Earth.map");
+        auto start = chrono::steady_clock::now();
+        Map* variant = patch.apply(*base, cout);
+        double applyMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        check(label, variant, applyMs);
+    };
+
+    MapPatch add;
+    add.addEdge("AN", "AY");
+    apply("Add edge AN - AY", add);
+
+    MapPatch remove;
+    remove.removeEdge("AB", "AF");
+    apply("Remove edge AB - AF", remove);
+
+    MapPatch split;
+    split.removeEdge("AA", "AB");
+    apply("Remove edge AA - AB (splits North America)", split);
+
+    MapPatch isolate;
+    isolate.removeEdge("AW", "AT");
+    isolate.removeEdge("AW", "AX");
+    apply("Remove every edge of AW", isolate);
+
+    MapPatch bonus;
+    bonus.setBonus("South America", 4);
+    bonus.setBonus("Australia", 2);
+    apply("Set bonuses of South America and Australia", bonus);
+
+    MapPatch rename;
+    rename.rename("AA", "Alaska");
+    rename.rename("North America", "Northern America");
+    apply("Rename AA and North America", rename);
+
+    MapPatch unknown;
+    unknown.rename("Atlantis", "Lemuria");
+    apply("Rename a territory that does not exist", unknown);
+
+    string file;
+    cout << "Patch file to load: " << endl;
+    cin >> file;
+    auto start = chrono::steady_clock::now();
+    Map* variant = loader.loadMap(file);
+    double loadMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    check("Load " + file, variant, loadMs);
+
+    delete base;
+}
@@ -7,5 +7,9 @@
 using namespace std;
 
 void testLoadMaps();
+void testBatchValidation();
+void testSpatialIndex();
+void testMapEditor();
+void testMapPatch();
 
 #endif
\ No newline at end of file
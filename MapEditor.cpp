@@ -0,0 +1,517 @@
+// MapEditor.cpp
+#include "MapEditor.h"
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+// ==================== MapEditor Implementation ====================
+
+// Constructors and destructor (MapEditor)
+MapEditor::MapEditor(Map* editedMap) {
+    map = editedMap;
+    const MapTopology* topology = map->getTopology();
+    int count = topology->getTerritoryCount();
+    int continentCount = static_cast<int>(map->getContinents()->size());
+
+    // Adjacency without direction or repeats: validation treats every edge as two-way
+    neighbors = new vector<vector<TerritoryId>>(count);
+    for (TerritoryId id = 0; id < count; id++) {
+        for (TerritoryId neighbor : topology->getNeighbors(id)) {
+            (*neighbors)[id].push_back(neighbor);
+            (*neighbors)[neighbor].push_back(id);
+        }
+    }
+    for (vector<TerritoryId>& row : *neighbors) {
+        sort(row.begin(), row.end());
+        row.erase(unique(row.begin(), row.end()), row.end());
+    }
+
+    // Membership: like Map::getValidationReport, the first continent listing a territory is its home
+    home = new vector<ContinentId>(count, NO_CONTINENT);
+    listings = new vector<int>(count, 0);
+    for (Continent* continent : *map->getContinents()) {
+        for (Territory* territory : *continent->getTerritories()) {
+            TerritoryId id = territory->getId();
+            if (territory->getMap() != map || id < 0 || id >= count) continue;
+            (*listings)[id]++;
+            if ((*home)[id] == NO_CONTINENT) (*home)[id] = continent->getId();
+        }
+    }
+    orphanCount = 0;
+    duplicateCount = 0;
+    for (int listed : *listings) {
+        if (listed == 0) orphanCount++;
+        if (listed > 1) duplicateCount++;
+    }
+    continentAsNeighbor = !map->getisTerritoryIsContinent();
+
+    componentOf = new vector<int>(count, -1);
+    componentSizes = new vector<int>();
+    componentCount = 0;
+    pieceOf = new vector<int>(count, -1);
+    pieceSizes = new vector<int>();
+    continentPieces = new vector<int>(continentCount, 0);
+    splitContinentCount = 0;
+    visitStamp = new vector<uint32_t>(count, 0);
+    searchStamp = 0;
+    labelAll();
+}
+
+MapEditor::MapEditor(const MapEditor& other) {
+    map = other.map;
+    neighbors = new vector<vector<TerritoryId>>(*other.neighbors);
+    home = new vector<ContinentId>(*other.home);
+    listings = new vector<int>(*other.listings);
+    componentOf = new vector<int>(*other.componentOf);
+    componentSizes = new vector<int>(*other.componentSizes);
+    componentCount = other.componentCount;
+    pieceOf = new vector<int>(*other.pieceOf);
+    pieceSizes = new vector<int>(*other.pieceSizes);
+    continentPieces = new vector<int>(*other.continentPieces);
+    splitContinentCount = other.splitContinentCount;
+    orphanCount = other.orphanCount;
+    duplicateCount = other.duplicateCount;
+    continentAsNeighbor = other.continentAsNeighbor;
+    visitStamp = new vector<uint32_t>(other.visitStamp->size(), 0);
+    searchStamp = 0;
+}
+
+MapEditor::~MapEditor() {
+    delete neighbors;
+    delete home;
+    delete listings;
+    delete componentOf;
+    delete componentSizes;
+    delete pieceOf;
+    delete pieceSizes;
+    delete continentPieces;
+    delete visitStamp;
+    neighbors = nullptr;
+    home = nullptr;
+    listings = nullptr;
+    componentOf = nullptr;
+    componentSizes = nullptr;
+    pieceOf = nullptr;
+    pieceSizes = nullptr;
+    continentPieces = nullptr;
+    visitStamp = nullptr;
+}
+
+// Assignment operator (MapEditor)
+MapEditor& MapEditor::operator=(const MapEditor& other) {
+    if (this != &other) {
+        map = other.map;
+        *neighbors = *other.neighbors;
+        *home = *other.home;
+        *listings = *other.listings;
+        *componentOf = *other.componentOf;
+        *componentSizes = *other.componentSizes;
+        componentCount = other.componentCount;
+        *pieceOf = *other.pieceOf;
+        *pieceSizes = *other.pieceSizes;
+        *continentPieces = *other.continentPieces;
+        splitContinentCount = other.splitContinentCount;
+        orphanCount = other.orphanCount;
+        duplicateCount = other.duplicateCount;
+        continentAsNeighbor = other.continentAsNeighbor;
+        visitStamp->assign(other.visitStamp->size(), 0);
+        searchStamp = 0;
+    }
+    return *this;
+}
+
+// Stream insertion operator (MapEditor)
+ostream& operator<<(ostream& os, const MapEditor& editor) {
+    os << "MapEditor: " << editor.neighbors->size() << " territories, "
+       << editor.componentCount << " components, "
+       << editor.splitContinentCount << " split continents, "
+       << editor.orphanCount << " orphans, "
+       << editor.duplicateCount << " duplicates -> "
+       << (editor.isConnected() && editor.areContinentsConnected() && editor.isEachTerritoryInOneContinent() ? "valid" : "invalid");
+    return os;
+}
+
+// Getters (MapEditor)
+Map* MapEditor::getMap() const {
+    return map;
+}
+
+int MapEditor::getComponentCount() const {
+    return componentCount;
+}
+
+int MapEditor::getSplitContinentCount() const {
+    return splitContinentCount;
+}
+
+int MapEditor::getOrphanCount() const {
+    return orphanCount;
+}
+
+int MapEditor::getDuplicateCount() const {
+    return duplicateCount;
+}
+
+// Reserves count fresh stamps (one per search side) and returns the first one
+uint32_t MapEditor::nextStamps(uint32_t count) {
+    if (searchStamp > UINT_MAX - count) {
+        fill(visitStamp->begin(), visitStamp->end(), 0);
+        searchStamp = 0;
+    }
+    uint32_t first = searchStamp + 1;
+    searchStamp += count;
+    return first;
+}
+
+// Moves the whole set of start (the territories reachable from it with the same label) to label to
+int MapEditor::relabel(TerritoryId start, vector<int>& labelOf, vector<int>& sizes, int to) {
+    int from = labelOf[start];
+    vector<TerritoryId> queue(1, start);
+    labelOf[start] = to;
+    for (size_t head = 0; head < queue.size(); head++) {
+        for (TerritoryId neighbor : (*neighbors)[queue[head]]) {
+            if (labelOf[neighbor] == from) {
+                labelOf[neighbor] = to;
+                queue.push_back(neighbor);
+            }
+        }
+    }
+    int moved = static_cast<int>(queue.size());
+    if (from >= 0) sizes[from] -= moved;
+    sizes[to] += moved;
+    return moved;
+}
+
+// Union by size: the smaller set takes the label of the larger one
+bool MapEditor::mergeSets(TerritoryId a, TerritoryId b, vector<int>& labelOf, vector<int>& sizes) {
+    int labelA = labelOf[a];
+    int labelB = labelOf[b];
+    if (labelA == labelB) return false;
+    if (sizes[labelA] < sizes[labelB]) {
+        relabel(a, labelOf, sizes, labelB);
+    } else {
+        relabel(b, labelOf, sizes, labelA);
+    }
+    return true;
+}
+
+// Called after the edge a-b was removed from a set (of the map, or of continent within).
+// Bidirectional search from both ends: the smaller side grows one territory at a time, so it
+// stops after a few steps around the local cycle when a and b are still connected, and after
+// about twice the smaller piece when the edge was a bridge; that piece then gets a new label
+bool MapEditor::splitSets(TerritoryId a, TerritoryId b, ContinentId within, vector<int>& labelOf, vector<int>& sizes) {
+    uint32_t stampA = nextStamps();
+    uint32_t stampB = stampA + 1;
+    vector<TerritoryId> queueA(1, a);
+    vector<TerritoryId> queueB(1, b);
+    size_t headA = 0;
+    size_t headB = 0;
+    (*visitStamp)[a] = stampA;
+    (*visitStamp)[b] = stampB;
+
+    while (headA < queueA.size() && headB < queueB.size()) {
+        bool growA = queueA.size() <= queueB.size();
+        vector<TerritoryId>& queue = growA ? queueA : queueB;
+        size_t& head = growA ? headA : headB;
+        uint32_t own = growA ? stampA : stampB;
+        uint32_t opposite = growA ? stampB : stampA;
+
+        TerritoryId current = queue[head++];
+        for (TerritoryId neighbor : (*neighbors)[current]) {
+            if (within != NO_CONTINENT && (*home)[neighbor] != within) continue;
+            if ((*visitStamp)[neighbor] == opposite) return false;
+            if ((*visitStamp)[neighbor] != own) {
+                (*visitStamp)[neighbor] = own;
+                queue.push_back(neighbor);
+            }
+        }
+    }
+
+    // The side whose queue ran out holds its whole piece
+    vector<TerritoryId>& piece = (headA == queueA.size()) ? queueA : queueB;
+    int label = static_cast<int>(sizes.size());
+    sizes.push_back(static_cast<int>(piece.size()));
+    sizes[labelOf[piece.front()]] -= static_cast<int>(piece.size());
+    for (TerritoryId id : piece) {
+        labelOf[id] = label;
+    }
+    return true;
+}
+
+// Initial labels: one breadth-first sweep per component and per continent piece
+void MapEditor::labelAll() {
+    for (TerritoryId id = 0; id < static_cast<TerritoryId>(neighbors->size()); id++) {
+        if ((*componentOf)[id] < 0) {
+            componentSizes->push_back(0);
+            relabel(id, *componentOf, *componentSizes, static_cast<int>(componentSizes->size()) - 1);
+            componentCount++;
+        }
+        ContinentId continent = (*home)[id];
+        if (continent != NO_CONTINENT && (*pieceOf)[id] < 0) {
+            // relabel follows label -1 across borders, so this sweep checks the continent itself
+            vector<TerritoryId> queue(1, id);
+            int label = static_cast<int>(pieceSizes->size());
+            (*pieceOf)[id] = label;
+            for (size_t head = 0; head < queue.size(); head++) {
+                for (TerritoryId neighbor : (*neighbors)[queue[head]]) {
+                    if ((*home)[neighbor] == continent && (*pieceOf)[neighbor] < 0) {
+                        (*pieceOf)[neighbor] = label;
+                        queue.push_back(neighbor);
+                    }
+                }
+            }
+            pieceSizes->push_back(static_cast<int>(queue.size()));
+            setPieces(continent, (*continentPieces)[continent] + 1);
+        }
+    }
+}
+
+void MapEditor::setPieces(ContinentId continent, int pieces) {
+    int& current = (*continentPieces)[continent];
+    splitContinentCount += (pieces > 1) - (current > 1);
+    current = pieces;
+}
+
+void MapEditor::setListings(TerritoryId id, int count) {
+    int& current = (*listings)[id];
+    orphanCount += (count == 0) - (current == 0);
+    duplicateCount += (count > 1) - (current > 1);
+    current = count;
+}
+
+// Only needed when a territory listed twice loses one of its listings
+ContinentId MapEditor::findFirstListing(TerritoryId id) const {
+    Territory* territory = map->getTerritory(id);
+    for (Continent* continent : *map->getContinents()) {
+        const vector<Territory*>& listed = *continent->getTerritories();
+        if (find(listed.begin(), listed.end(), territory) != listed.end()) {
+            return continent->getId();
+        }
+    }
+    return NO_CONTINENT;
+}
+
+// The piece the territory leaves falls apart into one piece per group of its neighbors that are
+// still connected without it. As in splitSets, one search per neighbor grows the smallest first;
+// searches that meet belong to the same group, a group whose searches all ran out holds its whole
+// piece and gets a new label, and the searches stop when a single group is still running: that one
+// keeps the old label without being walked to the end
+void MapEditor::leaveContinent(TerritoryId id, ContinentId continent) {
+    int label = (*pieceOf)[id];
+    (*pieceSizes)[label]--;
+    (*pieceOf)[id] = -1;
+    (*home)[id] = NO_CONTINENT;
+
+    vector<TerritoryId> starts;
+    for (TerritoryId neighbor : (*neighbors)[id]) {
+        if ((*home)[neighbor] == continent && (*pieceOf)[neighbor] == label) {
+            starts.push_back(neighbor);
+        }
+    }
+    int searches = static_cast<int>(starts.size());
+    if (searches <= 1) {
+        // Nothing splits: the piece is still whole, or it was only this territory
+        setPieces(continent, (*continentPieces)[continent] - 1 + searches);
+        return;
+    }
+
+    uint32_t firstStamp = nextStamps(static_cast<uint32_t>(searches));
+    vector<vector<TerritoryId>> queues(searches);
+    vector<size_t> heads(searches, 0);
+    vector<int> group(searches);        // union-find over the searches that met
+    vector<int> running(searches, 1);   // searches of each group that have not run out
+    for (int i = 0; i < searches; i++) {
+        queues[i].push_back(starts[i]);
+        (*visitStamp)[starts[i]] = firstStamp + i;
+        group[i] = i;
+    }
+    auto findGroup = [&group](int i) {
+        while (group[i] != i) {
+            group[i] = group[group[i]];
+            i = group[i];
+        }
+        return i;
+    };
+
+    int runningGroups = searches;
+    while (runningGroups > 1) {
+        int grow = -1;
+        for (int i = 0; i < searches; i++) {
+            if (heads[i] < queues[i].size() && (grow < 0 || queues[i].size() < queues[grow].size())) {
+                grow = i;
+            }
+        }
+        TerritoryId current = queues[grow][heads[grow]++];
+        for (TerritoryId neighbor : (*neighbors)[current]) {
+            if ((*home)[neighbor] != continent) continue;
+            uint32_t stamp = (*visitStamp)[neighbor];
+            if (stamp >= firstStamp && stamp - firstStamp < static_cast<uint32_t>(searches)) {
+                int mine = findGroup(grow);
+                int theirs = findGroup(static_cast<int>(stamp - firstStamp));
+                if (mine != theirs) {
+                    group[theirs] = mine;
+                    running[mine] += running[theirs];
+                    runningGroups--;
+                }
+            } else {
+                (*visitStamp)[neighbor] = firstStamp + grow;
+                queues[grow].push_back(neighbor);
+            }
+        }
+        if (heads[grow] == queues[grow].size() && --running[findGroup(grow)] == 0) {
+            runningGroups--;
+        }
+    }
+
+    // Every group whose searches all ran out is a piece of its own
+    int groups = 1;
+    vector<int> newLabel(searches, -1);
+    for (int i = 0; i < searches; i++) {
+        int root = findGroup(i);
+        if (running[root] > 0) continue;
+        if (newLabel[root] < 0) {
+            newLabel[root] = static_cast<int>(pieceSizes->size());
+            pieceSizes->push_back(0);
+            groups++;
+        }
+        for (TerritoryId member : queues[i]) {
+            (*pieceOf)[member] = newLabel[root];
+        }
+        (*pieceSizes)[newLabel[root]] += static_cast<int>(queues[i].size());
+        (*pieceSizes)[label] -= static_cast<int>(queues[i].size());
+    }
+    setPieces(continent, (*continentPieces)[continent] - 1 + groups);
+}
+
+void MapEditor::joinContinent(TerritoryId id, ContinentId continent) {
+    (*home)[id] = continent;
+    (*pieceOf)[id] = static_cast<int>(pieceSizes->size());
+    pieceSizes->push_back(1);
+    int pieces = (*continentPieces)[continent] + 1;
+    for (TerritoryId neighbor : (*neighbors)[id]) {
+        if ((*home)[neighbor] == continent && mergeSets(id, neighbor, *pieceOf, *pieceSizes)) {
+            pieces--;
+        }
+    }
+    setPieces(continent, pieces);
+}
+
+// Edits (MapEditor)
+Territory* MapEditor::addTerritory(const string& name, ContinentId continent, MapPoint position) {
+    if (continent != NO_CONTINENT && map->getContinent(continent) == nullptr) {
+        return nullptr;
+    }
+    Territory* territory = map->createTerritory(name);
+    TerritoryId id = territory->getId();
+    map->setTerritoryPosition(id, position);
+
+    neighbors->emplace_back();
+    home->push_back(NO_CONTINENT);
+    listings->push_back(0);
+    orphanCount++;
+    componentOf->push_back(static_cast<int>(componentSizes->size()));
+    componentSizes->push_back(1);
+    componentCount++;
+    pieceOf->push_back(-1);
+    visitStamp->push_back(0);
+
+    if (continent != NO_CONTINENT) {
+        map->getContinent(continent)->addTerritory(territory);
+        setListings(id, 1);
+        joinContinent(id, continent);
+    }
+    return territory;
+}
+
+Continent* MapEditor::addContinent(const string& name, int bonus) {
+    Continent* continent = map->createContinent(name, bonus);
+    continentPieces->push_back(0);
+    return continent;
+}
+
+bool MapEditor::addEdge(TerritoryId a, TerritoryId b) {
+    TerritoryId count = static_cast<TerritoryId>(neighbors->size());
+    if (a < 0 || b < 0 || a >= count || b >= count || a == b) return false;
+    vector<TerritoryId>& row = (*neighbors)[a];
+    if (find(row.begin(), row.end(), b) != row.end()) return false;
+
+    map->addAdjacency(a, b);
+    map->addAdjacency(b, a);
+    row.push_back(b);
+    (*neighbors)[b].push_back(a);
+
+    if (mergeSets(a, b, *componentOf, *componentSizes)) {
+        componentCount--;
+    }
+    ContinentId continent = (*home)[a];
+    if (continent != NO_CONTINENT && (*home)[b] == continent && mergeSets(a, b, *pieceOf, *pieceSizes)) {
+        setPieces(continent, (*continentPieces)[continent] - 1);
+    }
+    return true;
+}
+
+bool MapEditor::removeEdge(TerritoryId a, TerritoryId b) {
+    TerritoryId count = static_cast<TerritoryId>(neighbors->size());
+    if (a < 0 || b < 0 || a >= count || b >= count) return false;
+    vector<TerritoryId>& row = (*neighbors)[a];
+    auto edge = find(row.begin(), row.end(), b);
+    if (edge == row.end()) return false;
+
+    map->removeAdjacency(a, b);
+    map->removeAdjacency(b, a);
+    row.erase(edge);
+    vector<TerritoryId>& back = (*neighbors)[b];
+    back.erase(find(back.begin(), back.end(), a));
+
+    if (splitSets(a, b, NO_CONTINENT, *componentOf, *componentSizes)) {
+        componentCount++;
+    }
+    ContinentId continent = (*home)[a];
+    if (continent != NO_CONTINENT && (*home)[b] == continent && splitSets(a, b, continent, *pieceOf, *pieceSizes)) {
+        setPieces(continent, (*continentPieces)[continent] + 1);
+    }
+    return true;
+}
+
+bool MapEditor::moveTerritory(TerritoryId id, ContinentId continent) {
+    Territory* territory = map->getTerritory(id);
+    Continent* target = map->getContinent(continent);
+    if (territory == nullptr || target == nullptr || id >= static_cast<TerritoryId>(home->size())) return false;
+    ContinentId previous = (*home)[id];
+    if (previous == continent) return false;
+
+    if (previous != NO_CONTINENT) {
+        (*map->getContinents())[previous]->removeTerritory(territory);
+        setListings(id, (*listings)[id] - 1);
+    }
+    target->addTerritory(territory);
+    setListings(id, (*listings)[id] + 1);
+
+    // A territory listed twice keeps the first continent that lists it
+    ContinentId next = ((*listings)[id] == 1) ? continent : findFirstListing(id);
+    if (next != previous) {
+        if (previous != NO_CONTINENT) leaveContinent(id, previous);
+        joinContinent(id, next);
+    }
+    return true;
+}
+
+// Validity queries (MapEditor)
+bool MapEditor::isConnected() const {
+    return componentCount <= 1;
+}
+
+bool MapEditor::areContinentsConnected() const {
+    return splitContinentCount == 0;
+}
+
+bool MapEditor::isEachTerritoryInOneContinent() const {
+    return orphanCount == 0 && duplicateCount == 0 && !continentAsNeighbor;
+}
+
+bool MapEditor::isValid() const {
+    bool valid = isConnected() && areContinentsConnected() && isEachTerritoryInOneContinent();
+    map->setCachedValidity(valid);     // Map::validate() answers without rerunning the checks
+    return valid;
+}
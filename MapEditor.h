@@ -0,0 +1,99 @@
+// MapEditor.h
+#ifndef MAPEDITOR_H
+#define MAPEDITOR_H
+
+#include "Map.h"
+#include <vector>
+#include <string>
+
+using namespace std;
+
+/**
+ * MapEditor applies edits to a Map and keeps the three validity checks of Map::validate()
+ * up to date after every edit, so a map designer never waits for a full revalidation
+ * - connectivity: the territories are kept in labelled sets (a union-find that stores each territory's
+ *   set label directly and merges by relabelling the smaller set). An added edge merges two sets;
+ *   a removed edge runs a bidirectional search between its ends that stops as soon as they meet,
+ *   and when they do not, the side that ran out is exactly the piece that split off and gets a new label
+ * - continents: the same, with sets that never cross a continent border; moving a territory
+ *   splits the piece it leaves with one search per neighbor it had there (grown like the removed-edge
+ *   search: smallest first, searches that meet join, and the last group still running keeps the old
+ *   label) and merges it into the continent it joins
+ * - membership: counters of orphan and duplicated territories
+ * Each edit costs about the size of the smaller sets it touches, times the number of neighbors for a move
+ * (O(1) for most edits of a connected map),
+ * and the validity queries read counters in O(1)
+ * While an editor is attached, the map must be edited through it only
+ */
+class MapEditor {
+    private:
+        Map* map;                                   // edited map (not owned)
+        vector<vector<TerritoryId>>* neighbors;     // undirected adjacency, one entry per neighbor
+        vector<ContinentId>* home;                  // continent of each territory for the continent checks
+        vector<int>* listings;                      // continent lists that name each territory
+
+        // Map connectivity: component label of each territory and size of each label
+        vector<int>* componentOf;
+        vector<int>* componentSizes;
+        int componentCount;
+
+        // Continent connectivity: piece label of each territory (-1 outside continents) and size of each label
+        vector<int>* pieceOf;
+        vector<int>* pieceSizes;
+        vector<int>* continentPieces;               // pieces of each continent
+        int splitContinentCount;
+
+        // Membership
+        int orphanCount;
+        int duplicateCount;
+        bool continentAsNeighbor;   // the map file listed a continent as a neighbor (edits cannot fix it)
+
+        // Search marks (stamped so they never need clearing)
+        vector<uint32_t>* visitStamp;
+        uint32_t searchStamp;
+
+        uint32_t nextStamps(uint32_t count = 2);
+        int relabel(TerritoryId start, vector<int>& labelOf, vector<int>& sizes, int to);
+        bool mergeSets(TerritoryId a, TerritoryId b, vector<int>& labelOf, vector<int>& sizes);
+        bool splitSets(TerritoryId a, TerritoryId b, ContinentId within, vector<int>& labelOf, vector<int>& sizes);
+        void labelAll();
+        void setPieces(ContinentId continent, int pieces);
+        void setListings(TerritoryId id, int count);
+        ContinentId findFirstListing(TerritoryId id) const;
+        void leaveContinent(TerritoryId id, ContinentId continent);
+        void joinContinent(TerritoryId id, ContinentId continent);
+
+    public:
+        // Constructors and destructor
+        MapEditor(Map* map);    // O(V + E) scan of the current map
+        MapEditor(const MapEditor& other);
+        ~MapEditor();
+
+        // Assignment operator
+        MapEditor& operator=(const MapEditor& other);
+
+        // Stream insertion operator
+        friend ostream& operator<<(ostream& os, const MapEditor& editor);
+
+        // Getters
+        Map* getMap() const;
+        int getComponentCount() const;
+        int getSplitContinentCount() const;
+        int getOrphanCount() const;
+        int getDuplicateCount() const;
+
+        // Edits (false when the edit does not apply, e.g. an unknown id or an existing edge)
+        Territory* addTerritory(const string& name, ContinentId continent, MapPoint position);
+        Continent* addContinent(const string& name, int bonus);
+        bool addEdge(TerritoryId a, TerritoryId b);         // both directions
+        bool removeEdge(TerritoryId a, TerritoryId b);      // both directions
+        bool moveTerritory(TerritoryId territory, ContinentId continent);
+
+        // Validity queries (same verdicts as Map::validate())
+        bool isConnected() const;
+        bool areContinentsConnected() const;
+        bool isEachTerritoryInOneContinent() const;
+        bool isValid() const;   // also stored as the map's cached verdict
+};
+
+#endif
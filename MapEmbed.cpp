@@ -0,0 +1,87 @@
+// MapEmbed.cpp
+// Build tool (map-embed): compiles map files into a C++ source that links their binary images
+// into the game, so loading a bundled map reads no file and parses no text
+// Usage: map-embed <output.cpp> <file.map>...
+#include "Map.h"
+#include "CommandProcessing.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+// The game sources refer to the game's command processor, the tool never uses it
+CommandProcessor *theCommandProcessor = nullptr;
+
+// File name as a C++ string literal body
+static string escape(const string& text) {
+    string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+// Writes image as the initializer of a byte array, 16 bytes per line
+static void writeBytes(ostream& out, string_view image) {
+    out << hex << setfill('0');
+    for (size_t i = 0; i < image.size(); i++) {
+        if (i % 16 == 0) out << "\n   ";
+        out << " 0x" << setw(2) << static_cast<unsigned>(static_cast<unsigned char>(image[i])) << ",";
+    }
+    out << dec << setfill(' ') << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: map-embed <output.cpp> <file.map>..." << endl;
+        return 2;
+    }
+
+    MapLoader loader;
+    loader.setLoadMode(MapLoadMode::Mapped);
+    loader.setMessageStream(&cerr);
+
+    ostringstream source;
+    source << "// BundledMaps.cpp\n"
+           << "// Generated by map-embed, do not edit: rebuilt from the bundled .map files by the build\n"
+           << "#include \"Map.h\"\n\n"
+           << "namespace {\n";
+
+    ostringstream registrations;
+    for (int i = 2; i < argc; i++) {
+        string mapFile = argv[i];
+        Map* map = loader.loadMap(mapFile);
+        if (map == nullptr) {
+            cerr << "map-embed: cannot load " << mapFile << endl;
+            return 1;
+        }
+        string image = loader.buildBinaryImage(*map, MapLoader::hashFile(mapFile));
+        delete map;
+
+        string array = "image" + to_string(i - 2);
+        source << "\n// " << mapFile << " (" << image.size() << " bytes)\n"
+               << "alignas(8) constexpr unsigned char " << array << "[] = {";
+        writeBytes(source, image);
+        source << "};\n";
+        registrations << "    MapLoader::addBundledMap(\"" << escape(mapFile) << "\", string_view(reinterpret_cast<const char*>("
+                      << array << "), sizeof(" << array << ")));\n";
+    }
+
+    // Registered during static initialization, before main() can load a map
+    source << "\nconst bool registered = [] {\n"
+           << registrations.str()
+           << "    return true;\n"
+           << "}();\n\n"
+           << "}\n";
+
+    ofstream output(argv[1], ios::trunc);
+    output << source.str();
+    if (!output) {
+        cerr << "map-embed: cannot write " << argv[1] << endl;
+        return 1;
+    }
+    return 0;
+}
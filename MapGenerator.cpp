@@ -0,0 +1,204 @@
+// MapGenerator.cpp
+#include "MapGenerator.h"
+#include <fstream>
+#include <random>
+#include <queue>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+using namespace std;
+
+// ==================== MapGeneratorSettings Implementation ====================
+
+// Stream insertion operator (MapGeneratorSettings)
+ostream& operator<<(ostream& os, const MapGeneratorSettings& settings) {
+    static const char* distributionNames[] = {"grid", "uniform", "hubs"};
+    os << "territories=" << settings.territoryCount
+       << " continents=" << settings.continentCount
+       << " distribution=" << distributionNames[static_cast<int>(settings.distribution)]
+       << " degree=" << settings.averageDegree
+       << " seed=" << settings.seed;
+    return os;
+}
+
+// ==================== MapGenerator Implementation ====================
+
+// Constructors (MapGenerator)
+MapGenerator::MapGenerator() {
+}
+
+MapGenerator::MapGenerator(const MapGeneratorSettings& generatorSettings) {
+    settings = generatorSettings;
+}
+
+// Getters (MapGenerator)
+const MapGeneratorSettings& MapGenerator::getSettings() const {
+    return settings;
+}
+
+// Setters (MapGenerator)
+void MapGenerator::setSettings(const MapGeneratorSettings& newSettings) {
+    settings = newSettings;
+}
+
+// Multi-source BFS over the lattice from one random seed per continent:
+// every territory joins the region that reaches it first, so each continent is connected
+vector<int> MapGenerator::growContinents(int count, int columns) const {
+    int continentCount = clamp(settings.continentCount, 1, count);
+    mt19937 rng(settings.seed ^ 0x9e3779b9u);
+
+    // Partial Fisher-Yates shuffle picks distinct seed territories
+    vector<int> ids(count);
+    iota(ids.begin(), ids.end(), 0);
+    for (int i = 0; i < continentCount; i++) {
+        uniform_int_distribution<int> pick(i, count - 1);
+        swap(ids[i], ids[pick(rng)]);
+    }
+
+    vector<int> continentOf(count, -1);
+    queue<int> frontier;
+    for (int c = 0; c < continentCount; c++) {
+        continentOf[ids[c]] = c;
+        frontier.push(ids[c]);
+    }
+    while (!frontier.empty()) {
+        int current = frontier.front();
+        frontier.pop();
+        int column = current % columns;
+        int candidates[4] = {
+            column > 0 ? current - 1 : -1,
+            column < columns - 1 && current + 1 < count ? current + 1 : -1,
+            current - columns,
+            current + columns < count ? current + columns : -1
+        };
+        for (int next : candidates) {
+            if (next >= 0 && continentOf[next] < 0) {
+                continentOf[next] = continentOf[current];
+                frontier.push(next);
+            }
+        }
+    }
+    return continentOf;
+}
+
+// Lattice edges plus the extra edges of the degree distribution; every edge is stored both ways
+vector<vector<int>> MapGenerator::buildAdjacency(int count, int columns) const {
+    vector<vector<int>> adjacency(count);
+    auto link = [&adjacency](int a, int b) {
+        if (a == b) return;
+        adjacency[a].push_back(b);
+        adjacency[b].push_back(a);
+    };
+
+    // The 4-neighbour lattice keeps the whole map connected (the last row may be partial)
+    for (int i = 0; i < count; i++) {
+        if (i % columns < columns - 1 && i + 1 < count) link(i, i + 1);
+        if (i + columns < count) link(i, i + columns);
+    }
+
+    mt19937 rng(settings.seed);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    double extraDegree = max(0.0, settings.averageDegree - 4.0);
+
+    if (settings.distribution == DegreeDistribution::Uniform) {
+        // Each of the two diagonals adds 2 to the degree sum per territory
+        double probability = min(1.0, extraDegree / 4.0);
+        for (int i = 0; i < count; i++) {
+            int column = i % columns;
+            if (column < columns - 1 && i + columns + 1 < count && unit(rng) < probability) link(i, i + columns + 1);
+            if (column > 0 && i + columns - 1 < count && unit(rng) < probability) link(i, i + columns - 1);
+        }
+    } else if (settings.distribution == DegreeDistribution::Hubs) {
+        // One territory in a hundred is a hub; hubs are chosen with a skewed (Zipf-like) weight,
+        // and each extra edge joins a hub to a territory a few rows away
+        int hubCount = max(1, count / 100);
+        vector<int> hubs(count);
+        iota(hubs.begin(), hubs.end(), 0);
+        shuffle(hubs.begin(), hubs.end(), rng);
+        hubs.resize(hubCount);
+
+        long long extraEdges = static_cast<long long>(extraDegree * count / 2.0);
+        int window = 2 * columns + 2;
+        for (long long e = 0; e < extraEdges; e++) {
+            int hub = hubs[static_cast<int>(hubCount * pow(unit(rng), 2.5))];
+            uniform_int_distribution<int> offset(-window, window);
+            int target = clamp(hub + offset(rng), 0, count - 1);
+            link(hub, target);
+        }
+    }
+
+    for (vector<int>& row : adjacency) {
+        sort(row.begin(), row.end());
+        row.erase(unique(row.begin(), row.end()), row.end());
+    }
+    return adjacency;
+}
+
+// Writes the map in Conquest format: territories are named T<id>, continents C<id>
+void MapGenerator::generate(ostream& out) const {
+    int count = max(1, settings.territoryCount);
+    int columns = static_cast<int>(ceil(sqrt(static_cast<double>(count))));
+    vector<int> continentOf = growContinents(count, columns);
+    vector<vector<int>> adjacency = buildAdjacency(count, columns);
+
+    int continentCount = clamp(settings.continentCount, 1, count);
+    vector<int> continentSizes(continentCount, 0);
+    for (int continent : continentOf) {
+        continentSizes[continent]++;
+    }
+
+    out << "[Map]\n"
+        << "author=MapGenerator\n"
+        << "image=none.bmp\n"
+        << "wrap=no\n"
+        << "scroll=none\n"
+        << "warn=yes\n"
+        << "generator=" << settings << "\n\n";
+
+    out << "[Continents]\n";
+    for (int c = 0; c < continentCount; c++) {
+        out << 'C' << c << '=' << 1 + continentSizes[c] / 4 << '\n';
+    }
+
+    out << "\n[Territories]\n";
+    mt19937 rng(settings.seed + 1);
+    uniform_int_distribution<int> jitter(0, 9);
+    for (int i = 0; i < count; i++) {
+        out << 'T' << i << ',' << (i % columns) * 20 + jitter(rng) << ',' << (i / columns) * 20 + jitter(rng)
+            << ",C" << continentOf[i];
+        for (int neighbor : adjacency[i]) {
+            out << ",T" << neighbor;
+        }
+        out << '\n';
+    }
+}
+
+bool MapGenerator::generateFile(const string& fileName) const {
+    ofstream output(fileName, ios::trunc);
+    if (!output.is_open()) {
+        cout << "Error: Cannot write file " << fileName << endl;
+        return false;
+    }
+    generate(output);
+    return static_cast<bool>(output);
+}
+
+// 1e2 to 1e6 territories, ~25 territories per continent, average degree 6
+vector<MapGeneratorSettings> MapGenerator::scalingCorpus() {
+    vector<MapGeneratorSettings> corpus;
+    for (int territories = 100; territories <= 1000000; territories *= 10) {
+        MapGeneratorSettings settings;
+        settings.territoryCount = territories;
+        settings.continentCount = max(2, territories / 25);
+        settings.distribution = DegreeDistribution::Uniform;
+        settings.averageDegree = 6.0;
+        settings.seed = 42;
+        corpus.push_back(settings);
+    }
+    return corpus;
+}
+
+string MapGenerator::corpusFileName(const MapGeneratorSettings& settings) {
+    return "scaling_" + to_string(settings.territoryCount) + ".map";
+}
@@ -0,0 +1,67 @@
+// MapGenerator.h
+#ifndef MAPGENERATOR_H
+#define MAPGENERATOR_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * How the generator adds edges on top of the base grid
+ * Grid: 4-neighbour lattice only (degree 2 to 4)
+ * Uniform: lattice plus diagonals, picked at random to reach the average degree
+ * Hubs: lattice plus a few high-degree territories linked to many nearby ones (heavy-tailed degrees)
+ */
+enum class DegreeDistribution { Grid, Uniform, Hubs };
+
+/**
+ * Settings of one generated map
+ */
+struct MapGeneratorSettings {
+    int territoryCount = 100;
+    int continentCount = 4;
+    DegreeDistribution distribution = DegreeDistribution::Uniform;
+    double averageDegree = 6.0;     // ignored by Grid
+    uint32_t seed = 1;
+
+    friend ostream& operator<<(ostream& os, const MapGeneratorSettings& settings);
+};
+
+/**
+ * MapGenerator writes random Conquest format maps that always pass Map::validate()
+ * Territories sit on a jittered grid whose 4-neighbour lattice keeps the map connected,
+ * continents are grown from random seeds over that lattice so each one is a connected region,
+ * and extra edges are added according to the degree distribution
+ * Runs in O(territories + edges), so maps of a million territories take a few seconds
+ */
+class MapGenerator {
+    private:
+        MapGeneratorSettings settings;
+
+        vector<int> growContinents(int count, int columns) const;
+        vector<vector<int>> buildAdjacency(int count, int columns) const;
+
+    public:
+        // Constructors
+        MapGenerator();
+        MapGenerator(const MapGeneratorSettings& settings);
+
+        // Getters
+        const MapGeneratorSettings& getSettings() const;
+
+        // Setters
+        void setSettings(const MapGeneratorSettings& newSettings);
+
+        // Generation
+        void generate(ostream& out) const;
+        bool generateFile(const string& fileName) const;
+
+        // Standard scaling corpus: 1e2 to 1e6 territories with fixed seeds
+        static vector<MapGeneratorSettings> scalingCorpus();
+        static string corpusFileName(const MapGeneratorSettings& settings);
+};
+
+#endif
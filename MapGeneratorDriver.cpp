@@ -0,0 +1,121 @@
+// MapGeneratorDriver.cpp
+#include "MapGeneratorDriver.h"
+#include "Map.h"
+#include "GameEngine.h"
+#include "CommandProcessing.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <filesystem>
+
+using namespace std;
+
+extern CommandProcessor *theCommandProcessor;
+extern GameEngine *theGameEngine;
+
+// Wall-clock milliseconds taken by action
+template <typename Action>
+static double elapsedMs(Action action) {
+    auto start = chrono::steady_clock::now();
+    action();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Driver function that generates the scaling corpus and times the loaders, the validator
+ * and a short tournament game on every map, to show how each stage grows with the map size
+ */
+void testMapScaling() {
+    cout << "\n========== Map Scaling Benchmark ==========\n" << endl;
+
+    int largest;
+    cout << "Largest map to generate (100 - 1000000): " << endl;
+    cin >> largest;
+    int turns;
+    cout << "Turns of the benchmark game on each map (0 skips the games): " << endl;
+    cin >> turns;
+
+    filesystem::create_directories("scaling");
+
+    cout << left << setw(12) << "Territories" << setw(10) << "Edges" << setw(11) << "Generate"
+         << setw(11) << "Stream" << setw(11) << "Mapped" << setw(11) << "Parallel" << setw(11) << "RCM" << setw(11) << "Validate" << setw(11) << "Analyze" << setw(11) << "Routing"
+         << setw(11) << "Image" << setw(11) << "Game" << "Verdict" << endl;
+    cout << "(all times in ms)" << endl;
+
+    for (const MapGeneratorSettings& settings : MapGenerator::scalingCorpus()) {
+        if (settings.territoryCount > largest) {
+            break;
+        }
+        string file = "scaling/" + MapGenerator::corpusFileName(settings);
+        string image = MapLoader::imageFileFor(file);
+
+        double generateMs = elapsedMs([&]() { MapGenerator(settings).generateFile(file); });
+
+        // The stream loader echoes the [Map] section, keep the table readable
+        MapLoader streamLoader;
+        Map* map = nullptr;
+        streambuf* console = cout.rdbuf();
+        ostringstream discarded;
+        cout.rdbuf(discarded.rdbuf());
+        double streamMs = elapsedMs([&]() { map = streamLoader.loadMap(file); });
+        cout.rdbuf(console);
+        delete map;
+
+        MapLoader mappedLoader;
+        mappedLoader.setLoadMode(MapLoadMode::Mapped);
+        double mappedMs = elapsedMs([&]() { map = mappedLoader.loadMap(file); });
+        if (map == nullptr) {
+            cout << "Failed to load " << file << endl;
+            continue;
+        }
+        // Same map parsed on every core
+        MapLoader parallelLoader(mappedLoader);
+        parallelLoader.setLoadMode(MapLoadMode::Parallel);
+        Map* parallel = nullptr;
+        double parallelMs = elapsedMs([&]() { parallel = parallelLoader.loadMap(file); });
+        delete parallel;
+
+        // Same load followed by the Reverse Cuthill-McKee renumbering
+        MapLoader reorderingLoader(mappedLoader);
+        reorderingLoader.setTerritoryOrder(TerritoryOrder::ReverseCuthillMcKee);
+        Map* reordered = nullptr;
+        double reorderMs = elapsedMs([&]() { reordered = reorderingLoader.loadMap(file); });
+        delete reordered;
+
+        bool valid = false;
+        double validateMs = elapsedMs([&]() { valid = map->validate(); });
+        double analyzeMs = elapsedMs([&]() { map->getAnalysis(); });
+        double routingMs = elapsedMs([&]() { map->getRouting(); });
+        int edges = map->getTopology()->getEdgeCount();
+        delete map;
+
+        mappedLoader.compileMap(file, image);
+        double imageMs = elapsedMs([&]() { map = mappedLoader.loadBinaryMap(image); });
+        delete map;
+
+        double gameMs = 0;
+        if (turns > 0) {
+            // The tournament runs on the global engine and logs state changes on the last command,
+            // so it gets a command processor of its own holding the tournament command
+            string command = "tournament -M " + file + " -P Aggressive,Benevolent -G 1 -D " + to_string(turns);
+            CommandProcessor* previousProcessor = theCommandProcessor;
+            cout.rdbuf(discarded.rdbuf());
+            theCommandProcessor = new CommandProcessor();
+            theCommandProcessor->saveCommand(new Command(command));
+            theGameEngine->setState(new Start());
+            gameMs = elapsedMs([&]() { theGameEngine->executeTournament(command); });
+            cout.rdbuf(console);
+            discarded.str("");
+
+            delete theCommandProcessor;
+            theCommandProcessor = previousProcessor;
+        }
+
+        cout << fixed << setprecision(1)
+             << setw(12) << settings.territoryCount << setw(10) << edges << setw(11) << generateMs
+             << setw(11) << streamMs << setw(11) << mappedMs << setw(11) << parallelMs << setw(11) << reorderMs << setw(11) << validateMs << setw(11) << analyzeMs << setw(11) << routingMs
+             << setw(11) << imageMs << setw(11) << gameMs << (valid ? "valid" : "INVALID") << endl;
+    }
+    cout << "Generated maps are in the scaling directory." << endl;
+}
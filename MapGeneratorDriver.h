@@ -0,0 +1,8 @@
+#ifndef MAPGENERATORDRIVER_H
+#define MAPGENERATORDRIVER_H
+
+#include "MapGenerator.h"
+
+void testMapScaling();
+
+#endif
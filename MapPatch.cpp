@@ -0,0 +1,383 @@
+// MapPatch.cpp
+#include "MapPatch.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace std;
+
+// Both ends of an undirected edge in one key, lower id first
+static uint64_t pairKey(TerritoryId a, TerritoryId b) {
+    if (a > b) swap(a, b);
+    return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+}
+
+static string trimText(const string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == string::npos) return "";
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+// Bidirectional breadth-first search between a and b over the patched graph: the base edges in both
+// directions, minus the pairs the patch cut, plus the ones it joined, kept inside within unless it is null.
+// Each round grows the smaller frontier by one level, so a failed search stops after exploring
+// about the smaller of the two pieces the cut left
+static bool reachEachOther(const Map& base, const MapTopology& undirected, const unordered_map<uint64_t, bool>& present,
+                           const unordered_map<TerritoryId, vector<TerritoryId>>& joined,
+                           TerritoryId a, TerritoryId b, const Continent* within) {
+    unordered_map<TerritoryId, int> side;   // 0: reached from a, 1: reached from b
+    side[a] = 0;
+    side[b] = 1;
+    vector<TerritoryId> frontiers[2] = {{a}, {b}};
+    vector<TerritoryId> next;
+
+    while (!frontiers[0].empty() && !frontiers[1].empty()) {
+        int s = (frontiers[0].size() <= frontiers[1].size()) ? 0 : 1;
+        next.clear();
+        // true when neighbor was reached from the other side
+        auto visit = [&](TerritoryId neighbor) {
+            if (within != nullptr && base.getTerritory(neighbor)->getContinent() != within) return false;
+            auto [reached, added] = side.try_emplace(neighbor, s);
+            if (added) next.push_back(neighbor);
+            return reached->second != s;
+        };
+        for (TerritoryId id : frontiers[s]) {
+            for (TerritoryId neighbor : undirected.getNeighbors(id)) {
+                auto edited = present.find(pairKey(id, neighbor));
+                if (edited != present.end() && !edited->second) continue;
+                if (visit(neighbor)) return true;
+            }
+            auto extra = joined.find(id);
+            if (extra == joined.end()) continue;
+            for (TerritoryId neighbor : extra->second) {
+                if (visit(neighbor)) return true;
+            }
+        }
+        frontiers[s].swap(next);
+    }
+    return false;
+}
+
+// ==================== MapPatch Implementation ====================
+
+// Constructors and destructor (MapPatch)
+MapPatch::MapPatch() {
+    baseFile = new string();
+    edges = new vector<pair<string, string>>();
+    edgeAdded = new vector<bool>();
+    bonuses = new vector<pair<string, int>>();
+    renames = new vector<pair<string, string>>();
+}
+
+MapPatch::MapPatch(const MapPatch& other) {
+    baseFile = new string(*other.baseFile);
+    edges = new vector<pair<string, string>>(*other.edges);
+    edgeAdded = new vector<bool>(*other.edgeAdded);
+    bonuses = new vector<pair<string, int>>(*other.bonuses);
+    renames = new vector<pair<string, string>>(*other.renames);
+}
+
+MapPatch::~MapPatch() {
+    delete baseFile;
+    delete edges;
+    delete edgeAdded;
+    delete bonuses;
+    delete renames;
+    baseFile = nullptr;
+    edges = nullptr;
+    edgeAdded = nullptr;
+    bonuses = nullptr;
+    renames = nullptr;
+}
+
+// Assignment operator (MapPatch)
+MapPatch& MapPatch::operator=(const MapPatch& other) {
+    if (this != &other) {
+        *baseFile = *other.baseFile;
+        *edges = *other.edges;
+        *edgeAdded = *other.edgeAdded;
+        *bonuses = *other.bonuses;
+        *renames = *other.renames;
+    }
+    return *this;
+}
+
+// Stream insertion operator (MapPatch)
+ostream& operator<<(ostream& os, const MapPatch& patch) {
+    os << "Patch of " << *patch.baseFile << ": " << patch.edges->size() << " edge edit(s), "
+       << patch.bonuses->size() << " bonus(es), " << patch.renames->size() << " rename(s)";
+    return os;
+}
+
+// Getters (MapPatch)
+const string& MapPatch::getBaseFile() const {
+    return *baseFile;
+}
+
+int MapPatch::getEditCount() const {
+    return static_cast<int>(edges->size() + bonuses->size() + renames->size());
+}
+
+// Setters (MapPatch)
+void MapPatch::setBaseFile(const string& file) {
+    *baseFile = file;
+}
+
+// Edits (MapPatch)
+void MapPatch::addEdge(const string& from, const string& to) {
+    edges->emplace_back(from, to);
+    edgeAdded->push_back(true);
+}
+
+void MapPatch::removeEdge(const string& from, const string& to) {
+    edges->emplace_back(from, to);
+    edgeAdded->push_back(false);
+}
+
+void MapPatch::setBonus(const string& continent, int bonus) {
+    bonuses->emplace_back(continent, bonus);
+}
+
+void MapPatch::rename(const string& oldName, const string& newName) {
+    renames->emplace_back(oldName, newName);
+}
+
+// Patch files (MapPatch)
+// Replaces the edits of this patch with the ones of the file
+bool MapPatch::read(const string& fileName, ostream& messages) {
+    ifstream input(fileName);
+    if (!input.is_open()) {
+        messages << "Error: Cannot open file " << fileName << endl;
+        return false;
+    }
+
+    MapPatch parsed;
+    string section;
+    string line;
+    int lineNumber = 0;
+    try {
+        while (getline(input, line)) {
+            lineNumber++;
+            line = trimText(line);
+            // Skip empty lines and comments (starts with a semicolon (;))
+            if (line.empty() || line[0] == ';') continue;
+
+            if (line.front() == '[' && line.back() == ']') {
+                section = line;
+                if (section != "[Patch]" && section != "[Edges]" && section != "[Bonuses]" && section != "[Renames]") {
+                    throw runtime_error("unknown section " + section);
+                }
+                continue;
+            }
+
+            if (section == "[Edges]") {
+                size_t comma = line.find(',');
+                if ((line[0] != '+' && line[0] != '-') || comma == string::npos) {
+                    throw runtime_error("expected +from,to or -from,to");
+                }
+                string from = trimText(line.substr(1, comma - 1));
+                string to = trimText(line.substr(comma + 1));
+                if (line[0] == '+') {
+                    parsed.addEdge(from, to);
+                } else {
+                    parsed.removeEdge(from, to);
+                }
+                continue;
+            }
+
+            size_t equals = (section == "[Bonuses]") ? line.rfind('=') : line.find('=');
+            if (equals == string::npos || section.empty()) {
+                throw runtime_error("expected name=value");
+            }
+            string key = trimText(line.substr(0, equals));
+            string value = trimText(line.substr(equals + 1));
+            if (section == "[Patch]") {
+                if (key == "base") parsed.setBaseFile(value);
+            } else if (section == "[Bonuses]") {
+                size_t used = 0;
+                int bonus = stoi(value, &used);
+                if (used != value.size()) throw runtime_error("bad bonus " + value);
+                parsed.setBonus(key, bonus);
+            } else {
+                parsed.rename(key, value);
+            }
+        }
+        if (parsed.getBaseFile().empty()) {
+            lineNumber = 0;
+            throw runtime_error("no base map (base= in [Patch])");
+        }
+    } catch (const exception& e) {
+        messages << "Error parsing file " << fileName;
+        if (lineNumber > 0) messages << " line " << lineNumber;
+        messages << ": " << e.what() << endl;
+        return false;
+    }
+
+    *this = parsed;
+    return true;
+}
+
+bool MapPatch::write(const string& fileName) const {
+    ofstream output(fileName, ios::trunc);
+    output << "[Patch]\nbase=" << *baseFile << "\n";
+    if (!edges->empty()) {
+        output << "\n[Edges]\n";
+        for (size_t i = 0; i < edges->size(); i++) {
+            output << ((*edgeAdded)[i] ? '+' : '-') << (*edges)[i].first << "," << (*edges)[i].second << "\n";
+        }
+    }
+    if (!bonuses->empty()) {
+        output << "\n[Bonuses]\n";
+        for (const auto& [continent, bonus] : *bonuses) {
+            output << continent << "=" << bonus << "\n";
+        }
+    }
+    if (!renames->empty()) {
+        output << "\n[Renames]\n";
+        for (const auto& [oldName, newName] : *renames) {
+            output << oldName << "=" << newName << "\n";
+        }
+    }
+    return static_cast<bool>(output);
+}
+
+// Applying (MapPatch)
+// Resolves every edit against base before copying it, rebuilds the edited adjacency rows in one pass over
+// the compiled graph, then derives the verdict of the variant from the verdict of the base (see the class comment)
+Map* MapPatch::apply(const Map& base, ostream& messages) const {
+    const MapTopology* graph = base.getTopology();
+    int count = graph->getTerritoryCount();
+
+    // Final state of every edited pair of territories: the last edit of a pair wins
+    unordered_map<uint64_t, bool> present;
+    vector<pair<TerritoryId, TerritoryId>> pairs;   // (lower id, higher id), in the order they are first edited
+    for (size_t i = 0; i < edges->size(); i++) {
+        const auto& [fromName, toName] = (*edges)[i];
+        TerritoryId from = base.findTerritoryId(fromName);
+        TerritoryId to = base.findTerritoryId(toName);
+        if (from == NO_TERRITORY || to == NO_TERRITORY || from == to) {
+            messages << "Error: Patch edge " << fromName << "," << toName << " does not join two territories of " << *baseFile << endl;
+            return nullptr;
+        }
+        auto [state, first] = present.try_emplace(pairKey(from, to), graph->areAdjacent(from, to) || graph->areAdjacent(to, from));
+        if (first) {
+            pairs.emplace_back(min(from, to), max(from, to));
+        }
+        if (!(*edgeAdded)[i] && !state->second) {
+            messages << "Error: Patch removes the edge " << fromName << "," << toName << " that " << *baseFile << " does not have" << endl;
+            return nullptr;
+        }
+        state->second = (*edgeAdded)[i];
+    }
+
+    vector<Continent*> bonusContinents;
+    for (const auto& [continentName, bonus] : *bonuses) {
+        bonusContinents.push_back(base.getContinent(continentName));
+        if (bonusContinents.back() == nullptr) {
+            messages << "Error: Patch sets the bonus of " << continentName << ", which is no continent of " << *baseFile << endl;
+            return nullptr;
+        }
+    }
+
+    // Directed edges to add and remove: a pair left present gets both directions, a pair left absent none
+    vector<pair<TerritoryId, TerritoryId>> added;
+    vector<pair<TerritoryId, TerritoryId>> removed;
+    vector<pair<TerritoryId, TerritoryId>> cut;                 // pairs joined in the base, not in the variant
+    unordered_map<TerritoryId, vector<TerritoryId>> joined;     // pairs joined in the variant, not in the base (both ways)
+    for (auto [a, b] : pairs) {
+        bool forward = graph->areAdjacent(a, b);
+        bool backward = graph->areAdjacent(b, a);
+        if (present[pairKey(a, b)]) {
+            if (!forward) added.emplace_back(a, b);
+            if (!backward) added.emplace_back(b, a);
+            if (!forward && !backward) {
+                joined[a].push_back(b);
+                joined[b].push_back(a);
+            }
+        } else {
+            if (forward) removed.emplace_back(a, b);
+            if (backward) removed.emplace_back(b, a);
+            if (forward || backward) cut.emplace_back(a, b);
+        }
+    }
+
+    Map* variant = new Map(base);
+
+    if (!added.empty() || !removed.empty()) {
+        sort(added.begin(), added.end());
+        sort(removed.begin(), removed.end());
+        vector<int> offsets(count + 1, 0);
+        vector<TerritoryId> neighbors;
+        neighbors.reserve(graph->getEdgeCount() + added.size() - removed.size());
+        size_t nextAdded = 0;
+        size_t nextRemoved = 0;
+        for (TerritoryId id = 0; id < count; id++) {
+            span<const TerritoryId> row = graph->getNeighbors(id);
+            bool edited = (nextAdded < added.size() && added[nextAdded].first == id)
+                          || (nextRemoved < removed.size() && removed[nextRemoved].first == id);
+            if (!edited) {
+                neighbors.insert(neighbors.end(), row.begin(), row.end());
+            } else {
+                // Merge the sorted row with the sorted additions of the row, leaving out its removals
+                for (TerritoryId neighbor : row) {
+                    while (nextAdded < added.size() && added[nextAdded].first == id && added[nextAdded].second < neighbor) {
+                        neighbors.push_back(added[nextAdded++].second);
+                    }
+                    if (nextRemoved < removed.size() && removed[nextRemoved] == make_pair(id, neighbor)) {
+                        nextRemoved++;
+                        continue;
+                    }
+                    neighbors.push_back(neighbor);
+                }
+                while (nextAdded < added.size() && added[nextAdded].first == id) {
+                    neighbors.push_back(added[nextAdded++].second);
+                }
+            }
+            offsets[id + 1] = static_cast<int>(neighbors.size());
+        }
+        variant->setTopology(new MapTopology(count, std::move(offsets), std::move(neighbors)));
+    }
+
+    for (size_t i = 0; i < bonuses->size(); i++) {
+        variant->getContinent(bonusContinents[i]->getId())->setBonusArmies((*bonuses)[i].second);
+    }
+
+    // Renames go through the variant's name tables, so a later rename sees the earlier ones
+    for (const auto& [oldName, newName] : *renames) {
+        Territory* territory = variant->getTerritory(oldName);
+        Continent* continent = (territory == nullptr) ? variant->getContinent(oldName) : nullptr;
+        bool taken = newName.empty() || variant->findTerritoryId(newName) != NO_TERRITORY
+                     || variant->findContinentId(newName) != NO_CONTINENT;
+        if ((territory == nullptr && continent == nullptr) || taken) {
+            messages << "Error: Patch cannot rename " << oldName << " to " << newName << " in " << *baseFile << endl;
+            delete variant;
+            return nullptr;
+        }
+        if (territory != nullptr) {
+            territory->setName(newName);
+        } else {
+            continent->setName(newName);
+        }
+    }
+
+    // An invalid base is left for validate() to check in full: the patch may have fixed it
+    if (base.validate()) {
+        bool valid = true;
+        if (!cut.empty()) {
+            const MapTopology& undirected = base.getAnalysis()->getUndirectedGraph();
+            for (auto [a, b] : cut) {
+                // Ends in one continent must stay joined inside it (which also keeps the map connected)
+                Continent* within = base.getTerritory(a)->getContinent();
+                if (within != base.getTerritory(b)->getContinent()) within = nullptr;
+                if (!reachEachOther(base, undirected, present, joined, a, b, within)) {
+                    valid = false;
+                    break;
+                }
+            }
+        }
+        variant->setCachedValidity(valid);  // last: the edits above clear the verdict
+    }
+    return variant;
+}
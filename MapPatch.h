@@ -0,0 +1,72 @@
+// MapPatch.h
+#ifndef MAPPATCH_H
+#define MAPPATCH_H
+
+#include "Map.h"
+#include <vector>
+#include <string>
+
+using namespace std;
+
+const string WZPATCH_EXTENSION = ".wzpatch";
+
+/**
+ * MapPatch is a variant of a base map stored as its differences from it (.wzpatch file):
+ *   [Patch]
+ *   base=Earth.map          (relative to the patch file, or a bundled map name)
+ *   [Edges]
+ *   +Alaska,Kamchatka       (adds the edge in both directions)
+ *   -Alaska,Alberta         (removes it in both directions)
+ *   [Bonuses]
+ *   North America=7
+ *   [Renames]
+ *   Alaska=Alyaska          (a territory, else a continent; applied after the other edits)
+ * Edges and bonuses name the territories and continents of the base map
+ * Applying a patch copies the base (which shares its compiled graph and parses nothing), resolves
+ * every name in O(1), and rebuilds the adjacency rows the edits touch. When the base map is valid,
+ * the variant is revalidated locally: added edges and bonuses cannot break a valid map, and a removed
+ * edge only does if its two ends no longer reach each other, which a bidirectional search from both
+ * ends settles in about the size of the region around the edge (within their continent when they share one)
+ */
+class MapPatch {
+    private:
+        string* baseFile;
+        vector<pair<string, string>>* edges;    // (from, to) of every edge edit, in file order
+        vector<bool>* edgeAdded;                // true: +from,to, false: -from,to
+        vector<pair<string, int>>* bonuses;     // (continent, bonus)
+        vector<pair<string, string>>* renames;  // (old name, new name)
+
+    public:
+        // Constructors and destructor
+        MapPatch();
+        MapPatch(const MapPatch& other);
+        ~MapPatch();
+
+        // Assignment operator
+        MapPatch& operator=(const MapPatch& other);
+
+        // Stream insertion operator
+        friend ostream& operator<<(ostream& os, const MapPatch& patch);
+
+        // Getters
+        const string& getBaseFile() const;
+        int getEditCount() const;
+
+        // Setters
+        void setBaseFile(const string& baseFile);
+
+        // Edits
+        void addEdge(const string& from, const string& to);
+        void removeEdge(const string& from, const string& to);
+        void setBonus(const string& continent, int bonus);
+        void rename(const string& oldName, const string& newName);
+
+        // Patch files
+        bool read(const string& fileName, ostream& messages);     // false (and a message) on a malformed file
+        bool write(const string& fileName) const;
+
+        // Builds the variant of base, nullptr (and a message) when an edit does not apply to it
+        Map* apply(const Map& base, ostream& messages) const;
+};
+
+#endif
@@ -0,0 +1,257 @@
+// OrderScheduler.cpp
+#include "OrderScheduler.h"
+#include <atomic>
+#include <charconv>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+// Stands for what a conquest changes besides its territory and players: the deck the attacker draws
+// a card from, and the ownership tables of the map (shared by all its territories)
+const int CONQUEST = 0;
+
+// Installed in cout while orders run in parallel: sends what the game writes to cout (e.g. a player
+// turning aggressive) to the output of the order its thread is running
+class OrderOutputRouter : public streambuf {
+    private:
+        streambuf* console;
+
+        streambuf* target() const {
+            ostream& out = orderOutput();
+            return (&out == &cout) ? console : out.rdbuf();
+        }
+
+    protected:
+        int overflow(int c) override {
+            if (traits_type::eq_int_type(c, traits_type::eof())) {
+                return traits_type::not_eof(c);
+            }
+            return target()->sputc(traits_type::to_char_type(c));
+        }
+        streamsize xsputn(const char* text, streamsize count) override {
+            return target()->sputn(text, count);
+        }
+        int sync() override {
+            return target()->pubsync();
+        }
+
+    public:
+        explicit OrderOutputRouter(streambuf* console) : console(console) {}
+};
+
+// Orders whose territories and players the graph cannot name run alone
+bool isBarrier(const IssuedOrder& issued, const Map* map) {
+    const Orders* order = issued.second;
+    if (order->getKind() != OrderKind::Deploy && order->getKind() != OrderKind::Advance) {
+        return true;
+    }
+    return order->getMap() == nullptr || order->getMap() != map
+        || map->getTerritory(order->getSourceId()) == nullptr || map->getTerritory(order->getTargetId()) == nullptr;
+}
+
+struct WorkQueue {
+    mutex lock;
+    deque<size_t> orders;
+};
+
+}
+
+bool parseOrderExecutionMode(const string& text, OrderExecutionMode& mode, int& threadCount) {
+    if (text == "sequential") {
+        mode = OrderExecutionMode::Sequential;
+        threadCount = 0;
+        return true;
+    }
+    if (text == "parallel") {
+        mode = OrderExecutionMode::Parallel;
+        threadCount = 0;
+        return true;
+    }
+    const string prefix = "parallel:";
+    if (text.compare(0, prefix.size(), prefix) != 0 || text.size() == prefix.size()) {
+        return false;
+    }
+    int count = 0;
+    auto [end, error] = from_chars(text.data() + prefix.size(), text.data() + text.size(), count);
+    if (error != errc() || end != text.data() + text.size() || count < 1) {
+        return false;
+    }
+    mode = OrderExecutionMode::Parallel;
+    threadCount = count;
+    return true;
+}
+
+// ==================== OrderScheduler Implementation ====================
+
+// Constructors (OrderScheduler)
+OrderScheduler::OrderScheduler(int threadCount) {
+    setThreadCount(threadCount);
+}
+
+// Getters (OrderScheduler)
+int OrderScheduler::getThreadCount() const {
+    return threadCount;
+}
+
+// Setters (OrderScheduler)
+void OrderScheduler::setThreadCount(int count) {
+    threadCount = (count > 0) ? count : max(1, static_cast<int>(thread::hardware_concurrency()));
+}
+
+// The sequence is cut at its barriers; the orders between two barriers run as a batch
+void OrderScheduler::execute(const vector<IssuedOrder>& sequence, const function<void(size_t)>& task) const {
+    Map* map = nullptr;
+    for (const IssuedOrder& issued : sequence) {
+        if (issued.second->getMap() != nullptr) {
+            map = issued.second->getMap();
+            break;
+        }
+    }
+    if (map != nullptr) {
+        map->getTopology();   // compiled here rather than by whichever thread first checks an adjacency
+    }
+
+    size_t begin = 0;
+    while (begin < sequence.size()) {
+        if (isBarrier(sequence[begin], map)) {
+            task(begin);
+            begin++;
+            continue;
+        }
+        size_t end = begin + 1;
+        while (end < sequence.size() && !isBarrier(sequence[end], map)) {
+            end++;
+        }
+        if (threadCount == 1 || end - begin < 2) {
+            for (size_t i = begin; i < end; i++) {
+                task(i);
+            }
+        } else {
+            runBatch(sequence, begin, end, task);
+        }
+        begin = end;
+    }
+}
+
+void OrderScheduler::runBatch(const vector<IssuedOrder>& sequence, size_t begin, size_t end, const function<void(size_t)>& task) const {
+    size_t count = end - begin;
+
+    // Conflict graph: an edge from the last earlier order sharing a territory or a player with the order
+    vector<vector<size_t>> successors(count);
+    unique_ptr<atomic<int>[]> waiting(new atomic<int>[count]);
+    unordered_map<const void*, size_t> lastUser;
+    unordered_map<Territory*, vector<Player*>> attackers;    // who may have conquered a territory by then
+    vector<const void*> touched;
+    for (size_t i = 0; i < count; i++) {
+        waiting[i].store(0);
+        Player* player = sequence[begin + i].first;
+        Orders* order = sequence[begin + i].second;
+        Territory* source = order->getMap()->getTerritory(order->getSourceId());
+        Territory* target = order->getMap()->getTerritory(order->getTargetId());
+
+        touched.assign({player, source, target});
+        if (order->getKind() == OrderKind::Advance) {
+            // An advance attacks whoever owns the target when it runs: the owner now, or an earlier attacker
+            vector<Player*>& earlier = attackers[target];
+            bool mayAttack = target->getOwner() != player;
+            touched.push_back(target->getOwner());
+            for (Player* attacker : earlier) {
+                touched.push_back(attacker);
+                mayAttack = mayAttack || attacker != player;
+            }
+            if (mayAttack) {
+                touched.push_back(&CONQUEST);
+                if (find(earlier.begin(), earlier.end(), player) == earlier.end()) {
+                    earlier.push_back(player);
+                }
+            }
+        }
+
+        for (const void* resource : touched) {
+            if (resource == nullptr) {
+                continue;
+            }
+            auto [last, first] = lastUser.try_emplace(resource, i);
+            if (first || last->second == i) {
+                continue;
+            }
+            vector<size_t>& next = successors[last->second];
+            if (next.empty() || next.back() != i) {
+                next.push_back(i);
+                waiting[i]++;
+            }
+            last->second = i;
+        }
+    }
+
+    int threads = static_cast<int>(min<size_t>(threadCount, count));
+    unique_ptr<WorkQueue[]> queues(new WorkQueue[threads]);
+    size_t dealt = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (waiting[i] == 0) {
+            queues[dealt++ % threads].orders.push_back(i);
+        }
+    }
+
+    vector<ostringstream> outputs(count);
+    atomic<size_t> remaining(count);
+    auto work = [&](int self) {
+        while (remaining > 0) {
+            size_t order = count;
+            {
+                lock_guard<mutex> guard(queues[self].lock);
+                if (!queues[self].orders.empty()) {
+                    order = queues[self].orders.back();
+                    queues[self].orders.pop_back();
+                }
+            }
+            for (int k = 1; order == count && k < threads; k++) {
+                WorkQueue& victim = queues[(self + k) % threads];
+                lock_guard<mutex> guard(victim.lock);
+                if (!victim.orders.empty()) {
+                    order = victim.orders.front();
+                    victim.orders.pop_front();
+                }
+            }
+            if (order == count) {
+                this_thread::yield();
+                continue;
+            }
+
+            setOrderOutput(&outputs[order]);
+            task(begin + order);
+            setOrderOutput(nullptr);
+
+            for (size_t next : successors[order]) {
+                if (--waiting[next] == 0) {
+                    lock_guard<mutex> guard(queues[self].lock);
+                    queues[self].orders.push_back(next);
+                }
+            }
+            remaining--;
+        }
+    };
+
+    streambuf* console = cout.rdbuf();
+    OrderOutputRouter router(console);
+    cout.rdbuf(&router);
+    vector<thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.emplace_back(work, i);
+    }
+    work(0);
+    for (thread& t : pool) {
+        t.join();
+    }
+    cout.rdbuf(console);
+
+    for (ostringstream& output : outputs) {
+        cout << output.str();
+    }
+    cout.flush();
+}
@@ -0,0 +1,57 @@
+// OrderScheduler.h
+#ifndef ORDERSCHEDULER_H
+#define ORDERSCHEDULER_H
+
+#include "Orders.h"
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Sequential runs the orders one at a time; Parallel runs those that do not conflict at the same time
+enum class OrderExecutionMode { Sequential, Parallel };
+
+// Reads "sequential", "parallel" (one thread per core) or "parallel:N" (N threads), false for anything else
+bool parseOrderExecutionMode(const string& text, OrderExecutionMode& mode, int& threadCount);
+
+// An order and the player who issued it
+typedef pair<Player*, Orders*> IssuedOrder;
+
+/**
+ * OrderScheduler executes a sequence of orders on several threads, with the same result as executing
+ * them one after the other
+ * Each order touches a set of territories and players: its own territories, the player who issued it,
+ * for an advance every player who may own its target by then (the owner now, or an earlier attacker),
+ * and for an attack what a conquest changes (the reward deck, the map's ownership tables)
+ * Two orders that share one conflict, and the later waits for the last earlier order it conflicts with.
+ * The orders of this conflict graph that are ready are run by a work-stealing pool: each thread takes
+ * the orders released by its own from the back of its queue, and steals from the front of the others'
+ * when it runs out
+ * The output of each order is captured and printed in sequence order once the orders are done
+ * Orders the graph cannot describe run alone, once every earlier order is done: those not bound to the
+ * map, and the card orders (they share the deck, the players' hands and the neutral player)
+ */
+class OrderScheduler {
+    private:
+        int threadCount;
+
+        void runBatch(const vector<IssuedOrder>& sequence, size_t begin, size_t end, const function<void(size_t)>& task) const;
+
+    public:
+        // Constructors
+        OrderScheduler(int threadCount = 0);    // 0: one thread per core
+
+        // Getters
+        int getThreadCount() const;
+
+        // Setters
+        void setThreadCount(int count);
+
+        // Calls task(i) for every order of the sequence, which executes sequence[i] and what follows it
+        // (e.g. playing its card); task must only touch what the order does
+        void execute(const vector<IssuedOrder>& sequence, const function<void(size_t)>& task) const;
+};
+
+#endif
@@ -17,40 +17,222 @@
 
 
 #include "Orders.h"
+#include <atomic>
+#include <mutex>
+
+// Handles are never reused, so a handle kept after its order was removed matches nothing
+static atomic<OrderHandle> nextOrderHandle(NO_ORDER + 1);
+
+// Where the orders of this thread print, nullptr for cout
+static thread_local ostream* orderStream = nullptr;
+
+ostream& orderOutput() {
+    return (orderStream != nullptr) ? *orderStream : cout;
+}
+
+void setOrderOutput(ostream* stream) {
+    orderStream = stream;
+}
+
+//-------------------------------------------------------------------------
+//ORDERPOOL
+
+namespace {
+
+const size_t SLOT_ALIGN = 16;
+const size_t SIZE_CLASSES = 16;                          // slots of 16, 32, ... 256 bytes
+const size_t CHUNK_SIZE = 64 * 1024;
+
+struct FreeSlot {
+    FreeSlot* next;
+};
+
+// Shared by all threads: the chunks, and the free slots of the threads that exited
+struct Depot {
+    mutex lock;
+    vector<void*> chunks;
+    FreeSlot* free[SIZE_CLASSES] = {};
+};
+
+// Never destroyed, orders may still be deleted while the program's statics are
+Depot& depot() {
+    static Depot* instance = new Depot();
+    return *instance;
+}
+
+void pushAll(FreeSlot*& list, FreeSlot* slots) {
+    while (slots != nullptr) {
+        FreeSlot* next = slots->next;
+        slots->next = list;
+        list = slots;
+        slots = next;
+    }
+}
+
+// Trivially destructible, so it can still be read once the thread's cache is gone
+thread_local bool cacheRetired = false;
+
+struct Cache {
+    FreeSlot* free[SIZE_CLASSES] = {};
+
+    ~Cache() {
+        Depot& shared = depot();
+        lock_guard<mutex> guard(shared.lock);
+        for (size_t sizeClass = 0; sizeClass < SIZE_CLASSES; sizeClass++) {
+            pushAll(shared.free[sizeClass], free[sizeClass]);
+            free[sizeClass] = nullptr;
+        }
+        cacheRetired = true;
+    }
+};
+
+thread_local Cache cache;
+
+// A new chunk cut into slots of the size class (the depot's lock is held)
+FreeSlot* carve(Depot& shared, size_t sizeClass) {
+    size_t slotSize = (sizeClass + 1) * SLOT_ALIGN;
+    char* chunk = static_cast<char*>(::operator new(CHUNK_SIZE));
+    shared.chunks.push_back(chunk);
+    FreeSlot* slots = nullptr;
+    for (size_t offset = (CHUNK_SIZE / slotSize) * slotSize; offset > 0; offset -= slotSize) {
+        FreeSlot* slot = reinterpret_cast<FreeSlot*>(chunk + offset - slotSize);
+        slot->next = slots;
+        slots = slot;
+    }
+    return slots;
+}
+
+// Free slots of the size class for a thread: all of the depot's if it has any, else a new chunk
+FreeSlot* refill(size_t sizeClass) {
+    Depot& shared = depot();
+    lock_guard<mutex> guard(shared.lock);
+    FreeSlot* slots = shared.free[sizeClass];
+    shared.free[sizeClass] = nullptr;
+    return (slots != nullptr) ? slots : carve(shared, sizeClass);
+}
+
+size_t sizeClassOf(size_t size) {
+    return (size == 0) ? SIZE_CLASSES : (size + SLOT_ALIGN - 1) / SLOT_ALIGN - 1;
+}
+
+}
+
+// Orders too large for a slot come from the heap
+void* OrderPool::allocate(size_t size) {
+    size_t sizeClass = sizeClassOf(size);
+    if (sizeClass >= SIZE_CLASSES) {
+        return ::operator new(size);
+    }
+    if (cacheRetired) {
+        Depot& shared = depot();
+        lock_guard<mutex> guard(shared.lock);
+        if (shared.free[sizeClass] == nullptr) shared.free[sizeClass] = carve(shared, sizeClass);
+        FreeSlot* slot = shared.free[sizeClass];
+        shared.free[sizeClass] = slot->next;
+        return slot;
+    }
+    FreeSlot*& slots = cache.free[sizeClass];
+    if (slots == nullptr) slots = refill(sizeClass);
+    FreeSlot* slot = slots;
+    slots = slot->next;
+    return slot;
+}
+
+void OrderPool::deallocate(void* block, size_t size) {
+    size_t sizeClass = sizeClassOf(size);
+    if (sizeClass >= SIZE_CLASSES) {
+        ::operator delete(block);
+        return;
+    }
+    FreeSlot* slot = static_cast<FreeSlot*>(block);
+    if (cacheRetired) {
+        Depot& shared = depot();
+        lock_guard<mutex> guard(shared.lock);
+        slot->next = shared.free[sizeClass];
+        shared.free[sizeClass] = slot;
+        return;
+    }
+    slot->next = cache.free[sizeClass];
+    cache.free[sizeClass] = slot;
+}
+
+size_t OrderPool::getChunkCount() {
+    Depot& shared = depot();
+    lock_guard<mutex> guard(shared.lock);
+    return shared.chunks.size();
+}
+
+//-------------------------------------------------------------------------
+//ORDERS
+
+void* Orders::operator new(size_t size) {
+    return OrderPool::allocate(size);
+}
+
+void Orders::operator delete(void* block, size_t size) {
+    OrderPool::deallocate(block, size);
+}
 
 
 
 
 
 Orders::Orders(){
-  this->numberOfArmyUnits = make_unique<int>(0);
-  this->sourceTerritory = make_unique<string>("");
-  this->targetTerritory = make_unique<string>("");
+  this->numberOfArmyUnits = 0;
+  this->map = nullptr;
+  this->sourceId = NO_TERRITORY;
+  this->targetId = NO_TERRITORY;
+  this->handle = nextOrderHandle++;
 };
 
 Orders::Orders(int numberOfArmyUnits , string sourceTerritory , string targetTerritory){
-  (*this).numberOfArmyUnits = make_unique<int>(numberOfArmyUnits); //another way
-  this->sourceTerritory = make_unique<string>(sourceTerritory);
-  this->targetTerritory = make_unique<string>(targetTerritory);
+  (*this).numberOfArmyUnits = numberOfArmyUnits; //another way
+  this->sourceTerritory = std::move(sourceTerritory);
+  this->targetTerritory = std::move(targetTerritory);
+  this->map = nullptr;
+  this->sourceId = NO_TERRITORY;
+  this->targetId = NO_TERRITORY;
+  this->handle = nextOrderHandle++;
+};
+
+// Issued with the territories themselves: the ids are read off them, no name is looked up or copied
+Orders::Orders(int numberOfArmyUnits , Territory* sourceTerritory , Territory* targetTerritory) : Orders() {
+  this->numberOfArmyUnits = numberOfArmyUnits;
+  if (sourceTerritory->getMap() != nullptr && sourceTerritory->getMap() == targetTerritory->getMap()) {
+    this->map = sourceTerritory->getMap();
+    this->sourceId = sourceTerritory->getId();
+    this->targetId = targetTerritory->getId();
+  } else {
+    this->sourceTerritory = sourceTerritory->getName();
+    this->targetTerritory = targetTerritory->getName();
+  }
 };
 
 
 Orders::Orders(const Orders& otherOrder){
-  this->numberOfArmyUnits = make_unique<int>(*otherOrder.numberOfArmyUnits);
+  this->numberOfArmyUnits = otherOrder.numberOfArmyUnits;
   //why do we use new  , so that each orders mebers have a separate location in the heap memory
   //as the memebers are pointers we do not want multiple pointers pointing to the same location in memory
   //that would be a shallow copy and could cause problems suppose we deleted on pointer the other would become a dangling pointer
 
-  this->sourceTerritory = make_unique<string>(*otherOrder.sourceTerritory);
-  this->targetTerritory = make_unique<string>(*otherOrder.targetTerritory);
+  this->sourceTerritory = otherOrder.sourceTerritory;
+  this->targetTerritory = otherOrder.targetTerritory;
+  this->map = otherOrder.map;   // the map is shared by the game, not owned by the order
+  this->sourceId = otherOrder.sourceId;
+  this->targetId = otherOrder.targetId;
+  this->handle = nextOrderHandle++;   // a copy is another order
+  this->kind = otherOrder.kind;
 
 };
 
 Orders& Orders::operator=(const Orders& otherOrder){
   if(this != &otherOrder){
-    *numberOfArmyUnits =  *otherOrder.numberOfArmyUnits;
-    *sourceTerritory = *otherOrder.sourceTerritory;
-    *targetTerritory = *otherOrder.targetTerritory;
+    numberOfArmyUnits =  otherOrder.numberOfArmyUnits;
+    sourceTerritory = otherOrder.sourceTerritory;
+    targetTerritory = otherOrder.targetTerritory;
+    map = otherOrder.map;
+    sourceId = otherOrder.sourceId;
+    targetId = otherOrder.targetId;
   }
   return *this;
 
@@ -58,34 +240,121 @@ Orders& Orders::operator=(const Orders& otherOrder){
 };
 
 int Orders::getNumberOfArmyUnits() const{ //const method makes sure to not modify the object , const objects can only use cconst methods like using setter on const obj is not allowed
-  return *numberOfArmyUnits;
+  return numberOfArmyUnits;
 };
-string Orders::getSourceTerritory() const{
-  return *sourceTerritory;
+const string& Orders::getSourceTerritory() const{
+  return (map != nullptr && sourceId != NO_TERRITORY) ? map->getTerritory(sourceId)->getName() : sourceTerritory;
 };
-string Orders::getTargetTerritory() const{
-  return *targetTerritory;
+const string& Orders::getTargetTerritory() const{
+  return (map != nullptr && targetId != NO_TERRITORY) ? map->getTerritory(targetId)->getName() : targetTerritory;
 };
 void Orders::setNumberOfArmyUnits(int numberOfArmyUnits) {
-  *this->numberOfArmyUnits = numberOfArmyUnits;
+  this->numberOfArmyUnits = numberOfArmyUnits;
 };
 
 void Orders::setSourceTerritory(string sourceTerritory) {
-  *this->sourceTerritory = sourceTerritory;
+  this->sourceTerritory = std::move(sourceTerritory);
+  this->sourceId = (map != nullptr) ? map->findTerritoryId(this->sourceTerritory) : NO_TERRITORY;
 };
 void Orders::setTargetTerritory(string targetTerritory) {
-  *this->targetTerritory = targetTerritory;
+  this->targetTerritory = std::move(targetTerritory);
+  this->targetId = (map != nullptr) ? map->findTerritoryId(this->targetTerritory) : NO_TERRITORY;
+};
+
+void Orders::bind(Map* map) {
+  // The names of an order issued with territories are read off its current map first
+  this->sourceTerritory = getSourceTerritory();
+  this->targetTerritory = getTargetTerritory();
+  this->map = map;
+  this->sourceId = (map != nullptr) ? map->findTerritoryId(sourceTerritory) : NO_TERRITORY;
+  this->targetId = (map != nullptr) ? map->findTerritoryId(targetTerritory) : NO_TERRITORY;
+};
+
+Map* Orders::getMap() const{
+  return map;
+};
+TerritoryId Orders::getSourceId() const{
+  return sourceId;
+};
+TerritoryId Orders::getTargetId() const{
+  return targetId;
+};
+OrderHandle Orders::getHandle() const{
+  return handle;
+};
+
+OrderKind Orders::getKind() const{
+  return kind;
+};
+
+OrderPhase Orders::getPhase() const{
+  switch (kind) {
+    case OrderKind::Deploy: return OrderPhase::Deploy;
+    case OrderKind::Negotiate: return OrderPhase::Diplomacy;
+    default: return OrderPhase::Main;
+  }
+};
+
+// The kind names the concrete type, so the qualified calls bind statically (no vtable lookup)
+int Orders::run(Player& player){
+  switch (kind) {
+    case OrderKind::Deploy: return static_cast<DeployOrder*>(this)->DeployOrder::execute(player);
+    case OrderKind::Negotiate: return static_cast<Negotiate*>(this)->Negotiate::execute(player);
+    case OrderKind::Bomb: return static_cast<Bomb*>(this)->Bomb::execute(player);
+    case OrderKind::Airlift: return static_cast<Airlift*>(this)->Airlift::execute(player);
+    case OrderKind::Advance: return static_cast<Advance*>(this)->Advance::execute(player);
+    case OrderKind::Blockade: return static_cast<Blockade*>(this)->Blockade::execute(player);
+  }
+  return execute(player);
+};
+
+// An order issued by name is bound on first use to the map of the player's territories
+void Orders::bindToPlayer(Player& player) {
+  if (map == nullptr && !player.getDefendCollection()->empty()) {
+    Map* playerMap = player.getDefendCollection()->front()->getMap();
+    if (playerMap != nullptr) bind(playerMap);
+  }
+};
+
+// Territories outside any map (built by hand, e.g. in the drivers) are still searched by name,
+// among the player's territories and their neighbors
+Territory* Orders::findByName(Player& player, const string& name) {
+  for (auto* terr : *player.getDefendCollection()) {
+    if (terr->getName() == name) return terr;
+  }
+  for (auto* terr : *player.getDefendCollection()) {
+    for (auto* neighbor : terr->getAdjacentTerritories()) {
+      if (neighbor->getName() == name) return neighbor;
+    }
+  }
+  return nullptr;
+};
+
+// The territories the order names, nullptr if there is none
+Territory* Orders::getSource(Player& player) {
+  bindToPlayer(player);
+  return (map != nullptr) ? map->getTerritory(sourceId) : findByName(player, sourceTerritory);
+};
+Territory* Orders::getTarget(Player& player) {
+  bindToPlayer(player);
+  return (map != nullptr) ? map->getTerritory(targetId) : findByName(player, targetTerritory);
+};
+
+// A territory can only be attacked when it is in the player's attack list (the strategy picks it)
+bool Orders::isAttackTarget(Player& player, Territory* territory) {
+  vector<Territory*>* targets = player.toAttack();
+  return find(targets->begin(), targets->end(), territory) != targets->end();
 };
 
 
 int Orders::execute(Player& player){
-  cout<<"Orders is getting executed" <<endl;
+  orderOutput()<<"Orders is getting executed" <<endl;
     notify(this);
   return 0;
 };
 
 bool Orders::validate(Player& player){
-  cout<<"Order is validated" <<endl;
+  orderOutput()<<"Order is validated" <<endl;
   return true;
 };
 
@@ -112,9 +381,12 @@ std::string Orders::stringToLog() {
 
 //to select which base constructor runs in the initializer list is decided rightafter the : 
 DeployOrder::DeployOrder( int numberOfArmyUnits , string sourceTerritory  , string targetTerritory)
-    : Orders(numberOfArmyUnits , sourceTerritory , targetTerritory) {};
+    : Orders(numberOfArmyUnits , sourceTerritory , targetTerritory) { kind = OrderKind::Deploy; };
+
+DeployOrder::DeployOrder(int numberOfArmyUnits, Territory* sourceTerritory, Territory* targetTerritory)
+    : Orders(numberOfArmyUnits, sourceTerritory, targetTerritory) { kind = OrderKind::Deploy; };
 
-DeployOrder::DeployOrder() : Orders(){};
+DeployOrder::DeployOrder() : Orders() { kind = OrderKind::Deploy; };
 
 DeployOrder::DeployOrder(const DeployOrder& deploy) : Orders::Orders(static_cast<const Orders&>(deploy)) {};
 
@@ -137,45 +409,40 @@ DeployOrder& DeployOrder::operator=(const DeployOrder& otherDeployOrder){
 
 int DeployOrder::execute(Player& player){
   if (!validate(player)) {
-        cout << "Invalid Deploy order." << endl;
+        orderOutput() << "Invalid Deploy order." << endl;
         return -1;
     }
 
     // find target again to apply the effect
-    for (auto* terr : *player.getDefendCollection()) {
-        if (terr->getName() == this->getTargetTerritory()) {
-            int currentArmies = terr->getArmies();
-            terr->setArmies(currentArmies + this->getNumberOfArmyUnits());
-
-            player.setReinforcementPool(
-                player.getReinforcementPool() - this->getNumberOfArmyUnits()
-            );
-
-            cout << "Deployed " << this->getNumberOfArmyUnits()
-                 << " armies to " << terr->getName() << ".\n";
-            cout << "Remaining reinforcement pool: "
-                 << player.getReinforcementPool() << endl;
-            break;
-        }
-    }
+    Territory* terr = getTarget(player);
+    int currentArmies = terr->getArmies();
+    terr->setArmies(currentArmies + this->getNumberOfArmyUnits());
+
+    player.setReinforcementPool(
+        player.getReinforcementPool() - this->getNumberOfArmyUnits()
+    );
+
+    orderOutput() << "Deployed " << this->getNumberOfArmyUnits()
+         << " armies to " << terr->getName() << ".\n";
+    orderOutput() << "Remaining reinforcement pool: "
+         << player.getReinforcementPool() << endl;
      notify(this);
     return 0; // success
 }
 
 bool DeployOrder::validate(Player& player){
       // check if target territory belongs to this player
-    for (auto* terr : *player.getDefendCollection()) {
-        if (terr->getName() == this->getTargetTerritory()) {
-            // check reinforcement availability
-            if (this->getNumberOfArmyUnits() <= player.getReinforcementPool())
-                return true;
-            else {
-                cout << "Not enough armies in reinforcement pool." <<endl;
-                return false;
-            }
+    Territory* terr = getTarget(player);
+    if (terr != nullptr && terr->getOwner() == &player) {
+        // check reinforcement availability
+        if (this->getNumberOfArmyUnits() <= player.getReinforcementPool())
+            return true;
+        else {
+            orderOutput() << "Not enough armies in reinforcement pool." <<endl;
+            return false;
         }
     }
-    cout << "Target territory not owned by player." <<endl;
+    orderOutput() << "Target territory not owned by player." <<endl;
     return false;
 }
 
@@ -189,19 +456,24 @@ DeployOrder* DeployOrder::clone() const{
 //NEGOTIATE SUBCLASS METHOD IMPLEMENTATIONS
 //TODO: i made change to the constructor of the Negotiate order as we need a Target player with home the issuing player sets a pact
 Negotiate::Negotiate(int numberOfArmyUnits, string sourceTerritory, string targetTerritory , string enemy) 
-    : Orders(numberOfArmyUnits, sourceTerritory, targetTerritory)  , enemy(enemy) {};
+    : Orders(numberOfArmyUnits, sourceTerritory, targetTerritory)  , enemy(enemy) { kind = OrderKind::Negotiate; };
 
-Negotiate::Negotiate() : Orders(){};
+Negotiate::Negotiate(int numberOfArmyUnits, string sourceTerritory, string targetTerritory , Player* enemy)
+    : Orders(numberOfArmyUnits, sourceTerritory, targetTerritory)  , enemy(enemy->getName()), enemyId(enemy->getId()) { kind = OrderKind::Negotiate; };
+
+Negotiate::Negotiate() : Orders() { kind = OrderKind::Negotiate; };
 
 Negotiate::Negotiate(const Negotiate& otherNegotiate)
     : Orders(static_cast<const Orders&>(otherNegotiate)) {
     this->enemy = otherNegotiate.getEnemy();  // shallow copy of pointer, not ownership
+    this->enemyId = otherNegotiate.enemyId;
 }
 
 
 Negotiate& Negotiate::operator=(const Negotiate& otherNegotiate) {
     if (this != &otherNegotiate) {
         Orders::operator=(static_cast<const Orders&>(otherNegotiate));
+        this->enemyId = otherNegotiate.enemyId;
         this->enemy = otherNegotiate.enemy; // why would i need a deep copy if something happens to the player i would like it to be reflected in the player rather than a copy of the payer 
     }
     return *this;
@@ -223,92 +495,19 @@ ostream& operator<<(ostream& os, const Negotiate& negotiate) {
 
 int Negotiate::execute(Player& player){
     if (!validate(player)) {
-        cout << "Negotiate order execution aborted." << endl;
+        orderOutput() << "Negotiate order execution aborted." << endl;
         return -1;
     }
 
-       
-    //now we need to find the targetPlayer using the name of the enemy the issuing players wants to negotiate
-    Player* targetPlayer = nullptr;
-    for(auto* it : *player.toAttack()){
-        if(it->getOwner()->getName() == this->enemy){  //there's an enemy name that is the data member of the Negotiate Order 
-            targetPlayer = it->getOwner();
-        };
-    }
+    // The pact lasts until the end of the turn: Bomb and Advance orders between the two players
+    // fail validation from now on
+    Player* targetPlayer = findEnemy(player);
+    player.getDiplomacy()->addPact(player.getId(), targetPlayer->getId());
 
-    // Mutual diplomacy setup
-    player.negotiatedWith.push_back(targetPlayer);
-    //FIXME: okay pkayer is a raw pointer , negotiateWith is a vector of unique pointers to players , my target player also unique but issuing player raw , that is what forms incocnsistencies 
-    //keep the negotiatedWith vector of raw pointers ,and make target also raw but delete it / memeory management 
-    
-    targetPlayer->negotiatedWith.push_back(&player);
-    //At this point a pact has been formed between issuin player and the target player 
-
-
-    cout << "Diplomacy established between " << player.getName()
+    orderOutput() << "Diplomacy established between " << player.getName()
         << " and " << targetPlayer->getName()
         << ". They cannot attack each other this turn." << endl;
 
-        //here is what we need to moving forward to make this Negotiate order effective 
-        //first scan through the list of Issuing player an remove any attacking order from the orderlist 
-        //then we move over to the orderlist of the enemy and do the same as mentioned before 
-        //so this would ensure the attacking orders involving these two players are cancelled which is the result of the negotiation 
-        //between both the player 
-
-
-    //Handling the attack orders in Players orderlist oki buddy
-   
-   vector<Orders*> issuerRemovals;
-
-    for (auto& uptr : player.getOrderList()->orderList) {
-        Orders* ord = uptr.get();
-        if (!ord) continue;
-
-        // Only attack-capable orders
-        if (!(typeid(*ord) == typeid(Bomb) || typeid(*ord) == typeid(Advance)))
-            continue;
-
-        // Check if this order attacks a territory owned by targetPlayer
-        for (auto* terr : *player.toAttack()) {
-            if (terr->getName() == ord->getTargetTerritory() &&
-                terr->getOwner() == targetPlayer) {
-
-                issuerRemovals.push_back(ord);
-                break;
-            }
-        }
-    }
-
-
-    for(auto* doomed : issuerRemovals){
-        player.getOrderList()->remove(*doomed);
-    }
-            
-
-    //the same process of eviction of the attack orders but for enemy players 
-    vector<Orders*> targetRemovals;
-
-    for (auto& uptr : targetPlayer->getOrderList()->orderList) {
-        Orders* ord = uptr.get();
-        if (!ord) continue;
-
-        if (!(typeid(*ord) == typeid(Bomb) || typeid(*ord) == typeid(Advance)))
-            continue;
-
-        for (auto* terr : *targetPlayer->toAttack()) {
-            if (terr->getName() == ord->getTargetTerritory() &&
-                terr->getOwner() == &player) { //
-
-                targetRemovals.push_back(ord);
-                break;
-            }
-        }
-    }
-
-
-    for(auto* doomed : targetRemovals){
-        targetPlayer->getOrderList()->remove(*doomed);
-    }
     notify(this);
     return 0; // success
 }
@@ -328,34 +527,43 @@ int Negotiate::execute(Player& player){
       }
 
       if (!hasDiplomacyCard) {
-          cout << "NEGOTIATE ORDER INVALID: Player does not have a diplomacy card in hand." <<endl;
+          orderOutput() << "NEGOTIATE ORDER INVALID: Player does not have a diplomacy card in hand." <<endl;
           return false;
       }
 
       
-     Player* targetPlayer = nullptr;
-    //  cout<<"Entering the for loop" <<endl;
-    for(auto* it : *player.toAttack()){
-        // cout<<(it->getOwner()->getName());
-        // cout<<(it->getOwner()->getName() == enemy) <<endl;
-
-        if(it->getOwner()->getName() == enemy){
-            targetPlayer = it->getOwner();
-        };
-    }
+     // The enemy is one of the players of the issuing player's game
+     Player* targetPlayer = findEnemy(player);
     if ( targetPlayer == nullptr) {
-            cout << "INVALID NEGOTIATE ORDER: Target player not specified." <<endl;
+            orderOutput() << "INVALID NEGOTIATE ORDER: Target player not specified." <<endl;
             return false;
         }
         if (targetPlayer == &player) {
-            cout << "INVALID NEGOTIATE ORDER: Cannot negotiate with yourself." <<endl;
+            orderOutput() << "INVALID NEGOTIATE ORDER: Cannot negotiate with yourself." <<endl;
             return false;
         }
-        cout << "Negotiate order validated between " << player.getName()
+        orderOutput() << "Negotiate order validated between " << player.getName()
             << " and " << targetPlayer->getName() << "." <<endl;
         return true;
 }
 
+// The enemy by id in the player's Diplomacy: an order issued by name looks its enemy up once and keeps
+// the id. nullptr when the enemy is not (or no longer) in the player's game
+Player* Negotiate::findEnemy(Player& player){
+    Diplomacy* diplomacy = player.getDiplomacy();
+    if (diplomacy == nullptr) {
+        return nullptr;
+    }
+    if (enemyId == NO_PLAYER) {
+        Player* named = diplomacy->findPlayer(enemy);
+        if (named == nullptr) {
+            return nullptr;
+        }
+        enemyId = named->getId();
+    }
+    return diplomacy->getPlayer(enemyId);
+}
+
 // This function will create a deep copy of the Negotiate object
 Negotiate* Negotiate::clone() const{ 
     return new Negotiate(*this);
@@ -364,9 +572,12 @@ Negotiate* Negotiate::clone() const{
 //-------------------------------------------------------------------------------
 //BOMB SUBCLASS METHOD IMPLEMENTATION
 Bomb::Bomb(int numberOfArmyUnits, string sourceTerritory, string targetTerritory)
-    : Orders(numberOfArmyUnits, sourceTerritory, targetTerritory) {};
+    : Orders(numberOfArmyUnits, sourceTerritory, targetTerritory) { kind = OrderKind::Bomb; };
+
+Bomb::Bomb(int numberOfArmyUnits, Territory* sourceTerritory, Territory* targetTerritory)
+    : Orders(numberOfArmyUnits, sourceTerritory, targetTerritory) { kind = OrderKind::Bomb; };
 
-Bomb::Bomb() : Orders(){};
+Bomb::Bomb() : Orders() { kind = OrderKind::Bomb; };
     
 Bomb::Bomb(const Bomb& otherBomb) : Orders(static_cast<const Orders&>(otherBomb)){};
 
@@ -390,21 +601,15 @@ void Bomb::print(ostream& os) const{
 int Bomb::execute(Player& player){
     // Validate before execution
     if (!validate(player)) {
-        cout << "Bomb order aborted due to failed validation." <<endl;
+        orderOutput() << "Bomb order aborted due to failed validation." <<endl;
         return -1;
     }
 
     // Step 1: Find target territory again (for applying effect)
-    Territory* targetTerr = nullptr;
-    for (auto* terr : *player.toAttack()) {
-        if (terr->getName() == this->getTargetTerritory()) {
-            targetTerr = terr;
-            break;
-        }
-    }
+    Territory* targetTerr = getTarget(player);
 
     if (!targetTerr) {
-        cout << "Target territory not found during execution." <<endl;
+        orderOutput() << "Target territory not found during execution." <<endl;
         return -1;
     }
 
@@ -421,7 +626,7 @@ int Bomb::execute(Player& player){
     int currentArmies = targetTerr->getArmies();
     targetTerr->setArmies(currentArmies / 2);
 
-    cout << "Bomb order successfully executed! "
+    orderOutput() << "Bomb order successfully executed! "
         << targetTerr->getName() << " armies halved from "
         << currentArmies << " -> " << targetTerr->getArmies() 
         << "." <<endl;
@@ -432,7 +637,7 @@ int Bomb::execute(Player& player){
         std::transform(type.begin(), type.end(), type.begin(), ::tolower);
         if (type == "bomb") {
             player.getHand()->hand->erase(it);
-            cout << "Bomb card removed from hand after execution.\n";
+            orderOutput() << "Bomb card removed from hand after execution.\n";
             break;
         }
     }  // I DO NOT KNOW IF THIS SOMETHING THE BOMB ORDER EXECUTE HAS TO HANDLE MAYBE GAME ENGINE TAKE CARES OF THIS 
@@ -454,39 +659,37 @@ int Bomb::execute(Player& player){
       }
 
       if (!hasBombCard) {
-          cout << "BOMB ORDER INVALID: Player does not have a Bomb card in hand." <<endl;
+          orderOutput() << "BOMB ORDER INVALID: Player does not have a Bomb card in hand." <<endl;
           return false;
       }
 
       // Step 2: Ensure target territory is NOT owned by the issuing player
-      for (auto* terr : *player.getDefendCollection()) {
-          if (terr->getName() == this->getTargetTerritory()) {
-              cout << "BOMB ORDER INVALID: Target territory is owned by the player." <<endl;
-              return false;
-          }
-      }
-
-      // Step 3: Find source and target territories
-      Territory* sourceTerr = nullptr;
-      Territory* targetTerr = nullptr;
-
-      for (auto* terr : *player.getDefendCollection()) {
-          if (terr->getName() == this->getSourceTerritory())
-              sourceTerr = terr;
+      Territory* targetTerr = getTarget(player);
+      if (targetTerr != nullptr && targetTerr->getOwner() == &player) {
+          orderOutput() << "BOMB ORDER INVALID: Target territory is owned by the player." <<endl;
+          return false;
       }
-      for (auto* terr : *player.toAttack()) {
-          if (terr->getName() == this->getTargetTerritory())
-              targetTerr = terr;
+      if (targetTerr != nullptr && player.hasPactWith(targetTerr->getOwner())) {
+          orderOutput() << "BOMB ORDER INVALID: " << player.getName() << " negotiated with "
+              << targetTerr->getOwner()->getName() << " this turn." <<endl;
+          return false;
       }
 
+      // Step 3: Find source and target territories (the target must be one the player can attack)
+      if (targetTerr != nullptr && !isAttackTarget(player, targetTerr))
+          targetTerr = nullptr;
+      Territory* sourceTerr = getSource(player);
+      if (sourceTerr != nullptr && sourceTerr->getOwner() != &player)
+          sourceTerr = nullptr;
+
       if (!sourceTerr || !targetTerr) { //also test sourceTerr == nullptr;
-          cout << "BOMB ORDER INVALID: Source or target territory not found." <<endl;
+          orderOutput() << "BOMB ORDER INVALID: Source or target territory not found." <<endl;
           return false;
       }
 
       // Step 4: Check adjacency
       if (sourceTerr->isAdjacent(targetTerr) == false) {
-          cout << "BOMB ORDER INVALID: Source and target are not adjacent." <<endl;
+          orderOutput() << "BOMB ORDER INVALID: Source and target are not adjacent." <<endl;
           return false;
       }
 
@@ -501,9 +704,11 @@ Bomb* Bomb::clone() const{
 //--------------------------------------------------------------------------------
 //ADVANCE SUBCLASS METHOD IMPLEMENTATION
 
-Advance::Advance(int numberOfArmyUnits , string sourceTerritory , string targetTerritory) : Orders(numberOfArmyUnits , sourceTerritory , targetTerritory) {};
+Advance::Advance(int numberOfArmyUnits , string sourceTerritory , string targetTerritory) : Orders(numberOfArmyUnits , sourceTerritory , targetTerritory) { kind = OrderKind::Advance; };
+
+Advance::Advance(int numberOfArmyUnits, Territory* sourceTerritory, Territory* targetTerritory) : Orders(numberOfArmyUnits, sourceTerritory, targetTerritory) { kind = OrderKind::Advance; };
 
-Advance::Advance() : Orders(){};
+Advance::Advance() : Orders() { kind = OrderKind::Advance; };
 
 Advance::Advance(const Advance& otherAdvance) : Orders(static_cast<const Orders&>(otherAdvance)){
  
@@ -528,32 +733,18 @@ Advance& Advance::operator=(const Advance& advance){
 // ...existing code...
 int Advance::execute(Player& player) {
     if (!validate(player)) {
-        cout << "Advance order execution aborted." << endl;
+        orderOutput() << "Advance order execution aborted." << endl;
         return -1;
     }
 
     // Locate territories again for the effect (do NOT allocate new Territory objects)
-    Territory* sourceTerr = nullptr;
-    Territory* targetTerr = nullptr;
+    Territory* sourceTerr = getSource(player);
+    Territory* targetTerr = getTarget(player);
     Territory* sameTerr   = nullptr;
 
-    for (auto* terr : *player.getDefendCollection()) {
-        if (terr->getName() == this->getSourceTerritory()) {
-            sourceTerr = terr;
-            break;
-        }
-    }
-    for (auto* terr : *player.toAttack()) {
-        if (terr->getName() == this->getTargetTerritory()) {
-            targetTerr = terr;
-            break;
-        }
-    }
-    for (auto* terr : *player.getDefendCollection()) {
-        if (terr->getName() == this->getTargetTerritory()) {
-            sameTerr = terr;
-            break;
-        }
+    if (targetTerr->getOwner() == &player) {
+        sameTerr = targetTerr;
+        targetTerr = nullptr;
     }
 
     // // Defensive checks
@@ -564,11 +755,11 @@ int Advance::execute(Player& player) {
 
     // MOVE: target is also owned by player
     if (sameTerr != nullptr) {
-        cout << "Moving armies from " << sourceTerr->getName()
+        orderOutput() << "Moving armies from " << sourceTerr->getName()
              << " -> " << sameTerr->getName() << endl;
 
         if (this->getNumberOfArmyUnits() > sourceTerr->getArmies()) {
-            cout << "Not enough armies in source territory for move." << endl;
+            orderOutput() << "Not enough armies in source territory for move." << endl;
             return -1;
         }
 
@@ -594,24 +785,24 @@ int Advance::execute(Player& player) {
     // //extra print statement 
     // cout<<targetTerr->getOwner()->getName() <<" was Neutral and got attacked --> switching to aggressive •`_´•" << endl;
 
-    cout << "ATTACK from " << sourceTerr->getName()
+    orderOutput() << "ATTACK from " << sourceTerr->getName()
          << " -> " << targetTerr->getName() << endl;
 
     int attackingUnits = this->getNumberOfArmyUnits();
     int defendingUnits = targetTerr->getArmies();
 
     if (attackingUnits > sourceTerr->getArmies()) {
-        cout << "Invalid: trying to send more armies than available." << endl;
+        orderOutput() << "Invalid: trying to send more armies than available." << endl;
         return -1;
     }
 
     int attackerKills = round(0.6 * attackingUnits);
     int defenderKills = round(0.7 * defendingUnits);
-    cout<< player.getName() << " kills " << attackerKills << " units." <<endl;
-    cout<< targetTerr->getOwner()->getName() << " kills " <<defenderKills << " units." <<endl;
+    orderOutput()<< player.getName() << " kills " << attackerKills << " units." <<endl;
+    orderOutput()<< targetTerr->getOwner()->getName() << " kills " <<defenderKills << " units." <<endl;
     // cout<<(attackerKills >= defenderKills);
     if (attackerKills >= defenderKills) {
-        cout << player.getName() <<" WINS THE BATTLE!"<<endl;
+        orderOutput() << player.getName() <<" WINS THE BATTLE!"<<endl;
 
         int survivingAttackers = attackingUnits - defenderKills;
         sourceTerr->setArmies(sourceTerr->getArmies() - attackingUnits);
@@ -624,17 +815,18 @@ int Advance::execute(Player& player) {
         // Remove conquered territory from the defendants's list
 
         // Remove from attack list (erase by pointer)
-        auto& attackList = *player.toAttack();
-        auto it = find(attackList.begin(), attackList.end(), targetTerr);
-        if (it != attackList.end())
-            attackList.erase(it);
-
-        // Reward player with one random card
-        static Deck sharedDeck;
-        sharedDeck.draw(player.getHand());
-        cout << "Player rewarded with a card for conquering a territory." << endl;
+        player.removeFromAttack(targetTerr);
+
+        // Reward player with one random card from the game's deck (none for a player outside a game)
+        Deck* deck = player.getDeck();
+        if (deck != nullptr && *deck->deckSize > 0) {
+            deck->draw(player.getHand());
+            orderOutput() << "Player rewarded with a card for conquering a territory." << endl;
+        } else {
+            orderOutput() << "No card left to reward the conquest with." << endl;
+        }
     } else {
-        cout <<targetTerr->getOwner()->getName() <<" WINS THE BATTLE." << endl;
+        orderOutput() <<targetTerr->getOwner()->getName() <<" WINS THE BATTLE." << endl;
         int remainingDefenders = defendingUnits - attackerKills;
         targetTerr->setArmies(remainingDefenders);
         sourceTerr->setArmies(sourceTerr->getArmies() - attackingUnits);
@@ -647,37 +839,31 @@ int Advance::execute(Player& player) {
 
 
   bool Advance::validate(Player& player){
-      Territory* sourceTerr = nullptr;
-      Territory* targetTerr = nullptr;
+      // Find source and target territories (the target is a move when the player owns it, an attack
+      // on a territory of the player's attack list otherwise)
+      Territory* sourceTerr = getSource(player);
+      Territory* targetTerr = getTarget(player);
       Territory* sameTerr = nullptr;
-
-      // Find source and target territories
-      for (auto* terr : *player.getDefendCollection()) {
-          if (terr->getName() == this->getSourceTerritory())
-              sourceTerr = terr;
-      }
-      for (auto* terr : *player.toAttack()) {
-          if (terr->getName() == this->getTargetTerritory())
-              targetTerr = terr;
-      }
-       for (auto* terr : *player.getDefendCollection()) {
-          if (terr->getName() == this->getTargetTerritory())
-              sameTerr = terr;
+      if (targetTerr != nullptr && targetTerr->getOwner() == &player) {
+          sameTerr = targetTerr;
+          targetTerr = nullptr;
+      } else if (targetTerr != nullptr && !isAttackTarget(player, targetTerr)) {
+          targetTerr = nullptr;
       }
 
       // Check existence
-      if(sourceTerr == nullptr){
-        cout<<"INVALID ADVANCE ORDER: Source territory does not belong to the issuing player." <<endl;
+      if(sourceTerr == nullptr || sourceTerr->getOwner() != &player){
+        orderOutput()<<"INVALID ADVANCE ORDER: Source territory does not belong to the issuing player." <<endl;
         return false ;
       }
       if ((!targetTerr) && (!sameTerr) ) {
-          cout << "INVALID ADVANCE ORDER: Source or Target not found." << endl;
+          orderOutput() << "INVALID ADVANCE ORDER: Source or Target not found." << endl;
           return false;
       }
 
       // Check ownership of source
       if (sourceTerr->getOwner() != &player) {
-          cout << "INVALID ADVANCE ORDER: Source territory not owned by player." << endl;
+          orderOutput() << "INVALID ADVANCE ORDER: Source territory not owned by player." << endl;
           return false;
       }
 
@@ -685,21 +871,27 @@ int Advance::execute(Player& player) {
       //NOTE: had a problem here but i guess now all the edge cases are checked for (in case its a move i need to check for adjacency as well )
       if(sameTerr != nullptr){
         if (!sourceTerr->isAdjacent(sameTerr)) {
-            cout << "INVALID ADVANCE ORDER: Territories are not adjacent." <<endl;
+            orderOutput() << "INVALID ADVANCE ORDER: Territories are not adjacent." <<endl;
             return false;
         }
     }
 
     if(targetTerr != nullptr){
         if (!sourceTerr->isAdjacent(targetTerr)) {
-            cout << "INVALID ADVANCE ORDER: Territories are not adjacent." <<endl;
+            orderOutput() << "INVALID ADVANCE ORDER: Territories are not adjacent." <<endl;
+            return false;
+        }
+        // Attacks between players who negotiated this turn are blocked
+        if (player.hasPactWith(targetTerr->getOwner())) {
+            orderOutput() << "INVALID ADVANCE ORDER: " << player.getName() << " negotiated with "
+                << targetTerr->getOwner()->getName() << " this turn." <<endl;
             return false;
         }
     }
 
       // Check sufficient armies
       if (this->getNumberOfArmyUnits() > sourceTerr->getArmies()) {
-          cout << "INVALID ADVANCE ORDER: Not enough armies in source territory." << endl;
+          orderOutput() << "INVALID ADVANCE ORDER: Not enough armies in source territory." << endl;
           return false;
       }
 
@@ -713,9 +905,12 @@ int Advance::execute(Player& player) {
 //--------------------------------------------------------------------------------
 //AIRLIFT SUBCLASS METHOD IMPLEMENTATION
 Airlift::Airlift(int numberOfArmyUnits, string sourceTerritory, string targetTerritory)
-    : Orders(numberOfArmyUnits, sourceTerritory, targetTerritory) {};
+    : Orders(numberOfArmyUnits, sourceTerritory, targetTerritory) { kind = OrderKind::Airlift; };
+
+Airlift::Airlift(int numberOfArmyUnits, Territory* sourceTerritory, Territory* targetTerritory)
+    : Orders(numberOfArmyUnits, sourceTerritory, targetTerritory) { kind = OrderKind::Airlift; };
 
-Airlift::Airlift() : Orders(){};    
+Airlift::Airlift() : Orders() { kind = OrderKind::Airlift; };
 
 Airlift::Airlift(const Airlift& otherAirlift) : Orders(static_cast<const Orders&>(otherAirlift)){
 
@@ -740,33 +935,23 @@ ostream& operator<<(ostream& os, const Airlift& airlift) {
   
   int Airlift::execute(Player& player){
       if (!validate(player)) {
-          cout << "Airlift order execution aborted." << endl;
+          orderOutput() << "Airlift order execution aborted." << endl;
           return -1;
       }
 
       // Step 1: Find territories again (for actual move)
-      Territory* sourceTerr = nullptr;
-      Territory* targetTerr = nullptr;
-
-      for (auto* terr : *player.getDefendCollection()) {
-          if (terr->getName() == this->getSourceTerritory())
-              sourceTerr = terr;
-      }
-
-      for (auto* terr : *player.getDefendCollection()) {
-          if (terr->getName() == this->getTargetTerritory())
-              targetTerr = terr;
-      }
+      Territory* sourceTerr = getSource(player);
+      Territory* targetTerr = getTarget(player);
 
       // Step 2: Perform the Airlift
-      cout << "Airlifting " << this->getNumberOfArmyUnits()
+      orderOutput() << "Airlifting " << this->getNumberOfArmyUnits()
           << " armies from " << sourceTerr->getName()
           << " -> " << targetTerr->getName() << endl;
 
       sourceTerr->setArmies(sourceTerr->getArmies() - this->getNumberOfArmyUnits());
       targetTerr->setArmies(targetTerr->getArmies() + this->getNumberOfArmyUnits());
 
-      cout << "Airlift complete.\n"
+      orderOutput() << "Airlift complete.\n"
           << "Source now has " << sourceTerr->getArmies()
           << ", Target now has " << targetTerr->getArmies() 
           << " armies." << endl;
@@ -786,38 +971,28 @@ ostream& operator<<(ostream& os, const Airlift& airlift) {
         }
     }
     if (!hasAirliftCard) {
-        cout << "AIRLIFT ORDER INVALID: Player does not have an Airlift card." << endl;
+        orderOutput() << "AIRLIFT ORDER INVALID: Player does not have an Airlift card." << endl;
         return false;
     }
 
     // Step 2:  Find source and target territories
-    Territory* sourceTerr = nullptr;
-    Territory* targetTerr = nullptr;
-
-    for (auto* terr : *player.getDefendCollection()) {
-        if (terr->getName() == this->getSourceTerritory())
-            sourceTerr = terr;
-    }
-
-    for (auto* terr : *player.getDefendCollection()) {
-        if (terr->getName() == this->getTargetTerritory())
-            targetTerr = terr;
-    }
+    Territory* sourceTerr = getSource(player);
+    Territory* targetTerr = getTarget(player);
 
     if (!sourceTerr || !targetTerr) {
-        cout << "AIRLIFT ORDER INVALID: Source or Target not found." << endl;
+        orderOutput() << "AIRLIFT ORDER INVALID: Source or Target not found." << endl;
         return false;
     }
 
     // Step 3: Both territories must belong to the same player
     if (sourceTerr->getOwner() != &player || targetTerr->getOwner() != &player) {
-        cout << "AIRLIFT ORDER INVALID: Both territories must be owned by the player." << endl;
+        orderOutput() << "AIRLIFT ORDER INVALID: Both territories must be owned by the player." << endl;
         return false;
     }
 
     // Step 4:  Check if enough armies available
     if (this->getNumberOfArmyUnits() > sourceTerr->getArmies()) {
-        cout << "AIRLIFT ORDER INVALID: Not enough armies in source territory." << endl;
+        orderOutput() << "AIRLIFT ORDER INVALID: Not enough armies in source territory." << endl;
         return false;
     }
 
@@ -834,9 +1009,12 @@ ostream& operator<<(ostream& os, const Airlift& airlift) {
 // BLOCKADE SUBCLASS METHODS IMPLEMENTATION
 
 Blockade::Blockade(int numberOfArmyUnits, string sourceTerritory, string targetTerritory)
-    : Orders(numberOfArmyUnits, sourceTerritory, targetTerritory) {};
+    : Orders(numberOfArmyUnits, sourceTerritory, targetTerritory) { kind = OrderKind::Blockade; };
 
-Blockade::Blockade() : Orders(){};
+Blockade::Blockade(int numberOfArmyUnits, Territory* sourceTerritory, Territory* targetTerritory)
+    : Orders(numberOfArmyUnits, sourceTerritory, targetTerritory) { kind = OrderKind::Blockade; };
+
+Blockade::Blockade() : Orders() { kind = OrderKind::Blockade; };
 
 Blockade::Blockade(const Blockade& otherBlockade) : Orders(static_cast<const Orders&>(otherBlockade)){};
 
@@ -859,27 +1037,21 @@ ostream& operator<<(ostream& os, const Blockade& blockade) {
   
   int Blockade::execute(Player& player){
     if (!validate(player)) {
-        cout << "Blockade order execution aborted." << endl;
+        orderOutput() << "Blockade order execution aborted." << endl;
         return -1;
     }
 
     // Step 1: Find the target territory
-    Territory* target = nullptr;
-    for (auto* terr : *player.getDefendCollection()) {
-        if (terr->getName() == this->getTargetTerritory()) {
-            target = terr;
-            break;
-        }
-    }
+    Territory* target = getTarget(player);
 
     if (!target) {
-        cout << "Target territory not found, cannot execute Blockade order." << endl;
+        orderOutput() << "Target territory not found, cannot execute Blockade order." << endl;
         return -1;
     }
 
     // Step 2: Apply the blockade effect
     target->setArmies(target->getArmies() * 2);
-    cout << "Blockade executed: " << target->getName()
+    orderOutput() << "Blockade executed: " << target->getName()
          << " armies doubled to " << target->getArmies() << "." << endl;
 
     // Step 3: Transfer ownership to Neutral
@@ -892,7 +1064,7 @@ ostream& operator<<(ostream& os, const Blockade& blockade) {
     if (it != defendList.end())
         defendList.erase(it);
 
-    cout << "Territory ownership transferred to Neutral player." << endl;
+    orderOutput() << "Territory ownership transferred to Neutral player." << endl;
 
     notify(this);
     return 0; // success
@@ -922,26 +1094,21 @@ ostream& operator<<(ostream& os, const Blockade& blockade) {
     }
 
     if (!hasBlockadeCard) {
-        cout << "BLOCKADE ORDER INVALID: Player does not have a Blockade card in hand." << endl;
+        orderOutput() << "BLOCKADE ORDER INVALID: Player does not have a Blockade card in hand." << endl;
         return false;
     }
 
     // Step 2: Check if target territory belongs to player
-    bool ownsTarget = false;
-    for (auto* terr : *player.getDefendCollection()) {
-        if (terr->getName() == this->getTargetTerritory()) {
-            ownsTarget = true;
-            break;
-        }
-    }
+    Territory* target = getTarget(player);
+    bool ownsTarget = (target != nullptr && target->getOwner() == &player);
 
     if (!ownsTarget) {
-        cout << "BLOCKADE ORDER INVALID: Target territory not owned by player." << endl;
+        orderOutput() << "BLOCKADE ORDER INVALID: Target territory not owned by player." << endl;
         return false;
     }
 
     // Passed all validation checks
-    cout << "Blockade order validated successfully." << endl;
+    orderOutput() << "Blockade order validated successfully." << endl;
     return true;
   }
 
@@ -953,73 +1120,143 @@ ostream& operator<<(ostream& os, const Blockade& blockade) {
 //-------------------------------------------------------------------------
 //ORDERLIST 
 
-int found = 0;
+Orderlist::Iterator Orderlist::begin() const{
+    return Iterator(orderList.begin() + std::min(head, orderList.size()), orderList.end());
+};
 
-void Orderlist::remove(Orders& order){
-    bool flag = false;
-    
+Orderlist::Iterator Orderlist::end() const{
+    return Iterator(orderList.end(), orderList.end());
+};
 
-    for(int i =0 ; i< this->orderList.size() ; i++){ //this->orderlist represents the vector which is simply an object holding pointers to orders
-        if(typeid(*this->orderList[i]).name()  == (typeid(order)).name()){
-            //check for the equality of the rest of paramters
-           if((*this->orderList[i]).getNumberOfArmyUnits() == order.getNumberOfArmyUnits() &&
-            (*this->orderList[i]).getSourceTerritory() == order.getSourceTerritory() &&
-            (*this->orderList[i]).getTargetTerritory() == order.getTargetTerritory()){
-            
-            found = i;
-            flag= true;
-            break;
-           }
+OrderHandle Orderlist::add(std::unique_ptr<Orders> order){
+    if (tombstones > 0 && tombstones >= size()) {
+        compact();
+    }
+    OrderHandle handle = order->getHandle();
+    slots[handle] = orderList.size();
+    phaseSlots[static_cast<int>(order->getPhase())].push_back(orderList.size());
+    orderList.push_back(std::move(order));
+    return handle;
+};
+
+// Position of the order in orderList, orderList.size() if it is not in the list
+size_t Orderlist::findSlot(OrderHandle handle){
+    auto it = slots.find(handle);
+    if (it == slots.end() || it->second >= orderList.size()) {
+        return orderList.size();
+    }
+    return it->second;
+};
+
+void Orderlist::indexSlots(){
+    slots.clear();
+    for (int phase = 0; phase < ORDER_PHASE_COUNT; phase++) {
+        phaseSlots[phase].clear();
+        phaseHeads[phase] = 0;
+    }
+    for (size_t i = 0; i < orderList.size(); i++) {
+        if (orderList[i]) {
+            slots[orderList[i]->getHandle()] = i;
+            phaseSlots[static_cast<int>(orderList[i]->getPhase())].push_back(i);
         }
     }
-    if(flag == false){
-        cout<<"NO SUCH ELEMENT BELONGS IN THE LIST " << endl;
+};
+
+bool Orderlist::cancel(OrderHandle handle){
+    size_t slot = findSlot(handle);
+    if (slot == orderList.size()) {
+        return false;
+    }
+    orderList[slot].reset();
+    slots.erase(handle);
+    tombstones++;
+    while (head < orderList.size() && !orderList[head]) {
+        head++;
     }
-    else{
-        this->orderList.erase(this->orderList.begin() + found);
+    return true;
+};
+
+void Orderlist::remove(Orders& order){
+    if (!cancel(order.getHandle())) {
+        orderOutput()<<"NO SUCH ELEMENT BELONGS IN THE LIST " << endl;
     }
+};
 
+Orders* Orderlist::find(OrderHandle handle){
+    size_t slot = findSlot(handle);
+    return (slot < orderList.size()) ? orderList[slot].get() : nullptr;
+};
 
+Orders* Orderlist::front(){
+    while (head < orderList.size() && !orderList[head]) {
+        head++;
+    }
+    return (head < orderList.size()) ? orderList[head].get() : nullptr;
 };
 
-//for moving the orders in the orderlist i need to use the insert function of the vector class 
-//but i will have to check how it readjusts the indcies 
-//my idea is that reuse the remove method to first remove the order -didnt work 
-//but we will have to store it in a variable 
-//then move the order  would mean insert it a specific location by providing an index
+// A queued position past the end of orderList (which only a bug could leave) counts as an empty slot
+Orders* Orderlist::nextInPhase(OrderPhase phase){
+    const std::vector<size_t>& queue = phaseSlots[static_cast<int>(phase)];
+    size_t& next = phaseHeads[static_cast<int>(phase)];
+    while (next < queue.size() && (queue[next] >= orderList.size() || !orderList[queue[next]])) {
+        next++;
+    }
+    return (next < queue.size()) ? orderList[queue[next]].get() : nullptr;
+};
 
-void Orderlist::move(Orders& order , int index){
-    int from;
-  for(int i =0 ; i< this->orderList.size() ; i++){ //this->orderlist represents the vector which is simply an object holding pointers to orders
-        // cout<<"=================================================" <<endl;
-        //     cout<<typeid(*this->orderList[i]).name() <<endl; // i believe the problem is the both are essentially Orders so it deletes the first element , even if we asked for bomb
-        //     //what can solve this problem have an id with BOmb that generates unique id for each order ;
-        //     cout<<typeid(order).name() <<endl;
-        //     cout<<"=================================================" <<endl <<"\n";
-        if(typeid(*this->orderList[i]).name()  == (typeid(order)).name()){
-            //check for the equality of the rest of parameters
-           if((*this->orderList[i]).getNumberOfArmyUnits() == order.getNumberOfArmyUnits() &&
-            (*this->orderList[i]).getSourceTerritory() == order.getSourceTerritory() &&
-            (*this->orderList[i]).getTargetTerritory() == order.getTargetTerritory()){
-            
-            from = i;
-            break;
-           }
-        }
+std::vector<Orders*> Orderlist::getPhaseOrders(OrderPhase phase){
+    std::vector<Orders*> orders;
+    const std::vector<size_t>& queue = phaseSlots[static_cast<int>(phase)];
+    for (size_t next = phaseHeads[static_cast<int>(phase)]; next < queue.size(); next++) {
+        if (queue[next] < orderList.size() && orderList[queue[next]]) orders.push_back(orderList[queue[next]].get());
     }
- auto saved = std::move(this->orderList[from]);//unique pointers ownership can only be transferred , here ownership of the Order pointers transferred to saved temporarily 
-this->orderList.erase(this->orderList.begin() + from);
+    return orders;
+};
 
-this->orderList.insert(
-    this->orderList.begin() + index,
-    std::move(saved)//
-);
+int Orderlist::size() const{
+    return static_cast<int>(orderList.size()) - tombstones;
+};
 
- 
+bool Orderlist::empty() const{
+    return size() == 0;
+};
+
+void Orderlist::compact(){
+    if (tombstones > 0) {
+        orderList.erase(std::remove(orderList.begin(), orderList.end(), nullptr), orderList.end());
+        tombstones = 0;
+    }
+    head = 0;
+    indexSlots();
+};
+
+void Orderlist::clear(){
+    orderList.clear();
+    slots.clear();
+    head = 0;
+    tombstones = 0;
+    for (int phase = 0; phase < ORDER_PHASE_COUNT; phase++) {
+        phaseSlots[phase].clear();
+        phaseHeads[phase] = 0;
+    }
+};
+
+// Moves the order to position index of the orders left
+void Orderlist::move(Orders& order , int index){
+    compact();
+    size_t from = findSlot(order.getHandle());
+    if (from == orderList.size()) {
+        orderOutput()<<"NO SUCH ELEMENT BELONGS IN THE LIST " << endl;
+        return;
+    }
+    auto saved = std::move(this->orderList[from]);//unique pointers ownership can only be transferred , here ownership of the Order pointers transferred to saved temporarily 
+    this->orderList.erase(this->orderList.begin() + from);
+    this->orderList.insert(this->orderList.begin() + index, std::move(saved));
+    indexSlots();
 }
 
 std::string Orderlist::stringToLog() {
-    if (!orderList.empty()) {
+    if (!orderList.empty() && orderList.back()) {
         const Orders* lastOrder = orderList.back().get();
         return "Order added to list: from " + lastOrder->getSourceTerritory() +
                " to " + lastOrder->getTargetTerritory() +
@@ -7,36 +7,97 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include <iterator>
 #include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <memory_resource>
 #include "Map.h"
 #include "Player.h"
 #include "Cards.h"
 #include "LoggingObserver.h"
 #include "PlayerStrategies.h"
 class Player; //forward declaration to avoid circular dependency
+class Map;
+
+// Unique id of an order, given when it is created (a copy is a new order with a new handle)
+typedef uint64_t OrderHandle;
+const OrderHandle NO_ORDER = 0;
+
+// Concrete type of an order, kept in the order so the engine can switch on it instead of probing
+// the type with dynamic_cast
+enum class OrderKind : uint8_t { Deploy, Negotiate, Bomb, Airlift, Advance, Blockade };
+
+// Execution phases, in turn order: every deploy order, every diplomacy order, then the rest round robin
+enum class OrderPhase : uint8_t { Deploy, Diplomacy, Main };
+const int ORDER_PHASE_COUNT = 3;
 
 using namespace std;
 
+/**
+ * OrderPool holds the memory of every order: orders are carved from large chunks, in slots of a few
+ * sizes, and a deleted order's slot is kept on a free list for the next order of its size. The orders
+ * of a turn are all deleted by the end of its execution phase, so the next turn's orders reuse their
+ * slots and creating an order takes nothing from the heap once the game has played a turn
+ * Each thread keeps its own free lists (no locking); the slots of a thread that exits go to a shared
+ * depot the other threads draw from. Chunks live as long as the program
+ */
+class OrderPool {
+  public:
+    static void* allocate(size_t size);
+    static void deallocate(void* block, size_t size);
+    static size_t getChunkCount();    // chunks taken from the heap so far
+};
+
+// Stream the orders print to: cout, unless the thread's orders are being captured (the OrderScheduler
+// captures each order it runs in parallel, and prints them in turn order)
+ostream& orderOutput();
+void setOrderOutput(ostream* stream);    // nullptr: back to cout
 
 //now we will decalre the class orders 
 class Orders : public Subject, public ILoggable {
   protected:
-    unique_ptr<int> numberOfArmyUnits;
-    unique_ptr<string> sourceTerritory;
-    unique_ptr<string> targetTerritory;
+    // Held inline. A territory name is only stored when the order names a territory the map does not
+    // resolve: for a bound order the name is read off the territory, so issuing one copies no string
+    int numberOfArmyUnits;
+    string sourceTerritory;
+    string targetTerritory;
     //player* targetPlayer; //Once Jimmy done with the player class
 
+    // Territories resolved once, when the order is issued (see bind()), so validate() and execute()
+    // look them up by id instead of comparing names
+    Map* map;                 // map the ids belong to, nullptr while the order is not bound
+    TerritoryId sourceId;
+    TerritoryId targetId;
+    OrderHandle handle;
+    OrderKind kind = OrderKind::Advance;   // set by the constructors of each order type
+
+    void bindToPlayer(Player& player);
+    Territory* findByName(Player& player, const string& name);
+    Territory* getSource(Player& player);
+    Territory* getTarget(Player& player);
+    bool isAttackTarget(Player& player, Territory* territory);
+
     public:
       Orders();
       Orders(int numberOfArmyUnits , string sourceTerritory , string targetTerritory);
+      Orders(int numberOfArmyUnits , Territory* sourceTerritory , Territory* targetTerritory);   // bound to the territories' map
       Orders(const Orders& otherOrder);
       Orders& operator=(const Orders& otherOrder);
       int getNumberOfArmyUnits() const;
-      string getSourceTerritory() const;
-      string getTargetTerritory() const;
+      const string& getSourceTerritory() const;
+      const string& getTargetTerritory() const;
       void setNumberOfArmyUnits(int numberOfArmyUnits);
       void setSourceTerritory(string sourceTerritory);
       void setTargetTerritory(string targetTerritory);
+      void bind(Map* map);      // resolves the territory names to ids of map (two O(1) lookups)
+      Map* getMap() const;
+      TerritoryId getSourceId() const;
+      TerritoryId getTargetId() const;
+      OrderHandle getHandle() const;
+      OrderKind getKind() const;
+      OrderPhase getPhase() const;
+      int run(Player& player);    // execute() of the concrete type, picked by a switch on the kind
       virtual bool validate(Player& player ) ; //only in case we have base pointer to an object of child class 
       virtual int execute(Player& player) = 0;     // returns the status
       virtual ~Orders()  = default; //virtual destructor// do i need this maybe not i will remove 
@@ -44,6 +105,10 @@ class Orders : public Subject, public ILoggable {
       virtual void print(ostream& os) const;
       std::string stringToLog() override;
       virtual Orders* clone() const = 0;          // pure virtual clone method for deep copying
+
+      // Every order, and every clone, lives in the OrderPool
+      static void* operator new(size_t size);
+      static void operator delete(void* block, size_t size);
   
 };
 
@@ -51,6 +116,7 @@ class DeployOrder : public Orders{
     public:
       DeployOrder();
       DeployOrder(int numberOfArmyUnits , string sourceTerritory , string targetTerritory) ;
+      DeployOrder(int numberOfArmyUnits, Territory* sourceTerritory, Territory* targetTerritory);
       DeployOrder(const DeployOrder& deploy);
       friend ostream& operator<<(ostream& os , const DeployOrder& deploy);
       DeployOrder& operator=(const DeployOrder& otherDeployOrder);
@@ -66,6 +132,7 @@ class Negotiate : public Orders{
   public:
     Negotiate();
     Negotiate(int numberOfArmyUnits , string sourceTerritory , string targetTerritory , string enemy);
+    Negotiate(int numberOfArmyUnits , string sourceTerritory , string targetTerritory , Player* enemy);   // binds the enemy's id now
     Negotiate(const Negotiate& otherNegotiate);
     Negotiate& operator=(const Negotiate& otherNegotiate);
     void print(ostream& os) const;
@@ -73,10 +140,13 @@ class Negotiate : public Orders{
     bool validate(Player& player);
     friend ostream& operator<<(ostream& os , const Negotiate& negotiate);
     string getEnemy() const { return enemy ; }; //TODO: I BELIEVE THE GET IS SPECIFIC METHOD FOR THE UNIQUE PTR
-    void setEnemy( string enemy){ this->enemy = enemy ; };
+    void setEnemy( string enemy){ this->enemy = enemy ; enemyId = NO_PLAYER; };
     virtual Negotiate* clone() const override;
     private:
       string enemy;
+      PlayerId enemyId = NO_PLAYER;   // the enemy in the issuing player's Diplomacy, bound on first use when issued by name
+
+      Player* findEnemy(Player& player);
 
 
 };
@@ -86,6 +156,7 @@ class Bomb : public Orders{
   public:
     Bomb();
     Bomb(int numberOfArmyUnits, string sourceTerritory, string targetTerritory);
+    Bomb(int numberOfArmyUnits, Territory* sourceTerritory, Territory* targetTerritory);
     Bomb(const Bomb& otherBomb);
     Bomb& operator=(const Bomb& otherBomb);
     friend ostream& operator<<(ostream& os , const Bomb& bomb);
@@ -101,6 +172,7 @@ class Airlift : public Orders{
   public:
     Airlift();
     Airlift(int numberOfArmyUnits , string sourceTerritory , string targetTerritory);
+    Airlift(int numberOfArmyUnits, Territory* sourceTerritory, Territory* targetTerritory);
     Airlift(const Airlift& otherAirlift);
     Airlift& operator=(const Airlift& otherAirlift );
     friend ostream& operator<<(ostream& os , const Airlift& airlift);
@@ -116,6 +188,7 @@ class Advance : public Orders{
   public:
     Advance();
     Advance(int numberOfArmyUnits, string sourceTerritory, string targetTerritory);
+    Advance(int numberOfArmyUnits, Territory* sourceTerritory, Territory* targetTerritory);
     Advance(const Advance& otherAdvance);
     Advance& operator=(const Advance& otherAdvance);
     friend ostream& operator<<(ostream& os , const Advance& advance);
@@ -130,6 +203,7 @@ class Blockade : public Orders{
   public:
     Blockade();
     Blockade(int numberOfArmyUnits, string sourceTerritory, string targetTerritory);
+    Blockade(int numberOfArmyUnits, Territory* sourceTerritory, Territory* targetTerritory);
     Blockade(const Blockade& otherBlockade);
     Blockade& operator=(const Blockade& otherBlockade);
     friend ostream& operator<<(ostream& os , const Advance& advance);
@@ -142,16 +216,68 @@ class Blockade : public Orders{
 
 
 
+// Orders in the order they were issued. Removing an order leaves an empty slot (a tombstone) in
+// orderList, so removal is O(1) and indices and iterators stay valid while the list is being walked,
+// e.g. by orders being cancelled during the execution phase. The slots are squeezed out by
+// compact(), which add() runs once tombstones outnumber the orders (amortized O(1) per removal)
+// Each phase also has a queue of the positions of its orders, so the execution phase takes the next
+// order of a phase in O(1) without looking at the orders of the other phases
 class Orderlist : public Subject, public ILoggable {
 public:
+    // Walks the orders left in issue order, skipping the empty slots. Cancelling orders keeps it
+    // valid; add(), move() and compact() do not
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Orders*;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Orders* const*;
+        using reference = Orders*;
+
+        Iterator() = default;
+        Orders* operator*() const { return at->get(); }
+        Iterator& operator++() { ++at; skipEmpty(); return *this; }
+        Iterator operator++(int) { Iterator before = *this; ++*this; return before; }
+        bool operator==(const Iterator& other) const { return at == other.at; }
+        bool operator!=(const Iterator& other) const { return at != other.at; }
+
+    private:
+        friend class Orderlist;
+        using Slot = std::vector<std::unique_ptr<Orders>>::const_iterator;
+        Slot at;
+        Slot last;
+        Iterator(Slot at, Slot last) : at(at), last(last) { skipEmpty(); }
+        void skipEmpty() { while (at != last && !*at) ++at; }
+    };
+
     Orderlist() = default;
-    std::vector<std::unique_ptr<Orders>> orderList;//the data member of orderlist 
+    Iterator begin() const;
+    Iterator end() const;
+    OrderHandle add(std::unique_ptr<Orders> order);
+    bool cancel(OrderHandle handle);      // false if no order of the list has this handle
     void remove(Orders& order);
     void move(Orders& order , int index);
+    Orders* find(OrderHandle handle);
+    Orders* front();                      // first order left, nullptr when the list is empty
+    Orders* nextInPhase(OrderPhase phase);   // first order of the phase left, nullptr when there is none
+    std::vector<Orders*> getPhaseOrders(OrderPhase phase);   // orders of the phase left, in issue order
+    int size() const;                     // orders left
+    bool empty() const;
+    void compact();
+    void clear();
     std::string stringToLog() override;
-    
-
 
+private:
+    std::vector<std::unique_ptr<Orders>> orderList;   // the orders in issue order (empty slots are removed orders)
+    std::pmr::unsynchronized_pool_resource slotMemory;   // recycles the nodes of slots from turn to turn
+    std::pmr::unordered_map<OrderHandle, size_t> slots{&slotMemory};   // position of each order in orderList
+    size_t head = 0;                                 // no order left before this slot
+    int tombstones = 0;
+    std::vector<size_t> phaseSlots[ORDER_PHASE_COUNT];   // positions of each phase's orders, in issue order
+    size_t phaseHeads[ORDER_PHASE_COUNT] = {};          // no order of the phase left before this entry
+
+    size_t findSlot(OrderHandle handle);
+    void indexSlots();
 };
 
 
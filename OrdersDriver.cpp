@@ -1,6 +1,8 @@
 #include "Orders.h"
 #include "Player.h"
 #include <string>
+#include <vector>
+#include <algorithm>
 #include "OrdersDriver.h"
 
 
@@ -93,6 +95,14 @@ int testOrderExecution()
     Player playerA("Player A");
     Player playerB("Player B");
     Player neutralPlayer("Neutral"); // local neutral holder (some impls use a static Neutral inside Blockade)
+    Deck deck;                       // the deck conquests draw their reward from, as a game's would
+    playerA.setDeck(&deck);
+    playerB.setDeck(&deck);
+
+    // Negotiate finds its target among the players of the same diplomacy
+    Diplomacy diplomacy;
+    diplomacy.join(&playerA);
+    diplomacy.join(&playerB);
 
     // -------------------- Create territories --------------------
     Territory* canada  = new Territory("Canada");
@@ -255,58 +265,73 @@ cout<<france->getOwner()->getName()<<"\n";
 
     // Reuse existing players and territories
     // Clear any previous orders from their order lists first
-    playerA.getOrderList()->orderList.clear();
-    playerB.getOrderList()->orderList.clear();
+    playerA.getOrderList()->clear();
+    playerB.getOrderList()->clear();
 
     // Reset adjacency and owners for clarity
     france->setOwner(&playerB);
     canada->setOwner(&playerA);
 
     // --- Attack orders BEFORE negotiation ---
-    playerA.getOrderList()->orderList.push_back(std::make_unique<Advance>(3, "Canada", "France"));
-    playerA.getOrderList()->orderList.push_back(std::make_unique<Bomb>(0, "Canada", "France"));
-    playerB.getOrderList()->orderList.push_back(std::make_unique<Advance>(2, "France", "Canada"));
+    playerA.getOrderList()->add(std::make_unique<Advance>(3, "Canada", "France"));
+    playerA.getOrderList()->add(std::make_unique<Bomb>(0, "Canada", "France"));
+    playerB.getOrderList()->add(std::make_unique<Advance>(2, "France", "Canada"));
 
-    // --- Negotiate order itself ---
-    playerA.getOrderList()->orderList.push_back(std::make_unique<Negotiate>(0, "", "", "Player B"));
+    // --- Negotiate order itself (Player A needs a diplomacy card, and a bomb card for its Bombs to be blocked by the pact) ---
+    playerA.getHand()->hand->push_back(new Card("diplomacy"));
+    playerA.getHand()->hand->push_back(new Card("bomb"));
+    playerA.getOrderList()->add(std::make_unique<Negotiate>(0, "", "", "Player B"));
 
     // --- Attack orders AFTER negotiation ---
-    playerA.getOrderList()->orderList.push_back(std::make_unique<Advance>(4, "Canada", "France"));
-    playerA.getOrderList()->orderList.push_back(std::make_unique<Bomb>(0, "Canada", "France"));
-    playerB.getOrderList()->orderList.push_back(std::make_unique<Advance>(3, "France", "Canada"));
+    playerA.getOrderList()->add(std::make_unique<Advance>(4, "Canada", "France"));
+    playerA.getOrderList()->add(std::make_unique<Bomb>(0, "Canada", "France"));
+    playerB.getOrderList()->add(std::make_unique<Advance>(3, "France", "Canada"));
 
     // --- Show order lists before executing Negotiate ---
     cout << "\nBefore executing Negotiate:\n";
     cout << "Player A OrdersList:\n";
-    for (size_t i = 0; i < playerA.getOrderList()->orderList.size(); ++i)
-        cout << "  [" << i + 1 << "] " 
-             << typeid(*(playerA.getOrderList()->orderList[i].get())).name() << "\n";
+    int positionA = 0;
+    for (Orders* order : *playerA.getOrderList())
+        cout << "  [" << ++positionA << "] " << typeid(*order).name() << "\n";
     cout << "Player B OrdersList:\n";
-    for (size_t i = 0; i < playerB.getOrderList()->orderList.size(); ++i)
-        cout << "  [" << i + 1 << "] " 
-             << typeid(*(playerB.getOrderList()->orderList[i].get())).name() << "\n";
+    int positionB = 0;
+    for (Orders* order : *playerB.getOrderList())
+        cout << "  [" << ++positionB << "] " << typeid(*order).name() << "\n";
 
     // --- Execute the Negotiate order from Player A’s list ---
     cout << "\nExecuting Negotiate order between Player A and Player B...\n";
-    for (auto& uptr : playerA.getOrderList()->orderList) {
-        if (typeid(*uptr) == typeid(Negotiate)) {
-            uptr->execute(playerA);
+    for (Orders* order : *playerA.getOrderList()) {
+        if (typeid(*order) == typeid(Negotiate)) {
+            order->execute(playerA);
             break;
         }
     }
 
-    // --- Show order lists after Negotiate executes ---
+    // --- Validate the attack orders after Negotiate executes ---
+    // (the orders stay in the lists; the pact makes every attack between the two players invalid this turn)
     cout << "\nAfter executing Negotiate:\n";
     cout << "Player A OrdersList:\n";
-    for (size_t i = 0; i < playerA.getOrderList()->orderList.size(); ++i)
-        cout << "  [" << i + 1 << "] " 
-             << typeid(*(playerA.getOrderList()->orderList[i].get())).name() << "\n";
+    positionA = 0;
+    for (Orders* order : *playerA.getOrderList()) {
+        cout << "  [" << ++positionA << "] " << typeid(*order).name() << "\n";
+        if (typeid(*order) == typeid(Advance) || typeid(*order) == typeid(Bomb)) {
+            bool valid = order->validate(playerA);
+            cout << "      -> " << (valid ? "VALID" : "INVALID") << "\n";
+        }
+    }
     cout << "Player B OrdersList:\n";
-    for (size_t i = 0; i < playerB.getOrderList()->orderList.size(); ++i)
-        cout << "  [" << i + 1 << "] " 
-             << typeid(*(playerB.getOrderList()->orderList[i].get())).name() << "\n";
+    positionB = 0;
+    for (Orders* order : *playerB.getOrderList()) {
+        cout << "  [" << ++positionB << "] " << typeid(*order).name() << "\n";
+        if (typeid(*order) == typeid(Advance) || typeid(*order) == typeid(Bomb)) {
+            bool valid = order->validate(playerB);
+            cout << "      -> " << (valid ? "VALID" : "INVALID") << "\n";
+        }
+    }
+
+    cout << "Expected: every Advance/Bomb order between Player A and Player B is INVALID.\n";
+    diplomacy.clearPacts();   // the pact ends with the turn
 
-    cout << "Expected: all Advance/Bomb orders removed from both lists.\n";
 
 
     cout << "================== END NEGOTIATE ORDER TEST ==================\n\n";
@@ -352,3 +377,101 @@ cout<<france->getOwner()->getName()<<"\n";
     delete germany;
     return 0;
 }
+
+
+// Issues orders of every kind into one list, cancels some of them by handle (one in the middle of
+// a walk, the way an order executing can cancel another), and checks that each phase's queue gives
+// back the orders left in issue order. Then runs turns of the same size and checks that the order
+// pool stops growing after the first
+void testOrderQueues()
+{
+    cout << "================== BEGIN testOrderQueues() ==================\n\n";
+
+    Orderlist list;
+    vector<OrderHandle> issued;
+    auto issue = [&](unique_ptr<Orders> order) {
+        issued.push_back(list.add(std::move(order)));
+    };
+    for (int round = 0; round < 4; round++) {
+        issue(make_unique<Advance>(3, "Canada", "France"));
+        issue(make_unique<DeployOrder>(5, "Canada", "Canada"));
+        issue(make_unique<Bomb>(0, "Canada", "Germany"));
+        issue(make_unique<Negotiate>(0, "", "", "Player B"));
+        issue(make_unique<Airlift>(2, "Canada", "United States"));
+        issue(make_unique<Blockade>(0, "United States", "United States"));
+        issue(make_unique<DeployOrder>(1, "United States", "United States"));
+        issue(make_unique<Advance>(1, "United States", "Germany"));
+    }
+    cout << "Issued " << list.size() << " orders\n";
+
+    // Cancel every third order before the walk, and the last order of the Main phase during it
+    vector<OrderHandle> cancelled;
+    for (size_t i = 2; i < issued.size(); i += 3) {
+        list.cancel(issued[i]);
+        cancelled.push_back(issued[i]);
+    }
+    OrderHandle lateMain = NO_ORDER;
+    for (OrderHandle handle : issued) {
+        Orders* order = list.find(handle);
+        if (order != nullptr && order->getPhase() == OrderPhase::Main) lateMain = handle;
+    }
+    cout << "Cancelled " << cancelled.size() << " orders before the walk, " << list.size() << " left\n";
+
+    bool allInOrder = true;
+    const char* phaseNames[ORDER_PHASE_COUNT] = {"Deploy", "Diplomacy", "Main"};
+    for (int phase = 0; phase < ORDER_PHASE_COUNT; phase++) {
+        // What the phase should give back: its orders in issue order, less the cancelled ones
+        vector<OrderHandle> expected;
+        for (OrderHandle handle : issued) {
+            Orders* order = list.find(handle);
+            if (order != nullptr && order->getPhase() == static_cast<OrderPhase>(phase)) expected.push_back(handle);
+        }
+
+        vector<OrderHandle> walked;
+        while (Orders* order = list.nextInPhase(static_cast<OrderPhase>(phase))) {
+            walked.push_back(order->getHandle());
+            list.cancel(order->getHandle());
+            if (walked.size() == 1 && lateMain != NO_ORDER && order->getPhase() == OrderPhase::Main) {
+                list.cancel(lateMain);
+                expected.erase(std::remove(expected.begin(), expected.end(), lateMain), expected.end());
+                cout << "  cancelled order " << lateMain << " in the middle of the walk\n";
+            }
+        }
+
+        bool inOrder = (walked == expected);
+        allInOrder = allInOrder && inOrder;
+        cout << phaseNames[phase] << " phase: " << walked.size() << " orders, expected " << expected.size()
+             << (inOrder ? " -> in issue order" : " -> MISMATCH") << "\n";
+    }
+    cout << "Orders left after the walk: " << list.size() << (list.empty() ? "" : " -> MISMATCH") << "\n";
+    cout << (allInOrder && list.empty() ? "Every phase gave back its orders in issue order\n"
+                                        : "Some phase lost or reordered an order\n");
+
+    // Turns of the same size reuse the slots the previous turn's orders gave back, so after the
+    // first turn the order pool should take no more memory from the heap
+    const int TURNS = 20;
+    const int ORDERS_PER_TURN = 5000;
+    size_t chunksAfterFirst = 0;
+    for (int turn = 0; turn < TURNS; turn++) {
+        for (int i = 0; i < ORDERS_PER_TURN; i++) {
+            switch (i % 4) {
+            case 0: list.add(make_unique<DeployOrder>(1, "Canada", "Canada")); break;
+            case 1: list.add(make_unique<Advance>(2, "Canada", "France")); break;
+            case 2: list.add(make_unique<Bomb>(0, "Canada", "Germany")); break;
+            default: list.add(unique_ptr<Orders>(list.front()->clone())); break;
+            }
+        }
+        for (int phase = 0; phase < ORDER_PHASE_COUNT; phase++) {
+            while (Orders* order = list.nextInPhase(static_cast<OrderPhase>(phase))) {
+                list.cancel(order->getHandle());
+            }
+        }
+        if (turn == 0) chunksAfterFirst = OrderPool::getChunkCount();
+    }
+    size_t chunksAfterLast = OrderPool::getChunkCount();
+    cout << "\nOrder pool over " << TURNS << " turns of " << ORDERS_PER_TURN << " orders: " << chunksAfterFirst
+         << " chunks after the first turn, " << chunksAfterLast << " after the last"
+         << (chunksAfterLast == chunksAfterFirst ? " -> flat" : " -> GREW") << "\n";
+
+    cout << "\n================== END testOrderQueues() ==================\n\n";
+}
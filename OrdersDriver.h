@@ -6,5 +6,6 @@
 
 //int testOrderList();
 int testOrderExecution();
+void testOrderQueues();
 
 #endif
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "Player.h"
 #include "LoggingObserver.h"
+#include <charconv>
+#include <algorithm>
 
 /***
  * Player Constructor,
@@ -8,6 +10,9 @@
 Player::Player()
 {
     this->strategy = nullptr;
+    this->deck = nullptr;
+    this->id = NO_PLAYER;
+    this->diplomacy = nullptr;
     this->name = new string("John Doe");
     // Territory* t = new Territory("Mexico");
     this->defendCollection = new vector<Territory *>();
@@ -25,6 +30,9 @@ Player::Player(string name)
 {
     this->name = new string(name);
     this->strategy = nullptr;
+    this->deck = nullptr;
+    this->id = NO_PLAYER;
+    this->diplomacy = nullptr;
     this->defendCollection = new vector<Territory *>();
     this->attackCollection = new vector<Territory *>();
     this->cardCollection = new Hand();
@@ -37,6 +45,8 @@ Player::Player(string name)
  */
 Player::~Player()
 {
+    if (diplomacy != nullptr)
+        diplomacy->leave(this);
     delete name;
     defendCollection->clear();
     attackCollection->clear();
@@ -54,6 +64,11 @@ Player::Player(const Player &other)
 {
 
     strategy = other.strategy; // Shallow copy of strategy pointer
+    deck = other.deck;         // Both draw from the same game's deck
+
+    // A copy is not a member of the original's diplomacy
+    id = NO_PLAYER;
+    diplomacy = nullptr;
 
     // Deep copy of defendCollection
     defendCollection = new vector<Territory *>(*other.defendCollection);
@@ -67,10 +82,10 @@ Player::Player(const Player &other)
 
     // Deep copy of orderCollection
     orderCollection = new Orderlist();
-    for (const auto &order : other.orderCollection->orderList)
+    for (Orders *order : *other.orderCollection)
     {
         //Orders *newOrder = new Orders(*order); //objects from an abstract class cannot be instantiated
-        //orderCollection->orderList.push_back(make_unique<Orders>(*newOrder));
+        //orderCollection->add(make_unique<Orders>(*newOrder));
     }
 }
 
@@ -105,7 +120,7 @@ ostream &operator<<(ostream &out, const Player &player)
     // If yes, it returns a non-null pointer and you print with the subclass’s operator<<.
     // If not, it tries the next branch.
     // If none match, it falls back to the base Orders print.
-    for (const auto &order : player.orderCollection->orderList)
+    for (Orders *order : *player.orderCollection)
     {
         out << *order << endl;
     }; // there is a more compact way like use another method and then making it virtual that i currently do not understand
@@ -133,6 +148,9 @@ Player &Player::operator=(const Player &other)
     // Deep copy of name
     name = new string(*other.name);
 
+    // The deck is the game's, shared
+    deck = other.deck;
+
     // Deep copy of defendCollection
     defendCollection = new vector<Territory *>(*other.defendCollection);
 
@@ -145,8 +163,8 @@ Player &Player::operator=(const Player &other)
     // Deep copy of orderCollection
     orderCollection = new Orderlist();
 
-    for (const auto &order : other.orderCollection->orderList) {
-        orderCollection->orderList.push_back(std::unique_ptr<Orders>(order->clone()));
+    for (Orders *order : *other.orderCollection) {
+        orderCollection->add(std::unique_ptr<Orders>(order->clone()));
     }
     
     return *this;
@@ -173,7 +191,15 @@ vector<Territory *> *Player::toDefend()
 vector<Territory *> *Player::toAttack()
 {
 
-    strategy->toAttack();                           // The Strategy should modify the AttackCollection of the Player
+    if (strategy != nullptr)
+    {
+        strategy->toAttack();                       // The Strategy should modify the AttackCollection of the Player
+    }
+    else
+    {   // No strategy (a player set up by hand, as in the drivers): every enemy neighbor can be attacked
+        attackCollection->clear();
+        getEnemyTerritories();
+    }
     return attackCollection;
 
 }
@@ -183,17 +209,69 @@ vector<Territory *> *Player::toAttack()
  * IMPORTANT:Make sure to clear the attackCollection before calling this function to ensure that it is updated properly
  */
 void Player::getEnemyTerritories(Territory *source){
-    for (Territory *adjacent : *(source->getAdjacentTerritories()))
+    Map* map = source->getMap();
+    if (map != nullptr && map->getTerritory(source->getId()) == source)
+    {   // Word-parallel on small maps: adjacency row ANDNOT the player's ownership bitset
+        addEnemyTerritories(map, map->findEnemyNeighbors(this, source->getId()));
+        return;
+    }
+
+    // Territory outside any map: walk its neighbors
+    for (Territory *adjacent : source->getAdjacentTerritories())
     {
         if (adjacent->getOwner() != this)
         {   
-            if(std::find_if(attackCollection->begin(), attackCollection->end(), [&](Territory* territory){return territory->getName() == adjacent->getName();}) == attackCollection->end()){ // Avoid duplicates
+            if(std::find(attackCollection->begin(), attackCollection->end(), adjacent) == attackCollection->end()){ // Avoid duplicates
                 attackCollection->push_back(adjacent);
             }
         }
     }
 }
 
+/***
+ * Adds every enemy territory adjacent to any territory of the defendCollection to the attackCollection,
+ * in one pass over the ownership bitsets of the map instead of one getEnemyTerritories call per territory
+ * IMPORTANT:Make sure to clear the attackCollection before calling this function to ensure that it is updated properly
+ */
+void Player::getEnemyTerritories(){
+    if (defendCollection->empty())
+    {
+        return;
+    }
+    Map* map = defendCollection->front()->getMap();
+    if (map == nullptr)
+    {
+        for (Territory *territory : *defendCollection)
+        {
+            getEnemyTerritories(territory);
+        }
+        return;
+    }
+    addEnemyTerritories(map, map->findEnemyFrontier(this));
+}
+
+/***
+ * Appends the given territories of map to the attackCollection, skipping the ones already in it
+ */
+void Player::addEnemyTerritories(Map* map, const std::vector<int>& enemyIds){
+    std::vector<bool> listed;
+    if (!attackCollection->empty())
+    {   // Avoid duplicates: one mark per territory instead of a search of the collection per enemy
+        listed.assign(map->getTerritories()->size(), false);
+        for (Territory *territory : *attackCollection)
+        {
+            if (territory->getMap() == map) listed[territory->getId()] = true;
+        }
+    }
+    for (TerritoryId id : enemyIds)
+    {
+        if (listed.empty() || !listed[id])
+        {
+            attackCollection->push_back(map->getTerritory(id));
+        }
+    }
+}
+
 /***
  * issueOrder()
  * Creates an Order object and puts it in the player’s list of orders
@@ -250,6 +328,16 @@ Hand *Player::getHand()
     return this->cardCollection;
 }
 
+Deck *Player::getDeck()
+{
+    return this->deck;
+}
+
+void Player::setDeck(Deck *gameDeck)
+{
+    this->deck = gameDeck;
+}
+
 //--------Functions related to reinforcement armies pool(Ass2)-------//
 /***
  * This is a setter for the Reinforcement Pool
@@ -293,7 +381,7 @@ bool Player::generateOrder()
     while(tentativePool > 0){
         cout << "Remaining Reinforcement Pool: " << tentativePool << endl;
         cout << "\nPlease choose a territory: " << endl; // Get the starting territory
-        cin >> source;
+        source = readTerritory();
 
         // sourceTerritory = findTerritory(defendCollection, source);
         deployReinforcments(source);
@@ -301,6 +389,7 @@ bool Player::generateOrder()
     } 
 
     cout << "========== Generating Order ==========" << endl; // Allows the player to choose which type of order to issue
+    cout << "(Territories can be entered by name, or as x,y to pick the one drawn closest to that point of the map)" << endl;
     cout << "Please choose which order to issue:" << endl;
     cout << "1. Deploy" << endl;
     cout << "2. Advance" << endl;
@@ -325,14 +414,14 @@ bool Player::generateOrder()
     {
         cout << "Remaining Reinforcement Pool: " << tentativePool << endl;
         cout << "\nPlease choose a territory: " << endl; // Get the starting territory
-        cin >> source;
+        source = readTerritory();
         deployReinforcments(source); // Deploy orders are handled separately
         break;
     }
     case 2: // Advance Order
     {
         cout << "Please enter the source territory you would like your army to advance from: " << endl; // Get the source territory
-        cin >> source;
+        source = readTerritory();
 
         sourceTerritory = findTerritory(toDefend(), source);
         if(sourceTerritory != nullptr){
@@ -342,14 +431,14 @@ bool Player::generateOrder()
         }
         
         cout << "Please enter the target territory you would like your army to advance to: " << endl;   // Get the target territory
-        cin >> target;
+        target = readTerritory();
         cout << "Please enter the number of army units to advance: " << endl;                           // Get the number of army units
         cin >> numUnits;    
 
         order = std::make_unique<Advance>(numUnits, source, target);
         setLastAction("Issued Advance order: " + std::to_string(numUnits) + " units from " + source + " to " + target);
         notify(this);
-        orderCollection->orderList.push_back(std::move(order));
+        orderCollection->add(std::move(order));
         cout << "New Advance Order created.\n" << endl;
         break;
     }
@@ -357,7 +446,7 @@ bool Player::generateOrder()
     {
 
         cout << "Please enter the source territory you would like to bomb from: " << endl; // Get the source territory
-        cin >> source;
+        source = readTerritory();
 
         sourceTerritory = findTerritory(toDefend(), source);
         if(sourceTerritory != nullptr){
@@ -367,13 +456,13 @@ bool Player::generateOrder()
         }
         
         cout << "Please enter the target territory you would like to bomb: " << endl;      // Get the target territory
-        cin >> target;
+        target = readTerritory();
 
 
         order = std::make_unique<Bomb>(0, source, target);
         setLastAction("Issued Bomb order: " + source + " bombed " + target);
         notify(this);
-        orderCollection->orderList.push_back(std::move(order));
+        orderCollection->add(std::move(order));
         cout << "New Bomb Order created.\n" << endl;
         break;
     }
@@ -385,16 +474,16 @@ bool Player::generateOrder()
         cout << BANNER << endl;
 
         cout << "Please enter the source territory you would like your army to airlift from: " << endl; // Get the source territory
-        cin >> source; 
+        source = readTerritory();
         cout << "Please enter the target territory you would like your army to airlift to: " << endl;   // Get the target territory
-        cin >> target;
+        target = readTerritory();
         cout << "Please enter the number of army units to airlift: " << endl;                         // Get the number of army units
         cin >> numUnits;
 
         order = std::make_unique<Airlift>(numUnits, source, target);
         setLastAction("Issued Airlift order: " + std::to_string(numUnits) + " units from " + source + " to " + target);
         notify(this);
-        orderCollection->orderList.push_back(std::move(order));
+        orderCollection->add(std::move(order));
         cout << "New Airlift Order created.\n" << endl;
         break;
     }
@@ -402,10 +491,16 @@ bool Player::generateOrder()
     {
         cout << "Please enter the name of the player you would like to negotiate with: " << endl; // Get the target player
         cin >> enemy;
-        order = std::make_unique<Negotiate>(numUnits, source, target , enemy);
+        // An enemy of this game is bound by id now; any other name fails validation when the order runs
+        Player* enemyPlayer = (diplomacy != nullptr) ? diplomacy->findPlayer(enemy) : nullptr;
+        if (enemyPlayer != nullptr) {
+            order = std::make_unique<Negotiate>(numUnits, source, target, enemyPlayer);
+        } else {
+            order = std::make_unique<Negotiate>(numUnits, source, target , enemy);
+        }
         setLastAction("Issued Negotiate order with player " + enemy);
         notify(this);
-        orderCollection->orderList.push_back(std::move(order));
+        orderCollection->add(std::move(order));
         cout << "New Negotiate Order created.\n" << endl;
         break;
     }
@@ -415,11 +510,11 @@ bool Player::generateOrder()
         printTerritoryList(toDefend());
         cout << BANNER << endl;
         cout << "Please enter the territory you would like form a blockade: " << endl; // Get the source territory
-        cin >> source;
+        source = readTerritory();
         order = std::make_unique<Blockade>(0, source, source);          // Might have to change the target later
         setLastAction("Issued Blockade order on territory " + source);
         notify(this);
-        orderCollection->orderList.push_back(std::move(order));
+        orderCollection->add(std::move(order));
         cout << "New Blockade Order created.\n" << endl;
         break;
     }
@@ -458,7 +553,7 @@ void Player::deployReinforcments( string source)
     std::unique_ptr<Orders> deployOrder = std::make_unique<DeployOrder>(deployUnits, source, source); // maybe change the source
     setLastAction("Deployed " + std::to_string(deployUnits) + " units to " + source);
     notify(this);
-    orderCollection->orderList.push_back(std::move(deployOrder));
+    orderCollection->add(std::move(deployOrder));
     cout << source << " has tentatively increased army units by " << deployUnits << endl;
 
     // Update the reinforcement pool
@@ -468,6 +563,33 @@ void Player::deployReinforcments( string source)
 }
 
 
+/***
+ * This function reads a territory from the user: a name, or x,y coordinates on the map image,
+ * which pick the territory drawn closest to them (hit-testing with the map's spatial index)
+ */
+std::string Player::readTerritory()
+{
+    std::string input;
+    cin >> input;
+
+    size_t comma = input.find(',');
+    if (comma == std::string::npos || defendCollection->empty() || defendCollection->front()->getMap() == nullptr)
+        return input;   // a name (names cannot contain commas in the map files)
+
+    int x, y;
+    const char* end = input.data() + input.size();
+    auto [xEnd, xError] = std::from_chars(input.data(), input.data() + comma, x);
+    auto [yEnd, yError] = std::from_chars(input.data() + comma + 1, end, y);
+    if (xError != std::errc() || yError != std::errc() || xEnd != input.data() + comma || yEnd != end)
+        return input;
+
+    Territory* territory = defendCollection->front()->getMap()->findTerritoryAt(x, y);
+    if (territory == nullptr)
+        return input;
+    cout << "(" << x << ", " << y << ") is " << territory->getName() << endl;
+    return territory->getName();
+}
+
 /***
  * This function will find a territory by its name
  */
@@ -502,8 +624,15 @@ void Player::removeFromReinforcementPool(int armies){
  * This is a helper function that will print a list of territories with their respective owners and army counts
  */
 void Player::printTerritoryList(std::vector<Territory*>* territoryList){
+    printTerritoryList(std::span<Territory* const>(*territoryList));
+}
 
-    for (Territory *territory : *territoryList){
+/***
+ * Overload for views such as the adjacency of a territory
+ */
+void Player::printTerritoryList(std::span<Territory* const> territoryList){
+
+    for (Territory *territory : territoryList){
         cout << "- "<< std::setw(20) << std::left << (territory->getOwner()->getName() + ": ") << territory->getName() << " = "  << territory->getArmies() << endl;
     }
 }
@@ -571,4 +700,141 @@ void Player::onAttacked() {
 }
 
 
-//FIXME: I have not changed the copy constructor and Assignment operator 
\ No newline at end of file
+//FIXME: I have not changed the copy constructor and Assignment operator 
+/***
+ * This function returns true if the player and other negotiated a pact this turn,
+ * in which case neither can attack the other (always false outside a game)
+ */
+bool Player::hasPactWith(const Player* other) const {
+    if (other == nullptr || diplomacy == nullptr || other->diplomacy != diplomacy)
+        return false;
+    return diplomacy->hasPact(id, other->id);
+}
+
+
+// ==================== Diplomacy Implementation ====================
+
+// Constructors and destructor (Diplomacy)
+Diplomacy::Diplomacy() {
+    members = new vector<Player*>();
+    ids = new unordered_map<string, PlayerId>();
+    pacts = new vector<uint64_t>();
+    rowWords = 0;
+}
+
+Diplomacy::~Diplomacy() {
+    clear();
+    delete members;
+    delete ids;
+    delete pacts;
+}
+
+// Stream insertion operator (Diplomacy)
+ostream& operator<<(ostream& os, const Diplomacy& diplomacy) {
+    os << "Diplomacy: " << diplomacy.getPlayerCount() << " players" << endl;
+    for (PlayerId a = 0; a < diplomacy.getPlayerCount(); a++) {
+        for (PlayerId b = a + 1; b < diplomacy.getPlayerCount(); b++) {
+            if (diplomacy.hasPact(a, b)) {
+                os << "  Pact: " << diplomacy.getPlayer(a)->getName() << " - " << diplomacy.getPlayer(b)->getName() << endl;
+            }
+        }
+    }
+    return os;
+}
+
+// Getters (Diplomacy)
+int Diplomacy::getPlayerCount() const {
+    return static_cast<int>(members->size());
+}
+
+Player* Diplomacy::getPlayer(PlayerId id) const {
+    if (id < 0 || id >= getPlayerCount()) {
+        return nullptr;
+    }
+    return (*members)[id];
+}
+
+Player* Diplomacy::findPlayer(const string& name) const {
+    auto it = ids->find(name);
+    return (it == ids->end()) ? nullptr : getPlayer(it->second);
+}
+
+// Members (Diplomacy)
+PlayerId Diplomacy::join(Player* player) {
+    if (player->diplomacy != nullptr) {
+        player->diplomacy->leave(player);
+    }
+    PlayerId id = getPlayerCount();
+    if (id >= rowWords * 64) {
+        setRowWords(max(1, rowWords * 2));
+    }
+    members->push_back(player);
+    (*ids)[player->getName()] = id;
+    pacts->resize(members->size() * rowWords, 0);
+    player->id = id;
+    player->diplomacy = this;
+    return id;
+}
+
+// The id is not reused: the player's slot stays empty and its pacts are dropped
+void Diplomacy::leave(Player* player) {
+    if (player->diplomacy != this) {
+        return;
+    }
+    PlayerId id = player->id;
+    auto it = ids->find(player->getName());
+    if (it != ids->end() && it->second == id) {
+        ids->erase(it);
+    }
+    for (PlayerId other = 0; other < getPlayerCount(); other++) {
+        (*pacts)[other * rowWords + id / 64] &= ~(uint64_t(1) << (id % 64));
+    }
+    fill(pacts->begin() + id * rowWords, pacts->begin() + (id + 1) * rowWords, 0);
+    (*members)[id] = nullptr;
+    player->id = NO_PLAYER;
+    player->diplomacy = nullptr;
+}
+
+void Diplomacy::clear() {
+    for (Player* player : *members) {
+        if (player != nullptr) {
+            player->id = NO_PLAYER;
+            player->diplomacy = nullptr;
+        }
+    }
+    members->clear();
+    ids->clear();
+    pacts->clear();
+    rowWords = 0;
+}
+
+// Pacts (Diplomacy)
+void Diplomacy::addPact(PlayerId a, PlayerId b) {
+    if (getPlayer(a) == nullptr || getPlayer(b) == nullptr || a == b) {
+        return;
+    }
+    (*pacts)[a * rowWords + b / 64] |= uint64_t(1) << (b % 64);
+    (*pacts)[b * rowWords + a / 64] |= uint64_t(1) << (a % 64);
+}
+
+bool Diplomacy::hasPact(PlayerId a, PlayerId b) const {
+    if (a < 0 || b < 0 || a >= getPlayerCount() || b >= getPlayerCount()) {
+        return false;
+    }
+    return ((*pacts)[a * rowWords + b / 64] >> (b % 64)) & 1;
+}
+
+void Diplomacy::clearPacts() {
+    fill(pacts->begin(), pacts->end(), 0);
+}
+
+// Rows are widened as players join, so every id has a bit in every row
+void Diplomacy::setRowWords(int words) {
+    vector<uint64_t>* wider = new vector<uint64_t>(members->size() * words, 0);
+    for (size_t row = 0; row < members->size(); row++) {
+        copy(pacts->begin() + row * rowWords, pacts->begin() + (row + 1) * rowWords, wider->begin() + row * words);
+    }
+    delete pacts;
+    pacts = wider;
+    rowWords = words;
+}
@@ -1,6 +1,10 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
+// The ids come before Cards.h, whose Orders.h binds a Negotiate's enemy by PlayerId
+typedef int PlayerId;                   // Dense index of a player in its game's Diplomacy
+const PlayerId NO_PLAYER = -1;
+
 #include "Cards.h"
 #include "Orders.h"
 #include "Map.h"
@@ -9,6 +13,9 @@
 #include <vector>
 #include <string>
 #include <iomanip>
+#include <span>
+#include <cstdint>
+#include <unordered_map>
 using namespace std;
 
 // Forward declarations to avoid circular dependencies
@@ -17,7 +24,11 @@ class Orders;
 class Card;
 class Hand;
 class Territory;
+class Map;
+class Deck;
 class PlayerStrategy;
+class Diplomacy;
+
 //NOTE: I added a few things to satisfy the Strategy design pattern
 //mainly a PlayerStrategy data member and a setStrategy() method;
 class Player : public Subject, public ILoggable{
@@ -27,10 +38,14 @@ class Player : public Subject, public ILoggable{
         int tentativePool;                                                              // Number of reinforcement armies displayed during the reinforcement phase (Used to show how many armies are left to deploy)
         Hand* hand;    
         PlayerStrategy* strategy;
+        Deck* deck;                                                                     // The game's deck, where conquests draw their card (not owned)
+        PlayerId id;                                                                    // NO_PLAYER when the player is not part of a Diplomacy
+        Diplomacy* diplomacy;                                                           // The pacts of the player's game (not owned)
+
+        friend class Diplomacy;
 
     public:
         const string BANNER = "========================================";               // Banner for display purposes
-        vector<Player*> negotiatedWith;
         Player();                                                                       // Player Constructor
         Player(std::string name);                                                       // Parameterized Constructor
         Player(const Player& other);                                                    // Player Copy Constructor
@@ -47,6 +62,8 @@ class Player : public Subject, public ILoggable{
 
         Orderlist* getOrderList();                                                      // Returns the player's order list
         Hand* getHand();
+        Deck* getDeck();
+        void setDeck(Deck* deck);
 
         void setTentativePool(int reinforcePool);
         void setReinforcementPool(int armies);                                        // Sets the number of reinforcement armies the player has
@@ -64,20 +81,27 @@ class Player : public Subject, public ILoggable{
 
         friend std::ostream& operator << (std::ostream& out, const Player& player);     // Overload the << operator for easy printing of Player details                                        // Player assignment operator
         std::string getName() const { return *name; }                                   // Getter for player's name
+        PlayerId getId() const { return id; }                                           // Getter for player's id (NO_PLAYER outside a game)
+        Diplomacy* getDiplomacy() const { return diplomacy; }                           // Getter for the pacts of the player's game
+        bool hasPactWith(const Player* other) const;                                    // True if the two players negotiated this turn (O(1))
          //okay i have removed defend collection from private just so that i can work on execute of deploy order
 
         void setLastAction(const std::string &action);
         std::string stringToLog() override;
 
         void getEnemyTerritories(Territory * source);               // Returns a list of territories that can be attacked from the source territory
+        void getEnemyTerritories();                                 // Same, from every territory the player owns
 
         bool generateOrder();                                              // Helper to generate an order
 
         void printTerritoryList(std::vector<Territory*>* territoryList);                        // Helper to print a list of territories
+        void printTerritoryList(std::span<Territory* const> territoryList);                     // Helper to print a view of territories (e.g. adjacency)
 
     private:
         void deployReinforcments(string source);                                           // Helper to deploy reinforcements
         Territory* findTerritory(std::vector<Territory*> *territoryList, string source);        // Helper to find a territory by name from a list
+        std::string readTerritory();                                                            // Helper to read a territory by name or by x,y position on the map
+        void addEnemyTerritories(Map* map, const std::vector<int>& enemyIds);                   // Helper to append the enemies (TerritoryIds of map) missing from the attackCollection
 
 
         std::string* name;
@@ -87,4 +111,47 @@ class Player : public Subject, public ILoggable{
         std::vector<Territory*>* defendCollection; // A List of Territories the Player should Defend                                    
 };
 
+/**
+ * Diplomacy gives the players of a game dense ids (in the order they join) and keeps the pacts
+ * negotiated this turn as a bit matrix: row a has bit b set when a and b cannot attack each other
+ * Looking a player up by name, adding a pact and checking one are O(1); the pacts only last a
+ * turn, so the game engine clears them before executing the orders of the next one
+ */
+class Diplomacy {
+    private:
+        vector<Player*>* members;                       // Indexed by PlayerId (nullptr once a player left)
+        unordered_map<string, PlayerId>* ids;           // Player name -> PlayerId
+        vector<uint64_t>* pacts;                        // One row of rowWords words per member
+        int rowWords;
+
+        void setRowWords(int words);
+
+    public:
+        // Constructors and destructor
+        Diplomacy();
+        Diplomacy(const Diplomacy& other) = delete;                 // the players point to their diplomacy
+        ~Diplomacy();
+
+        // Assignment operator
+        Diplomacy& operator=(const Diplomacy& other) = delete;
+
+        // Stream insertion operator
+        friend ostream& operator<<(ostream& os, const Diplomacy& diplomacy);
+
+        // Getters
+        int getPlayerCount() const;
+        Player* getPlayer(PlayerId id) const;
+        Player* findPlayer(const string& name) const;               // nullptr if no member has this name
+
+        // Members
+        PlayerId join(Player* player);                              // Leaves the player's previous diplomacy
+        void leave(Player* player);
+        void clear();                                               // Every member leaves
+
+        // Pacts
+        void addPact(PlayerId a, PlayerId b);
+        bool hasPact(PlayerId a, PlayerId b) const;
+        void clearPacts();
+};
+
 #endif
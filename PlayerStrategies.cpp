@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <climits>
 
 //even if i did not explcitly called the default constructor no problem in this case
 //why exactly as the Parent class PlayerStrategy does not have any user defined constructors
@@ -11,6 +12,78 @@ PlayerStrategy::PlayerStrategy(Player* p): player(p){
     player = p;
 }
 
+// Strongest / weakest territory of the player (lowest id wins ties)
+// Territories of a map are found with the army reductions of the map state instead of
+// walking the player's territory pointers; standalone territories (drivers) are scanned directly
+static Territory* findStrongestTerritory(Player* player) {
+    std::vector<Territory*>* owned = player->getDefendCollection();
+    if (owned->empty()) return nullptr;
+    Map* map = owned->front()->getMap();
+    if (map != nullptr) {
+        TerritoryId id = map->getState().findStrongest(player);
+        if (id != NO_TERRITORY) return map->getTerritory(id);
+    }
+    return *std::max_element(owned->begin(), owned->end(), [](Territory* a, Territory* b) {
+        return a->getArmies() < b->getArmies();
+    });
+}
+
+static Territory* findWeakestTerritory(Player* player) {
+    std::vector<Territory*>* owned = player->getDefendCollection();
+    if (owned->empty()) return nullptr;
+    Map* map = owned->front()->getMap();
+    if (map != nullptr) {
+        TerritoryId id = map->getState().findWeakest(player);
+        if (id != NO_TERRITORY) return map->getTerritory(id);
+    }
+    return *std::min_element(owned->begin(), owned->end(), [](Territory* a, Territory* b) {
+        return a->getArmies() < b->getArmies();
+    });
+}
+
+// Random target among the attackable territories, preferring the chokepoints of the map:
+// taking an articulation point splits the region of the territories around it
+static Territory* pickAttackTarget(const std::vector<Territory*>& targets) {
+    std::vector<Territory*> chokepoints;
+    for (Territory* target : targets) {
+        Map* map = target->getMap();
+        if (map != nullptr && map->getAnalysis()->isArticulationPoint(target->getId())) {
+            chokepoints.push_back(target);
+        }
+    }
+    const std::vector<Territory*>& candidates = chokepoints.empty() ? targets : chokepoints;
+    return candidates[rand() % candidates.size()];
+}
+
+// Enemy territories drawn within radius of a territory on the map image (a spatial index query):
+// a geometric measure of the threat to it that also sees enemies a few moves away. 0 off a map
+static int countEnemiesNear(Territory* territory, Player* player, int radius) {
+    Map* map = territory->getMap();
+    if (map == nullptr) return 0;
+    MapPoint position = territory->getPosition();
+    int enemies = 0;
+    for (TerritoryId id : map->getSpatialIndex()->findInRadius(position.x, position.y, radius)) {
+        Player* owner = map->getTerritory(id)->getOwner();
+        if (owner != nullptr && owner != player) enemies++;
+    }
+    return enemies;
+}
+
+// Enemy territory the fewest moves away from source, NO_TERRITORY if no enemy can be reached
+static TerritoryId findClosestEnemy(Map* map, Player* player, TerritoryId source) {
+    const MapRouting* routing = map->getRouting();
+    TerritoryId closest = NO_TERRITORY;
+    int closestDistance = INT_MAX;
+    for (TerritoryId enemy : map->findEnemyFrontier(player)) {
+        int distance = routing->getDistance(source, enemy);
+        if (distance >= 0 && distance < closestDistance) {
+            closest = enemy;
+            closestDistance = distance;
+        }
+    }
+    return closest;
+}
+
 
 
 
@@ -57,10 +130,7 @@ void HumanPlayerStrategy::issueOrder() {
 std::vector<Territory*>* HumanPlayerStrategy::toAttack() {
     // Human player decides via UI, return new list that engine can fill in
     player->getAttackCollection()->clear();                                  //IMPORTANT: Clear previous entries to avoid duplicates
-    for (Territory * territory : * player->getDefendCollection())              // Loop through each territory the player owns and find adjacent enemy territories
-    {
-        player->getEnemyTerritories(territory);
-    }
+    player->getEnemyTerritories();                                           // Enemy territories adjacent to any territory the player owns
 
     return player->getAttackCollection();
 }
@@ -102,10 +172,10 @@ void AggressivePlayerStrategy::issueOrder(){
     // Create a Deploy order and add it to the order list
     std::unique_ptr<Orders> deployOrder;
     
-    deployOrder = std::make_unique<DeployOrder>(player->getReinforcementPool(), strongestTerritory->getName(), strongestTerritory->getName()); // maybe change the source
+    deployOrder = std::make_unique<DeployOrder>(player->getReinforcementPool(), strongestTerritory, strongestTerritory); // maybe change the source
     player->setLastAction("Deployed " + std::to_string(player->getReinforcementPool()) + " units to " + strongestTerritory->getName());
     player->notify(player);
-    player->getOrderList()->orderList.push_back(std::move(deployOrder));
+    player->getOrderList()->add(std::move(deployOrder));
     cout << strongestTerritory->getName() << " has tentatively increased army units by " << player->getReinforcementPool() << endl;
 
 
@@ -119,29 +189,51 @@ void AggressivePlayerStrategy::issueOrder(){
     // if(attackableTerritories == 0){
         Territory* lastTerritoryVisited = strongestTerritory;
         Territory* currentTerritory = strongestTerritory;
+
+        // On a map, march along a shortest path toward the closest enemy instead of wandering
+        Map* map = strongestTerritory->getMap();
+        TerritoryId goal = NO_TERRITORY;
+        if(attackableTerritories == 0 && map != nullptr){
+            goal = findClosestEnemy(map, player, strongestTerritory->getId());
+            if(goal == NO_TERRITORY){
+                cout << "Aggressive Player Strategy: No enemy territory can be reached from " << strongestTerritory->getName() << "." << endl;
+                delete defendList;
+                return;
+            }
+            player->getAttackCollection()->clear();
+            player->getEnemyTerritories(strongestTerritory);
+            attackableTerritories = player->getAttackCollection()->size();
+        }
+
         while(attackableTerritories == 0){
 
-            // Hopefully this does not result in an infinite loop
-            int numAdjacent = currentTerritory->getAdjacentTerritories()->size();
-            int randomIndex = rand() % numAdjacent; // Select a random adjacent territory
+            int numAdjacent = currentTerritory->getAdjacentTerritories().size();
+            if(goal == NO_TERRITORY && numAdjacent == 0){
+                cout << "Aggressive Player Strategy: " << currentTerritory->getName() << " has no adjacent territory to advance to." << endl;
+                delete defendList;
+                return;
+            }
 
             Territory* targetTerritory;
 
-            if(numAdjacent == 1){
+            if(goal != NO_TERRITORY){
+                targetTerritory = map->getTerritory(map->getRouting()->getNextHop(currentTerritory->getId(), goal));
+            } else if(numAdjacent == 1){
                 targetTerritory = lastTerritoryVisited;
             } else {
-                targetTerritory = currentTerritory->getAdjacentTerritories()->at(randomIndex);
+                int randomIndex = rand() % numAdjacent; // Select a random adjacent territory
+                targetTerritory = currentTerritory->getAdjacentTerritories()[randomIndex];
                 while(targetTerritory->getName() == lastTerritoryVisited->getName()){
                     randomIndex = rand() % numAdjacent;
-                    targetTerritory = currentTerritory->getAdjacentTerritories()->at(randomIndex);
+                    targetTerritory = currentTerritory->getAdjacentTerritories()[randomIndex];
                 }
 
             }
 
-            std::unique_ptr<Orders> order = std::make_unique<Advance>(currentTerritory->getArmies(), currentTerritory->getName(), targetTerritory->getName());
+            std::unique_ptr<Orders> order = std::make_unique<Advance>(currentTerritory->getArmies(), currentTerritory, targetTerritory);
             player->setLastAction("Issued Advance order: " + std::to_string(currentTerritory->getArmies()) + " units from " + lastTerritoryVisited->getName()+ " to " + targetTerritory->getName());
             player->notify(player);
-            player->getOrderList()->orderList.push_back(std::move(order));
+            player->getOrderList()->add(std::move(order));
             cout << "New Advance Order created." << endl;
 
 
@@ -156,23 +248,21 @@ void AggressivePlayerStrategy::issueOrder(){
 
         strongestTerritory = currentTerritory;
 
-        int randomIndex = rand() % attackableTerritories; // Select a random Enemy territory
-
-        Territory* targetTerritory = player->getAttackCollection()->at(randomIndex);
+        Territory* targetTerritory = pickAttackTarget(*player->getAttackCollection()); // Select a random Enemy territory, chokepoints first
 
         // Attempt to bomb every territory (the validate function will prevent invalid bombs)
-        std::unique_ptr<Orders> bombOrder = std::make_unique<Bomb>(0, strongestTerritory->getName(), targetTerritory->getName());
+        std::unique_ptr<Orders> bombOrder = std::make_unique<Bomb>(0, strongestTerritory, targetTerritory);
         player->setLastAction("Issued Bomb order: " + player->getName() + " bombed " + targetTerritory->getName());
         player->notify(player);
-        player->getOrderList()->orderList.push_back(std::move(bombOrder));
+        player->getOrderList()->add(std::move(bombOrder));
         cout << "New Bomb Order created." << endl;
 
         // Split the army equally among all attackable territories of the player's Strongest Territory
         // The Floor will ensure that all the deployed armies will be valid
-        std::unique_ptr<Orders> order = std::make_unique<Advance>(strongestTerritory->getArmies(), strongestTerritory->getName(), targetTerritory->getName());
+        std::unique_ptr<Orders> order = std::make_unique<Advance>(strongestTerritory->getArmies(), strongestTerritory, targetTerritory);
         player->setLastAction("Issued Advance order: " + std::to_string(strongestTerritory->getArmies()) + " units from " + strongestTerritory->getName()+ " to " + targetTerritory->getName());
         player->notify(player);
-        player->getOrderList()->orderList.push_back(std::move(order));
+        player->getOrderList()->add(std::move(order));
         cout << "New Advance Order created." << endl;
         
 
@@ -186,12 +276,16 @@ void AggressivePlayerStrategy::issueOrder(){
 std::vector<Territory*>* AggressivePlayerStrategy::toAttack() {
     // Would normally prioritize strongest territories, placeholder for now
     player->getAttackCollection()->clear();   
-    std::unique_ptr<std::vector<Territory*>> defendList(toDefend());
 
     //IMPORTANT: Clear previous entries to avoid duplicates
 
-    if(!defendList->empty()){
-        player->getEnemyTerritories(defendList->at(0));
+    // Same territory as toDefend()->at(0): the strongest one, or the first owned one if none has armies
+    Territory* strongestTerritory = findStrongestTerritory(player);
+    if(strongestTerritory != nullptr){
+        if(strongestTerritory->getArmies() <= 0){
+            strongestTerritory = player->getDefendCollection()->at(0);
+        }
+        player->getEnemyTerritories(strongestTerritory);
     }
 
     return player->getAttackCollection();
@@ -263,20 +357,20 @@ void BenevolentPlayerStrategy::issueOrder() {
             break;
         }
 
-        deployOrder = std::make_unique<DeployOrder>(armiesPerTerritory, (*defendList)[i]->getName(), (*defendList)[i]->getName());
+        deployOrder = std::make_unique<DeployOrder>(armiesPerTerritory, (*defendList)[i], (*defendList)[i]);
         player->setLastAction("Deployed " + std::to_string(armiesPerTerritory) + " units to " + (*defendList)[i]->getName());
         player->notify(player);
-        player->getOrderList()->orderList.push_back(std::move(deployOrder));
+        player->getOrderList()->add(std::move(deployOrder));
         cout << (*defendList)[i]->getName() << " has tentatively increased army units by " << armiesPerTerritory << endl;
         tentativeReinforcements -= armiesPerTerritory;
     }
 
     // If there are leftover reinforcements, add them to the weakest territory
     if(tentativeReinforcements > 0){ 
-        deployOrder = std::make_unique<DeployOrder>(tentativeReinforcements, weakestTerritory->getName(), weakestTerritory->getName()); 
+        deployOrder = std::make_unique<DeployOrder>(tentativeReinforcements, weakestTerritory, weakestTerritory); 
         player->setLastAction("Deployed " + std::to_string(tentativeReinforcements) + " units to " + weakestTerritory->getName());
         player->notify(player);
-        player->getOrderList()->orderList.push_back(std::move(deployOrder));
+        player->getOrderList()->add(std::move(deployOrder));
         cout << weakestTerritory->getName() << " has tentatively increased army units by " << tentativeReinforcements << endl;
     }
 
@@ -285,10 +379,10 @@ void BenevolentPlayerStrategy::issueOrder() {
     // Attempt to negotiate with enemies adjacent to weakest territory
     for(Territory* terr: *(toAttack())){
 
-        std::unique_ptr<Orders> order = std::make_unique<Negotiate>(0, weakestTerritory->getName(), terr->getName(), terr->getOwner()->getName());
+        std::unique_ptr<Orders> order = std::make_unique<Negotiate>(0, weakestTerritory->getName(), terr->getName(), terr->getOwner());
         player->setLastAction("Issued Negotiate order with " + terr->getOwner()->getName());
         player->notify(player);
-        player->getOrderList()->orderList.push_back(std::move(order));
+        player->getOrderList()->add(std::move(order));
         cout << "New Negotiate Order created." << endl;
     }
 
@@ -298,24 +392,24 @@ void BenevolentPlayerStrategy::issueOrder() {
     if(numTerritories > 1){
         // Attempt to airlift armies from the strongest territory to the weakest territory
         Territory* strongestTerritory = (*defendList)[numTerritories - 1];
-        std::unique_ptr<Orders> airliftOrder = std::make_unique<Airlift>(floor(strongestTerritory->getArmies()/3), strongestTerritory->getName(), weakestTerritory->getName());
+        std::unique_ptr<Orders> airliftOrder = std::make_unique<Airlift>(floor(strongestTerritory->getArmies()/3), strongestTerritory, weakestTerritory);
         player->setLastAction("Issued Airlift order: " + std::to_string(floor(strongestTerritory->getArmies()/3)) + " units from " + strongestTerritory->getName()+ " to " + weakestTerritory->getName());
         player->notify(player);
-        player->getOrderList()->orderList.push_back(std::move(airliftOrder));
+        player->getOrderList()->add(std::move(airliftOrder));
         cout << "New Airlift Order created." << endl;
 
 
 
         // Advance armies from allied adjacent territories to weakest territory
-        for(Territory* terr: *(weakestTerritory->getAdjacentTerritories()) ){
+        for(Territory* terr: weakestTerritory->getAdjacentTerritories() ){
             // Check if the adjacent territory is owned by an enemy player
             if(terr->getOwner() == player){
                 int sendArmies = floor(terr->getArmies()/3); // Send a third of the armies to the weakest territory
 
-                std::unique_ptr<Orders> order = std::make_unique<Advance>(sendArmies, terr->getName(), weakestTerritory->getName());
+                std::unique_ptr<Orders> order = std::make_unique<Advance>(sendArmies, terr, weakestTerritory);
                 player->setLastAction("Issued Advance order: " + std::to_string(terr->getArmies()) + " units from " + terr->getName()+ " to " + weakestTerritory->getName());
                 player->notify(player);
-                player->getOrderList()->orderList.push_back(std::move(order));
+                player->getOrderList()->add(std::move(order));
                 cout << "New Advance Order created." << endl;
             }
         }
@@ -333,10 +427,10 @@ void BenevolentPlayerStrategy::issueOrder() {
         Territory* strongestTerritory = (*defendList)[numTerritories - 1];
         if (strongestTerritory != weakestTerritory && strongestTerritory->getArmies() > 0) {
             int sendArmies = std::max(1, strongestTerritory->getArmies() / 2);
-            std::unique_ptr<Orders> airliftOrder = std::make_unique<Airlift>(sendArmies, strongestTerritory->getName(), weakestTerritory->getName());
+            std::unique_ptr<Orders> airliftOrder = std::make_unique<Airlift>(sendArmies, strongestTerritory, weakestTerritory);
             player->setLastAction("Issued defensive Airlift: " + std::to_string(sendArmies) + " units from " + strongestTerritory->getName() + " to " + weakestTerritory->getName());
             player->notify(player);
-            player->getOrderList()->orderList.push_back(std::move(airliftOrder));
+            player->getOrderList()->add(std::move(airliftOrder));
             cout << "Airlift card used defensively: moved " << sendArmies << " armies to " << weakestTerritory->getName() << endl;
         }
     }
@@ -356,8 +450,9 @@ std::vector<Territory*>* BenevolentPlayerStrategy::toAttack() {
     // Get enemy territories adjacent to weakest territory
     // This will be used to get players to negotiate with
     // Check if the toDefend is empty or not
-    if(player->toDefend()->size() > 0){
-        player->getEnemyTerritories((*toDefend())[0]);
+    Territory* weakestTerritory = findWeakestTerritory(player);
+    if(weakestTerritory != nullptr){
+        player->getEnemyTerritories(weakestTerritory);
     }
 
     return player->getAttackCollection();
@@ -376,6 +471,25 @@ std::vector<Territory*>* BenevolentPlayerStrategy::toDefend() {
     std::sort(defendList->begin(), defendList->end(), [](Territory* a, Territory* b) {
         return a->getArmies() < b->getArmies();             // Sort in ascending order of armies, ensuring weakest territories come first
     });
+
+    // Among the weakest territories, the one with the most enemies drawn around it is reinforced first
+    // (only the first few are measured, so the cost stays small when many territories are tied)
+    const int THREAT_RADIUS = 100;          // in map image coordinates
+    const int THREAT_CANDIDATES = 8;
+    int tied = 1;
+    while (tied < (int)defendList->size() && tied < THREAT_CANDIDATES && (*defendList)[tied]->getArmies() == (*defendList)[0]->getArmies()) {
+        tied++;
+    }
+    int mostThreatened = 0;
+    int mostEnemies = -1;
+    for (int i = 0; i < tied && tied > 1; i++) {
+        int enemies = countEnemiesNear((*defendList)[i], player, THREAT_RADIUS);
+        if (enemies > mostEnemies) {
+            mostEnemies = enemies;
+            mostThreatened = i;
+        }
+    }
+    std::swap((*defendList)[0], (*defendList)[mostThreatened]);
     return defendList;
 }
 
@@ -422,10 +536,7 @@ void CheaterPlayerStrategy::issueOrder() {
 
 std::vector<Territory*>* CheaterPlayerStrategy::toAttack() {
     player->getAttackCollection()->clear();
-    for (Territory * territory : * player->getDefendCollection())
-    {
-        player->getEnemyTerritories(territory);
-    }
+    player->getEnemyTerritories();
 
     return player->getAttackCollection();
 }